@@ -3,155 +3,833 @@
 
 #define BAUD_RATE 921600
 
-String commandBuffer = "";
-
-// Tone-based voice responses
-// Each beep: 500ms tone, 500ms interval between beeps
-void playTonePattern(String message) {
-    message.toLowerCase();
-
-    if (message.indexOf("ready") >= 0) {
-        // "I'm ready!" - 3 ascending beeps (500Hz, 1000Hz, 1500Hz)
-        M5.Speaker.tone(500, 500);   // Low beep - 500ms
-        delay(1000);                 // Wait 500ms tone + 500ms interval
-
-        M5.Speaker.tone(1000, 500);  // Mid beep - 500ms
-        delay(1000);                 // Wait 500ms tone + 500ms interval
-
-        M5.Speaker.tone(1500, 500);  // High beep - 500ms
-        delay(500);                  // Wait for tone to finish
-        M5.Speaker.stop();
-    }
-    else if (message.indexOf("music") >= 0) {
-        // "play music" - 2 descending beeps (1500Hz, 500Hz)
-        M5.Speaker.tone(1500, 500);  // High beep - 500ms
-        delay(1000);                 // Wait 500ms tone + 500ms interval
-
-        M5.Speaker.tone(500, 500);   // Low beep - 500ms
-        delay(500);                  // Wait for tone to finish
-        M5.Speaker.stop();
-    }
-    else if (message.indexOf("animation") >= 0 || message.indexOf("anime") >= 0) {
-        // "play animation" - 2 ascending beeps (500Hz, 1500Hz)
-        M5.Speaker.tone(500, 500);   // Low beep - 500ms
-        delay(1000);                 // Wait 500ms tone + 500ms interval
-
-        M5.Speaker.tone(1500, 500);  // High beep - 500ms
-        delay(500);                  // Wait for tone to finish
-        M5.Speaker.stop();
-    }
-    else if (message.indexOf("both") >= 0) {
-        // "play both" - 2 same volume beeps (1000Hz, 1000Hz)
-        M5.Speaker.tone(1000, 500);  // Mid beep - 500ms
-        delay(1000);                 // Wait 500ms tone + 500ms interval
-
-        M5.Speaker.tone(1000, 500);  // Mid beep - 500ms
-        delay(500);                  // Wait for tone to finish
-        M5.Speaker.stop();
-    }
-    else if (message.indexOf("understand") >= 0 || message.indexOf("unknown") >= 0 || message.indexOf("sorry") >= 0 || message.indexOf("again") >= 0) {
-        // "I'm sorry, try again" - 3 descending beeps (1500Hz, 1000Hz, 500Hz)
-        M5.Speaker.tone(1500, 500);  // High beep - 500ms
-        delay(1000);                 // Wait 500ms tone + 500ms interval
-
-        M5.Speaker.tone(1000, 500);  // Mid beep - 500ms
-        delay(1000);                 // Wait 500ms tone + 500ms interval
-
-        M5.Speaker.tone(500, 500);   // Low beep - 500ms
-        delay(500);                  // Wait for tone to finish
-        M5.Speaker.stop();
-    }
-    else {
-        // Default: Single mid beep
-        M5.Speaker.tone(1000, 500);
-        delay(500);
-        M5.Speaker.stop();
-    }
-}
-
-void handleCommand(String cmd) {
-    // AVOID String class entirely - use C-style string
-    const char* cmdStr = cmd.c_str();
-    int patternID = 0;
-
-    // Use strstr instead of indexOf (simpler, might not corrupt speaker)
-    if (strstr(cmdStr, "ready")) patternID = 1;
-    else if (strstr(cmdStr, "music")) patternID = 2;
-    else if (strstr(cmdStr, "anim")) patternID = 3;
-    else if (strstr(cmdStr, "both")) patternID = 4;
-    else if (strstr(cmdStr, "sorry")) patternID = 5;
-
-    // Now play based on pattern ID
-    // Using tone() without duration + manual stop() for better control
-    if (patternID == 1) {
-        // Ready: 3 ascending
-        M5.Speaker.tone(500);
-        delay(500);
-        M5.Speaker.stop();
-        delay(500);
-        M5.Speaker.tone(1000);
-        delay(500);
-        M5.Speaker.stop();
-        delay(500);
-        M5.Speaker.tone(1500);
-        delay(500);
-        M5.Speaker.stop();
-    }
-    else if (patternID == 2) {
-        // Music: 2 RAPID consecutive beeps
-        M5.Speaker.tone(1000);
-        delay(300);
-        M5.Speaker.stop();
-        delay(100);  // Short 100ms gap
-        M5.Speaker.tone(1000);
-        delay(300);
-        M5.Speaker.stop();
-    }
-    else if (patternID == 3) {
-        // Animation: 2 RAPID consecutive beeps
-        M5.Speaker.tone(1000);
-        delay(300);
-        M5.Speaker.stop();
-        delay(100);  // Short 100ms gap
-        M5.Speaker.tone(1000);
-        delay(300);
-        M5.Speaker.stop();
-    }
-    else if (patternID == 4) {
-        // Both: 2 RAPID consecutive beeps
-        M5.Speaker.tone(1000);
-        delay(300);
-        M5.Speaker.stop();
-        delay(100);  // Short 100ms gap
-        M5.Speaker.tone(1000);
-        delay(300);
-        M5.Speaker.stop();
-    }
-    else if (patternID == 5) {
-        // Error: 2 RAPID consecutive beeps
-        M5.Speaker.tone(1000);
-        delay(300);
-        M5.Speaker.stop();
-        delay(100);  // Short 100ms gap
-        M5.Speaker.tone(1000);
-        delay(300);
-        M5.Speaker.stop();
-    }
-    else {
-        // Default: 1 beep
-        M5.Speaker.tone(1000);
-        delay(500);
-        M5.Speaker.stop();
+// ===================== TONE PATTERNS =====================
+// Each response is a constant table of (frequency, tone length, gap after)
+// steps. The sequencer below plays them from loop() by millis(), so Serial
+// keeps being drained while a pattern is sounding.
+struct ToneStep {
+    uint16_t freqHz;
+    uint16_t toneMs;
+    uint16_t gapMs;     // Silence after this tone before the next step
+};
+
+struct TonePattern {
+    const ToneStep *steps;
+    uint8_t count;
+};
+
+enum PatternId : uint8_t {
+    PATTERN_DEFAULT,    // Unrecognised command: 1 beep
+    PATTERN_READY,
+    PATTERN_MUSIC,
+    PATTERN_ANIMATION,
+    PATTERN_BOTH,
+    PATTERN_SORRY,
+    PATTERN_STARTUP,    // Firmware loaded
+    PATTERN_COUNT
+};
+
+// Ready: 3 ascending
+const ToneStep TONES_READY[] = { {500, 500, 500}, {1000, 500, 500}, {1500, 500, 0} };
+// Music / animation / both / error: 2 RAPID consecutive beeps, short 100ms gap
+const ToneStep TONES_DOUBLE[] = { {1000, 300, 100}, {1000, 300, 0} };
+// Default: 1 beep
+const ToneStep TONES_SINGLE[] = { {1000, 500, 0} };
+// Startup melody - confirms firmware loaded
+const ToneStep TONES_STARTUP[] = { {1000, 200, 50}, {1500, 200, 50} };
+
+#define TONE_PATTERN(steps) { steps, sizeof(steps) / sizeof(steps[0]) }
+
+// Indexed by PatternId
+const TonePattern TONE_PATTERNS[PATTERN_COUNT] = {
+    TONE_PATTERN(TONES_SINGLE),     // PATTERN_DEFAULT
+    TONE_PATTERN(TONES_READY),      // PATTERN_READY
+    TONE_PATTERN(TONES_DOUBLE),     // PATTERN_MUSIC
+    TONE_PATTERN(TONES_DOUBLE),     // PATTERN_ANIMATION
+    TONE_PATTERN(TONES_DOUBLE),     // PATTERN_BOTH
+    TONE_PATTERN(TONES_DOUBLE),     // PATTERN_SORRY
+    TONE_PATTERN(TONES_STARTUP),    // PATTERN_STARTUP
+};
+
+// Text command keywords, first match wins
+struct PatternKeyword {
+    const char *keyword;
+    PatternId pattern;
+};
+
+const PatternKeyword PATTERN_KEYWORDS[] = {
+    { "ready",   PATTERN_READY },
+    { "music",   PATTERN_MUSIC },
+    { "anim",    PATTERN_ANIMATION },
+    { "both",    PATTERN_BOTH },
+    { "sorry",   PATTERN_SORRY },
+    { "unknown", PATTERN_SORRY },
+};
+
+// ===================== TONE SEQUENCER =====================
+// Patterns requested while one is playing wait in a small FIFO (a full FIFO
+// drops the oldest request); preempting clears the FIFO and restarts at once.
+const int TONE_QUEUE_SIZE = 4;
+const uint8_t TONE_CHANNEL = 0;             // Speaker virtual channel (audio streams use another)
+
+PatternId toneQueue[TONE_QUEUE_SIZE];
+int toneQueueHead = 0;
+int toneQueueCount = 0;
+
+void claimSpeaker();  // HALF DUPLEX
+
+const TonePattern *tonePattern = nullptr;  // Playing pattern, null when idle
+uint8_t toneStep = 0;
+bool toneSounding = false;                 // In the tone (true) or the gap after it (false)
+unsigned long tonePhaseEnd = 0;
+
+void startToneStep(unsigned long now) {
+    const ToneStep &step = tonePattern->steps[toneStep];
+    claimSpeaker();
+    // tone() without duration + manual stop() for better control
+    M5.Speaker.tone(step.freqHz, UINT32_MAX, TONE_CHANNEL);
+    toneSounding = true;
+    tonePhaseEnd = now + step.toneMs;
+}
+
+void startPattern(PatternId id, unsigned long now) {
+    tonePattern = &TONE_PATTERNS[id];
+    toneStep = 0;
+    startToneStep(now);
+}
+
+void stopTones() {
+    tonePattern = nullptr;
+    toneQueueCount = 0;
+    M5.Speaker.stop(TONE_CHANNEL);
+}
+
+// Play id now (preempt) or after everything already requested
+void playPattern(PatternId id, bool preempt) {
+    unsigned long now = millis();
+
+    if (preempt) {
+        stopTones();
+        startPattern(id, now);
+        return;
+    }
+    if (tonePattern == nullptr) {
+        startPattern(id, now);
+        return;
+    }
+
+    if (toneQueueCount == TONE_QUEUE_SIZE) {
+        toneQueueHead = (toneQueueHead + 1) % TONE_QUEUE_SIZE;
+        toneQueueCount--;
+    }
+    toneQueue[(toneQueueHead + toneQueueCount) % TONE_QUEUE_SIZE] = id;
+    toneQueueCount++;
+}
+
+// Advance the playing pattern; called every loop() pass, never blocks
+void serviceTones(unsigned long now) {
+    if (tonePattern == nullptr || (long)(now - tonePhaseEnd) < 0) return;
+
+    if (toneSounding) {
+        M5.Speaker.stop(TONE_CHANNEL);
+        toneSounding = false;
+        tonePhaseEnd = now + tonePattern->steps[toneStep].gapMs;
+        return;
+    }
+
+    if (++toneStep < tonePattern->count) {
+        startToneStep(now);
+    } else if (toneQueueCount > 0) {
+        PatternId next = toneQueue[toneQueueHead];
+        toneQueueHead = (toneQueueHead + 1) % TONE_QUEUE_SIZE;
+        toneQueueCount--;
+        startPattern(next, now);
+    } else {
+        tonePattern = nullptr;
+    }
+}
+
+// ===================== AUDIO STREAM =====================
+// The Pi streams PCM16 or IMA-ADPCM chunks in frames (see SERIAL FRAMING).
+// They are decoded into a sample ring, the jitter buffer, and handed to
+// M5.Speaker.playRaw in fixed blocks. playRaw keeps a pointer until the
+// block has played, so AUDIO_BLOCK_COUNT blocks rotate: one playing, one
+// queued behind it, one being filled. Playback starts once audioPrebuffer
+// samples are buffered; that depth follows the measured frame arrival
+// jitter, and grows after every underrun.
+const uint8_t AUDIO_CHANNEL = 1;
+const uint32_t AUDIO_RING_SAMPLES = 8192;       // 512ms at 16kHz, power of two
+const size_t AUDIO_BLOCK_SAMPLES = 256;         // 16ms at 16kHz
+const int AUDIO_BLOCK_COUNT = 3;
+const size_t AUDIO_CHUNK_MAX = 256;             // Largest audio payload per frame (bytes)
+const uint16_t AUDIO_RATE_MIN = 8000;
+const uint16_t AUDIO_RATE_MAX = 24000;
+const uint16_t AUDIO_PREBUFFER_MIN_MS = 40;
+const uint16_t AUDIO_PREBUFFER_MAX_MS = 160;    // Keeps start latency under 200ms
+
+enum AudioFormat : uint8_t {
+    AUDIO_PCM16,        // Little-endian int16 samples
+    AUDIO_IMA_ADPCM,    // 4-bit IMA, low nibble first; chunk starts with predictor (int16) + step index
+    AUDIO_FORMAT_COUNT
+};
+
+enum AudioState : uint8_t {
+    AUDIO_IDLE,
+    AUDIO_BUFFERING,    // Filling to the prebuffer depth (start or after an underrun)
+    AUDIO_PLAYING,
+    AUDIO_DRAINING,     // End received, playing out what is left
+};
+
+struct AudioStats {
+    uint32_t streams;
+    uint32_t underruns;         // Speaker ran dry mid-stream
+    uint32_t overruns;          // Samples dropped on a full ring
+    uint32_t seqGaps;           // Data frames missing by sequence number
+    uint32_t badFrames;         // Bad start args, or data outside a stream
+    uint32_t startLatencyMs;    // Last stream: start frame to first block queued
+    uint32_t jitterMs;          // Arrival jitter estimate the prebuffer is sized from
+    uint32_t linkBytesPerSec;   // Last stream: audio payload throughput
+};
+
+AudioStats audioStats = {};
+
+int16_t audioRing[AUDIO_RING_SAMPLES];
+uint32_t audioHead = 0;         // Free-running write / read counts
+uint32_t audioTail = 0;
+int16_t audioBlocks[AUDIO_BLOCK_COUNT][AUDIO_BLOCK_SAMPLES];
+uint8_t audioNextBlock = 0;
+
+AudioState audioState = AUDIO_IDLE;
+AudioFormat audioFormat = AUDIO_PCM16;
+uint16_t audioRate = 16000;
+uint32_t audioPrebuffer = 0;    // Samples
+uint8_t audioSeq = 0;           // Next expected data sequence number
+bool audioStarted = false;      // First block of this stream queued
+unsigned long audioStartMs = 0;
+unsigned long audioLastFrameMs = 0;
+uint32_t audioLastFrameSamples = 0;
+uint32_t audioBytes = 0;
+
+const int8_t IMA_INDEX_TABLE[16] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+const int16_t IMA_STEP_TABLE[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+void pushAudioSample(int16_t sample) {
+    if (audioHead - audioTail >= AUDIO_RING_SAMPLES) {
+        audioStats.overruns++;
+        return;
+    }
+    audioRing[audioHead++ & (AUDIO_RING_SAMPLES - 1)] = sample;
+}
+
+int16_t imaDecodeNibble(uint8_t nibble, int32_t &predictor, int &index) {
+    int32_t step = IMA_STEP_TABLE[index];
+    int32_t diff = step >> 3;
+    if (nibble & 4) diff += step;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 1) diff += step >> 2;
+    predictor += (nibble & 8) ? -diff : diff;
+    predictor = constrain(predictor, -32768, 32767);
+    index = constrain(index + IMA_INDEX_TABLE[nibble], 0, 88);
+    return (int16_t)predictor;
+}
+
+uint32_t msToSamples(uint32_t ms) {
+    return ms * audioRate / 1000;
+}
+
+void updatePrebuffer() {
+    uint32_t ms = constrain(AUDIO_PREBUFFER_MIN_MS + 2 * audioStats.jitterMs,
+                            (uint32_t)AUDIO_PREBUFFER_MIN_MS, (uint32_t)AUDIO_PREBUFFER_MAX_MS);
+    audioPrebuffer = msToSamples(ms);
+}
+
+void stopAudio() {
+    if (audioState == AUDIO_IDLE) return;
+    audioState = AUDIO_IDLE;
+    M5.Speaker.stop(AUDIO_CHANNEL);
+}
+
+// args: [format][rate lo][rate hi]
+void audioStart(const uint8_t *args, size_t len) {
+    uint16_t rate = len >= 3 ? (uint16_t)(args[1] | (args[2] << 8)) : 0;
+    if (len < 3 || args[0] >= AUDIO_FORMAT_COUNT || rate < AUDIO_RATE_MIN || rate > AUDIO_RATE_MAX) {
+        audioStats.badFrames++;
+        return;
+    }
+
+    // Speech replaces any beeps
+    stopTones();
+    stopAudio();
+    claimSpeaker();
+
+    audioFormat = (AudioFormat)args[0];
+    audioRate = rate;
+    audioHead = audioTail = 0;
+    audioSeq = 0;
+    audioStarted = false;
+    audioBytes = 0;
+    audioLastFrameSamples = 0;
+    audioStartMs = audioLastFrameMs = millis();
+    audioState = AUDIO_BUFFERING;
+    audioStats.streams++;
+    updatePrebuffer();
+}
+
+// args: [seq] then PCM16 samples, or predictor lo/hi + step index + ADPCM bytes
+void audioData(const uint8_t *args, size_t len, unsigned long now) {
+    if (audioState == AUDIO_IDLE || audioState == AUDIO_DRAINING || len < 1) {
+        audioStats.badFrames++;
+        return;
+    }
+
+    uint8_t seq = args[0];
+    audioStats.seqGaps += (uint8_t)(seq - audioSeq);
+    audioSeq = seq + 1;
+    args++;
+    len--;
+
+    uint32_t before = audioHead;
+    if (audioFormat == AUDIO_PCM16) {
+        for (size_t i = 0; i + 1 < len; i += 2) pushAudioSample((int16_t)(args[i] | (args[i + 1] << 8)));
+    } else if (len >= 3) {
+        int32_t predictor = (int16_t)(args[0] | (args[1] << 8));
+        int index = constrain(args[2], 0, 88);
+        for (size_t i = 3; i < len; i++) {
+            pushAudioSample(imaDecodeNibble(args[i] & 0x0F, predictor, index));
+            pushAudioSample(imaDecodeNibble(args[i] >> 4, predictor, index));
+        }
+    }
+
+    // Jitter: how much later than the previous chunk's playing time this one
+    // arrived. Peak-hold with a slow decay, so one stall keeps its effect.
+    uint32_t gapMs = now - audioLastFrameMs;
+    uint32_t expectedMs = audioLastFrameSamples * 1000 / audioRate;
+    uint32_t lateMs = gapMs > expectedMs ? gapMs - expectedMs : 0;
+    if (lateMs > audioStats.jitterMs) {
+        audioStats.jitterMs = lateMs;
+    } else {
+        audioStats.jitterMs -= (audioStats.jitterMs + 7) / 8;
+    }
+    audioLastFrameMs = now;
+    audioLastFrameSamples = audioHead - before;
+
+    audioBytes += len;
+    uint32_t elapsedMs = now - audioStartMs;
+    if (elapsedMs > 0) audioStats.linkBytesPerSec = (uint64_t)audioBytes * 1000 / elapsedMs;
+}
+
+void audioEnd() {
+    if (audioState == AUDIO_IDLE) return;
+    audioState = AUDIO_DRAINING;
+}
+
+// Keep one block queued behind the playing one; called every loop() pass
+void serviceAudio(unsigned long now) {
+    if (audioState == AUDIO_IDLE) return;
+
+    size_t inFlight = M5.Speaker.isPlaying(AUDIO_CHANNEL);  // 0 idle, 1 playing, 2 playing + queued
+    uint32_t buffered = audioHead - audioTail;
+
+    if (audioState == AUDIO_BUFFERING) {
+        if (buffered < audioPrebuffer) return;
+        audioState = AUDIO_PLAYING;
+    }
+
+    while (inFlight < 2 && buffered > 0) {
+        size_t n = min(buffered, (uint32_t)AUDIO_BLOCK_SAMPLES);
+        if (n < AUDIO_BLOCK_SAMPLES && audioState != AUDIO_DRAINING) break;  // Wait for a full block
+
+        int16_t *block = audioBlocks[audioNextBlock];
+        audioNextBlock = (audioNextBlock + 1) % AUDIO_BLOCK_COUNT;
+        for (size_t i = 0; i < n; i++) block[i] = audioRing[audioTail++ & (AUDIO_RING_SAMPLES - 1)];
+        M5.Speaker.playRaw(block, n, audioRate, false, 1, AUDIO_CHANNEL, false);
+
+        if (!audioStarted) {
+            audioStarted = true;
+            audioStats.startLatencyMs = now - audioStartMs;
+        }
+        inFlight++;
+        buffered -= n;
+    }
+
+    if (inFlight > 0) return;
+    if (audioState == AUDIO_DRAINING) {
+        audioState = AUDIO_IDLE;
+        return;
+    }
+
+    // Ran dry before the stream ended: rebuffer deeper
+    audioStats.underruns++;
+    audioStats.jitterMs += AUDIO_BLOCK_SAMPLES * 1000 / audioRate;
+    updatePrebuffer();
+    audioState = AUDIO_BUFFERING;
+}
+
+// ===================== TEXT COMMANDS =====================
+// Legacy line protocol: "<keyword>" queues the matching pattern,
+// "!<keyword>" replaces whatever is playing, "stop" silences the speaker
+// and clears the queue.
+void handleTextCommand(const char *cmdStr) {
+    bool preempt = false;
+
+    if (*cmdStr == '!') {
+        preempt = true;
+        cmdStr++;
+    }
+    if (strcmp(cmdStr, "stop") == 0) {
+        stopTones();
+        stopAudio();
+        return;
+    }
+
+    PatternId pattern = PATTERN_DEFAULT;
+    for (const PatternKeyword &k : PATTERN_KEYWORDS) {
+        if (strstr(cmdStr, k.keyword)) {
+            pattern = k.pattern;
+            break;
+        }
+    }
+    playPattern(pattern, preempt);
+}
+
+// ===================== SERIAL FRAMING =====================
+// Binary frame: 0x00, COBS(opcode, args..., crc8), 0x00. The CRC-8 (poly
+// 0x07, init 0) covers opcode + args. COBS leaves no zero bytes inside a
+// frame, so 0x00 always resynchronises. Bytes outside a frame are legacy
+// text commands ending in \n or \r; a line with other control bytes is
+// dropped as corrupt. Everything is parsed in place in rxBuf (no heap).
+const size_t SERIAL_RX_BUFFER = 1024;   // UART driver ring, holds ~11ms at 921600 baud
+const size_t FRAME_MAX = AUDIO_CHUNK_MAX + 8;  // Largest decoded frame: opcode + args + crc
+const size_t RX_BUF_MAX = FRAME_MAX + FRAME_MAX / 254 + 1;  // COBS-encoded worst case
+
+// Frame opcodes (replies set FRAME_REPLY)
+enum FrameOp : uint8_t {
+    OP_STOP = 0x00,             // Silence + clear queue
+    OP_TONE_BASE = 0x01,        // OP_TONE_BASE + PatternId, optional flags byte
+    OP_STATUS = 0x10,           // Reply carries the link and audio counters
+    OP_AUDIO_START = 0x20,      // [format][rate lo][rate hi]
+    OP_AUDIO_DATA = 0x21,       // [seq][chunk]
+    OP_AUDIO_END = 0x22,        // Play out what is buffered, then stop
+    OP_MIC = 0x30,              // [enable][format]: capture mode on/off
+    OP_MIC_START = 0x31,        // Upstream: [format][rate lo][rate hi], speech segment opens
+    OP_MIC_DATA = 0x32,         // Upstream: [seq][chunk], same chunk layout as OP_AUDIO_DATA
+    OP_MIC_END = 0x33,          // Upstream: segment closed
+};
+const uint8_t FRAME_REPLY = 0x80;
+const uint8_t TONE_FLAG_PREEMPT = 0x01;
+
+struct LinkStats {
+    uint32_t frames;            // Valid frames dispatched
+    uint32_t textCommands;
+    uint32_t crcErrors;
+    uint32_t cobsErrors;        // Malformed encoding or too short
+    uint32_t overflows;         // Frame or line longer than the buffer
+    uint32_t badText;           // Lines with control bytes
+    uint32_t unknownOps;
+};
+
+LinkStats linkStats = {};
+
+enum RxMode : uint8_t { RX_TEXT, RX_FRAME };
+
+uint8_t rxBuf[RX_BUF_MAX + 1];  // +1 for the text terminator
+size_t rxLen = 0;
+RxMode rxMode = RX_TEXT;
+bool rxDiscard = false;         // Current frame/line is already known bad
+
+uint8_t crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+// In-place COBS decode; false if a code byte points past the end
+bool cobsDecode(uint8_t *buf, size_t len, size_t &outLen) {
+    size_t in = 0, out = 0;
+    while (in < len) {
+        uint8_t code = buf[in++];
+        if (code == 0 || in + code - 1 > len) return false;
+        for (uint8_t i = 1; i < code; i++) buf[out++] = buf[in++];
+        if (code < 0xFF && in < len) buf[out++] = 0;
+    }
+    outLen = out;
+    return true;
+}
+
+size_t cobsEncode(const uint8_t *src, size_t len, uint8_t *dst) {
+    size_t codeAt = 0, out = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (src[i] != 0) {
+            dst[out++] = src[i];
+            code++;
+        }
+        if (src[i] == 0 || code == 0xFF) {
+            dst[codeAt] = code;
+            code = 1;
+            codeAt = out++;
+        }
+    }
+    dst[codeAt] = code;
+    return out;
+}
+
+// opcode + payload + crc, COBS-encoded between delimiters
+void sendFrame(uint8_t op, const uint8_t *payload, size_t len) {
+    uint8_t raw[FRAME_MAX];
+    uint8_t encoded[RX_BUF_MAX + 2];
+    if (len + 2 > FRAME_MAX) return;
+
+    raw[0] = op;
+    if (len > 0) memcpy(raw + 1, payload, len);
+    raw[len + 1] = crc8(raw, len + 1);
+
+    size_t n = cobsEncode(raw, len + 2, encoded + 1);
+    encoded[0] = 0;
+    encoded[n + 1] = 0;
+    Serial.write(encoded, n + 2);
+}
+
+// ===================== MIC CAPTURE =====================
+// Optional capture mode (OP_MIC). The PDM mic is read through M5.Mic's I2S
+// DMA in MIC_BLOCK_SAMPLES blocks; like playRaw, record() keeps the pointer
+// until the block is filled, so MIC_BLOCK_COUNT blocks rotate. Each block
+// gets one energy + zero-crossing VAD decision and only speech segments,
+// with a short pre-roll so onsets are not clipped, are framed upstream.
+const uint16_t MIC_RATE = 16000;
+const size_t MIC_BLOCK_SAMPLES = 256;           // 16ms, one VAD decision
+const int MIC_BLOCK_COUNT = 3;
+const size_t SERIAL_TX_BUFFER = 2048;          // Upstream frames are dropped, not blocked on, when full
+const int VAD_PREROLL_BLOCKS = 6;               // ~100ms kept from before the onset
+const int VAD_ONSET_BLOCKS = 2;                 // Consecutive speech blocks to open a segment
+const uint16_t VAD_HANGOVER_MS = 300;           // Silence before a segment closes
+const uint16_t VAD_SEGMENT_MAX_MS = 8000;       // Longer speech is split into several segments
+const int32_t VAD_ENERGY_MIN = 200;             // Mean |x - dc| that can count as speech at all
+const int32_t VAD_ENERGY_RATIO = 3;             // Speech = energy above ratio x noise floor
+const uint16_t VAD_ZCR_MAX = 110;               // Crossings per block; above is hiss, not voice
+
+struct MicStats {
+    uint32_t segments;
+    uint32_t blocks;            // Blocks captured
+    uint32_t speechBlocks;      // Blocks the VAD called speech
+    uint32_t framesSent;
+    uint32_t txDrops;           // Frames dropped on a full TX buffer
+    uint32_t duplexSwitches;    // I2S handovers between mic and speaker
+    uint32_t noiseFloor;        // Current VAD noise floor (mean |x|)
+};
+
+MicStats micStats = {};
+
+bool micEnabled = false;        // Requested by the Pi
+bool micActive = false;         // Mic currently owns I2S
+AudioFormat micFormat = AUDIO_IMA_ADPCM;
+
+int16_t micBlocks[MIC_BLOCK_COUNT][MIC_BLOCK_SAMPLES];
+uint8_t micDoneBlock = 0;       // Oldest block handed to record()
+uint8_t micPending = 0;         // Blocks handed to record() and not yet processed
+
+int16_t micPreroll[VAD_PREROLL_BLOCKS][MIC_BLOCK_SAMPLES];
+uint8_t micPrerollHead = 0;
+uint8_t micPrerollCount = 0;
+
+int32_t vadNoiseFloor = VAD_ENERGY_MIN / VAD_ENERGY_RATIO;
+uint8_t vadSpeechRun = 0;
+bool micInSegment = false;
+unsigned long micSegmentStartMs = 0;
+unsigned long micLastSpeechMs = 0;
+uint8_t micSeq = 0;
+int32_t micPredictor = 0;       // IMA encoder state, continuous within a segment
+int micIndex = 0;
+
+// Drop rather than stall loop() when the Pi is not keeping up
+void sendMicFrame(uint8_t op, const uint8_t *payload, size_t len) {
+    if ((size_t)Serial.availableForWrite() < len + len / 254 + 6) {
+        micStats.txDrops++;
+        return;
+    }
+    sendFrame(op | FRAME_REPLY, payload, len);
+    micStats.framesSent++;
+}
+
+// Nibble whose decode lands closest to sample; updates the shared state
+uint8_t imaEncodeSample(int16_t sample, int32_t &predictor, int &index) {
+    int32_t step = IMA_STEP_TABLE[index];
+    int32_t diff = sample - predictor;
+    uint8_t nibble = 0;
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    if (diff >= step) { nibble |= 4; diff -= step; }
+    if (diff >= step >> 1) { nibble |= 2; diff -= step >> 1; }
+    if (diff >= step >> 2) nibble |= 1;
+    imaDecodeNibble(nibble, predictor, index);
+    return nibble;
+}
+
+void sendMicBlock(const int16_t *block) {
+    uint8_t payload[1 + AUDIO_CHUNK_MAX];
+
+    if (micFormat == AUDIO_IMA_ADPCM) {
+        payload[0] = micSeq++;
+        payload[1] = (uint8_t)micPredictor;
+        payload[2] = (uint8_t)(micPredictor >> 8);
+        payload[3] = (uint8_t)micIndex;
+        size_t len = 4;
+        for (size_t i = 0; i < MIC_BLOCK_SAMPLES; i += 2) {
+            uint8_t lo = imaEncodeSample(block[i], micPredictor, micIndex);
+            uint8_t hi = imaEncodeSample(block[i + 1], micPredictor, micIndex);
+            payload[len++] = lo | (hi << 4);
+        }
+        sendMicFrame(OP_MIC_DATA, payload, len);
+        return;
+    }
+
+    // PCM16: AUDIO_CHUNK_MAX bytes per frame
+    const size_t perFrame = AUDIO_CHUNK_MAX / 2;
+    for (size_t start = 0; start < MIC_BLOCK_SAMPLES; start += perFrame) {
+        payload[0] = micSeq++;
+        for (size_t i = 0; i < perFrame; i++) {
+            payload[1 + 2 * i] = (uint8_t)block[start + i];
+            payload[2 + 2 * i] = (uint8_t)(block[start + i] >> 8);
+        }
+        sendMicFrame(OP_MIC_DATA, payload, 1 + 2 * perFrame);
+    }
+}
+
+void openMicSegment(unsigned long now) {
+    uint8_t args[3] = { micFormat, (uint8_t)MIC_RATE, (uint8_t)(MIC_RATE >> 8) };
+    micInSegment = true;
+    micSegmentStartMs = micLastSpeechMs = now;
+    micSeq = 0;
+    micPredictor = 0;
+    micIndex = 0;
+    micStats.segments++;
+    sendMicFrame(OP_MIC_START, args, sizeof(args));
+
+    // Pre-roll, oldest first
+    for (uint8_t i = 0; i < micPrerollCount; i++) {
+        sendMicBlock(micPreroll[(micPrerollHead + VAD_PREROLL_BLOCKS - micPrerollCount + i) % VAD_PREROLL_BLOCKS]);
+    }
+    micPrerollCount = 0;
+}
+
+void closeMicSegment() {
+    if (!micInSegment) return;
+    micInSegment = false;
+    vadSpeechRun = 0;
+    sendMicFrame(OP_MIC_END, nullptr, 0);
+}
+
+// Energy (mean |x - dc|) over an adaptive noise floor, gated by zero-crossing rate
+bool vadIsSpeech(const int16_t *block) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < MIC_BLOCK_SAMPLES; i++) sum += block[i];
+    int32_t dc = sum / (int32_t)MIC_BLOCK_SAMPLES;
+
+    int32_t energy = 0;
+    uint16_t crossings = 0;
+    bool wasPositive = block[0] >= dc;
+    for (size_t i = 0; i < MIC_BLOCK_SAMPLES; i++) {
+        int32_t x = block[i] - dc;
+        energy += x < 0 ? -x : x;
+        bool positive = x >= 0;
+        if (positive != wasPositive) crossings++;
+        wasPositive = positive;
+    }
+    energy /= (int32_t)MIC_BLOCK_SAMPLES;
+
+    int32_t threshold = max(VAD_ENERGY_MIN, vadNoiseFloor * VAD_ENERGY_RATIO);
+    bool speech = energy > threshold && crossings <= VAD_ZCR_MAX;
+    if (!speech) {
+        vadNoiseFloor += (energy - vadNoiseFloor) / 16;
+        micStats.noiseFloor = vadNoiseFloor;
+    }
+    return speech;
+}
+
+void processMicBlock(const int16_t *block, unsigned long now) {
+    bool speech = vadIsSpeech(block);
+    micStats.blocks++;
+    if (speech) micStats.speechBlocks++;
+
+    if (!micInSegment) {
+        vadSpeechRun = speech ? vadSpeechRun + 1 : 0;
+        if (vadSpeechRun < VAD_ONSET_BLOCKS) {
+            memcpy(micPreroll[micPrerollHead], block, sizeof(micPreroll[0]));
+            micPrerollHead = (micPrerollHead + 1) % VAD_PREROLL_BLOCKS;
+            if (micPrerollCount < VAD_PREROLL_BLOCKS) micPrerollCount++;
+            return;
+        }
+        openMicSegment(now);
+    }
+
+    sendMicBlock(block);
+    if (speech) micLastSpeechMs = now;
+    if (now - micLastSpeechMs >= VAD_HANGOVER_MS || now - micSegmentStartMs >= VAD_SEGMENT_MAX_MS) {
+        closeMicSegment();
+    }
+}
+
+// Keep two blocks queued in the mic driver; called every loop() pass
+void serviceMic(unsigned long now) {
+    if (!micActive) return;
+
+    size_t queued = M5.Mic.isRecording();  // 0 idle, 1 recording, 2 recording + queued
+    while (micPending > queued) {
+        processMicBlock(micBlocks[micDoneBlock], now);
+        micDoneBlock = (micDoneBlock + 1) % MIC_BLOCK_COUNT;
+        micPending--;
+    }
+    while (micPending < 2) {
+        if (!M5.Mic.record(micBlocks[(micDoneBlock + micPending) % MIC_BLOCK_COUNT], MIC_BLOCK_SAMPLES, MIC_RATE)) break;
+        micPending++;
+    }
+}
+
+// ===================== HALF DUPLEX =====================
+// Mic and speaker share the Atom Echo's I2S pins. The speaker always wins:
+// whatever needs it takes it at once, closing an open speech segment. The
+// mic only gets I2S back MIC_RESUME_MS after the speaker went idle, so the
+// tail of our own beep is not captured as speech.
+const uint16_t MIC_RESUME_MS = 200;
+
+unsigned long speakerIdleSince = 0;
+
+void claimSpeaker() {
+    if (!micActive) return;
+    closeMicSegment();
+    M5.Mic.end();
+    M5.Speaker.begin();
+    micActive = false;
+    micStats.duplexSwitches++;
+}
+
+bool speakerBusy() {
+    return tonePattern != nullptr || audioState != AUDIO_IDLE;
+}
+
+void serviceDuplex(unsigned long now) {
+    if (micActive) return;
+    if (!micEnabled || speakerBusy()) {
+        speakerIdleSince = now;
+        return;
+    }
+    if (now - speakerIdleSince < MIC_RESUME_MS) return;
+
+    M5.Speaker.end();
+    M5.Mic.begin();
+    micActive = true;
+    micPending = 0;
+    micDoneBlock = 0;
+    micPrerollCount = 0;
+    vadSpeechRun = 0;
+    micStats.duplexSwitches++;
+}
+
+// args: [enable][format]
+void micCommand(const uint8_t *args, size_t len) {
+    if (len < 1) return;
+    micEnabled = args[0] != 0;
+    if (len >= 2 && args[1] < AUDIO_FORMAT_COUNT) micFormat = (AudioFormat)args[1];
+    if (!micEnabled) claimSpeaker();
+}
+
+// ===================== FRAME DISPATCH =====================
+void sendStatus() {
+    uint8_t payload[sizeof(LinkStats) + sizeof(AudioStats) + sizeof(MicStats)];
+    memcpy(payload, &linkStats, sizeof(linkStats));
+    memcpy(payload + sizeof(linkStats), &audioStats, sizeof(audioStats));
+    memcpy(payload + sizeof(linkStats) + sizeof(audioStats), &micStats, sizeof(micStats));
+    sendFrame(OP_STATUS | FRAME_REPLY, payload, sizeof(payload));
+}
+
+// One decoded frame: opcode, args, crc already stripped
+void dispatchFrame(uint8_t op, const uint8_t *args, size_t argLen) {
+    if (op >= OP_TONE_BASE && op < OP_TONE_BASE + PATTERN_COUNT) {
+        bool preempt = argLen > 0 && (args[0] & TONE_FLAG_PREEMPT);
+        playPattern((PatternId)(op - OP_TONE_BASE), preempt);
+        return;
+    }
+    switch (op) {
+        case OP_STOP:           stopTones(); stopAudio(); break;
+        case OP_STATUS:         sendStatus(); break;
+        case OP_AUDIO_START:    audioStart(args, argLen); break;
+        case OP_AUDIO_DATA:     audioData(args, argLen, millis()); break;
+        case OP_AUDIO_END:      audioEnd(); break;
+        case OP_MIC:            micCommand(args, argLen); break;
+        default:                linkStats.unknownOps++; return;
+    }
+}
+
+void finishFrame() {
+    size_t len;
+    if (!cobsDecode(rxBuf, rxLen, len) || len < 2) {
+        linkStats.cobsErrors++;
+        return;
+    }
+    if (crc8(rxBuf, len - 1) != rxBuf[len - 1]) {
+        linkStats.crcErrors++;
+        return;
+    }
+    linkStats.frames++;
+    dispatchFrame(rxBuf[0], rxBuf + 1, len - 2);
+}
+
+void handleRxByte(uint8_t b) {
+    if (b == 0) {
+        // Delimiter: closes a frame, or opens one (dropping any partial text line)
+        if (rxMode == RX_FRAME && rxLen > 0) {
+            if (!rxDiscard) finishFrame();
+            rxMode = RX_TEXT;
+        } else {
+            rxMode = RX_FRAME;
+        }
+        rxLen = 0;
+        rxDiscard = false;
+        return;
+    }
+
+    if (rxMode == RX_TEXT && (b == '\n' || b == '\r')) {
+        if (rxLen > 0 && !rxDiscard) {
+            rxBuf[rxLen] = '\0';
+            linkStats.textCommands++;
+            handleTextCommand((const char*)rxBuf);
+        }
+        rxLen = 0;
+        rxDiscard = false;
+        return;
+    }
+    if (rxDiscard) return;
+
+    if (rxMode == RX_TEXT && (b < 32 || b > 126)) {
+        linkStats.badText++;
+        rxDiscard = true;
+    } else if (rxLen >= RX_BUF_MAX) {
+        linkStats.overflows++;
+        rxDiscard = true;
+    } else {
+        rxBuf[rxLen++] = b;
     }
 }
 
 void setup() {
-    Serial.begin(BAUD_RATE);
-    delay(1000);
+    Serial.setRxBufferSize(SERIAL_RX_BUFFER);
+    Serial.setTxBufferSize(SERIAL_TX_BUFFER);
+    Serial.begin(BAUD_RATE);   // The USB-UART bridge is always up; nothing to wait for
 
     auto cfg = M5.config();
     cfg.led_brightness = 0;
-    cfg.internal_mic = false;  // Microphone disabled
+    cfg.internal_mic = true;   // Configured, but only started in capture mode (HALF DUPLEX)
     cfg.internal_spk = true;   // Speaker enabled
     M5.begin(cfg);
 
@@ -159,54 +837,32 @@ void setup() {
     // i2s_driver_uninstall(I2S_NUM_0);
     // i2s_driver_uninstall(I2S_NUM_1);
 
-    // Initialize speaker once - keep it active
+    // Speaker owns I2S from boot; serviceDuplex() hands it to the mic in capture mode
     M5.Speaker.setVolume(255);
     M5.Speaker.begin();
 
-    // Startup melody - confirms firmware loaded
-    M5.Speaker.tone(1000, 200);
-    delay(250);
-    M5.Speaker.tone(1500, 200);
-    delay(250);
-    M5.Speaker.stop();
+    // Startup melody - confirms firmware loaded (plays out from loop())
+    playPattern(PATTERN_STARTUP, false);
 
-    // Keep speaker system active - don't call begin() again in loop
     // NO Serial.println() - corrupts communication
 }
 
 void loop() {
     M5.update();
 
-    static unsigned long lastCharTime = 0;
-    static bool hasData = false;
-
-    while (Serial.available() > 0) {
-        char c = Serial.read();
-
-        // Accept any printable character OR common line endings
-        if (c >= 32 && c <= 126) {
-            commandBuffer += c;
-            hasData = true;
-            lastCharTime = millis();
-        }
-        else if (c == '\n' || c == '\r' || c < 32) {
-            // Any control character (including corrupted newline) triggers command processing
-            if (commandBuffer.length() > 0) {
-                handleCommand(commandBuffer);
-                commandBuffer = "";
-                hasData = false;
-            }
-        }
+    // Commands take effect as soon as their terminator arrives (no timeout)
+    uint8_t chunk[64];
+    int available;
+    while ((available = Serial.available()) > 0) {
+        size_t n = Serial.readBytes(chunk, min((size_t)available, sizeof(chunk)));
+        for (size_t i = 0; i < n; i++) handleRxByte(chunk[i]);
     }
 
-    // Also process command if we haven't received data for 50ms (timeout-based)
-    if (hasData && (millis() - lastCharTime > 50)) {
-        if (commandBuffer.length() > 0) {
-            handleCommand(commandBuffer);
-            commandBuffer = "";
-        }
-        hasData = false;
-    }
+    unsigned long now = millis();
+    serviceTones(now);
+    serviceAudio(now);
+    serviceDuplex(now);
+    serviceMic(now);
 
     delay(1);
 }
@@ -0,0 +1,612 @@
+#include "detection.h"
+#include "model_engine.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+// ===================== STATE =====================
+FsrCalibration fsrCalibration = { R_FIXED, FSR_AREA_MM2, FSR_CURVE_EXPONENT };
+DetectionConfig detectionConfig;
+uint16_t psiTable[ADC_CODES];
+uint16_t gripAdcThresholds[GRIP_TANTRUM];
+
+psi_t channelPSI[FSR_CHANNEL_COUNT];
+FsrFeatures fsrFeatures;
+
+// Grip state tracking
+GripState currentGripState = GRIP_NONE;
+GripState lastDetectedGripState = GRIP_NONE;
+int gripStateConfirmCounter = 0;
+
+// Pattern detection state
+int sequenceCount = 0;
+unsigned long lastReleaseTime = 0;
+bool isGripping = false;
+GripState currentMaxGrip = GRIP_NONE;
+GripState sequenceGrips[GRIP_PATTERN_COUNT];
+GripState dominantGripType = GRIP_STRESSED;
+unsigned long patternGapMs = 0;
+
+// Consecutive motion tracking
+MotionType lastMotionType = MOTION_NONE;
+int consecutiveMotionCount = 0;
+
+// PSI moving average over the last FSR_SAMPLES samples, one row per sample
+// so each pass walks contiguous memory. Rows start zeroed, which lets the
+// oldest row be subtracted unconditionally.
+static psi_t psiWindow[FSR_SAMPLES][FSR_CHANNEL_COUNT];
+static psi_t psiWindowSum[FSR_CHANNEL_COUNT];
+static int psiWindowIndex = 0;
+static int psiWindowFill = 0;
+
+ImuFeatureState imuFeatureState;
+ImuFeatures latestFeatures;
+
+ImpactDetector impactDetector;
+BounceDetector bounceDetector;
+FreeFallDetector freeFallDetector;
+ShakeDetector shakeDetector;
+SpinDetector spinDetector;
+RockDetector rockDetector;
+TrembleDetector trembleDetector;
+
+static uint32_t runningEngine = ENGINE_RULES;  // Engine whose state is current
+
+DetectionClockFn detectionClock = nullptr;
+DetectionStageFn detectionStageDone = nullptr;
+
+// ===================== HELPERS =====================
+// Integer square root (floor), bit-by-bit; avoids double-precision sqrt per sample
+uint32_t isqrt32(uint32_t n) {
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > n) bit >>= 2;
+  while (bit != 0) {
+    if (n >= root + bit) {
+      n -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+// ===================== CONFIG REGISTRY =====================
+// Ranges reject typos (a PSI of 800, a zero window) rather than enforce tuning policy
+const ConfigEntry DETECTION_CONFIG_ENTRIES[] = {
+  { "fsr_r_fixed",     CFG_FLOAT, &fsrCalibration.rFixed,             100,   1000000, true },
+  { "fsr_area_mm2",    CFG_FLOAT, &fsrCalibration.areaMm2,            0.1,   10000,   true },
+  { "fsr_exponent",    CFG_FLOAT, &fsrCalibration.exponent,           0.1,   5,       true },
+  { "psi_no_grip",     CFG_FLOAT, &detectionConfig.psiNoGrip,         0,     30,      false },
+  { "psi_calm",        CFG_FLOAT, &detectionConfig.psiCalm,           0,     30,      false },
+  { "psi_moderate",    CFG_FLOAT, &detectionConfig.psiModerate,       0,     30,      false },
+  { "psi_stressed",    CFG_FLOAT, &detectionConfig.psiStressed,       0,     30,      false },
+  { "grip_confirm",    CFG_INT,   &detectionConfig.gripConfirmCount,  1,     100,     false },
+  { "gap_max_ms",      CFG_UINT,  &detectionConfig.gapMaxMs,          50,    10000,   false },
+  { "motion_repeat",   CFG_INT,   &detectionConfig.motionRepeatCount, 1,     100,     false },
+  { "engine",          CFG_UINT,  &detectionConfig.engine,            0,     ENGINE_COUNT - 1, false },
+  { "model_confirm",   CFG_INT,   &detectionConfig.modelGripConfirm,  1,     50,      false },
+  { "model_repeat",    CFG_INT,   &detectionConfig.modelMotionRepeat, 1,     50,      false },
+  { "spin_thresh",     CFG_INT,   &detectionConfig.spinThreshold,     0,     32767,   false },
+  { "spin_min_ms",     CFG_UINT,  &detectionConfig.spinMinMs,         0,     10000,   false },
+  { "rock_tilt",       CFG_INT,   &detectionConfig.rockTilt,          0,     32767,   false },
+  { "rock_crossings",  CFG_INT,   &detectionConfig.rockCrossings,     1,     100,     false },
+  { "rock_window_ms",  CFG_UINT,  &detectionConfig.rockWindowMs,      1,     10000,   false },
+  { "bounce_thresh",   CFG_INT,   &detectionConfig.bounceThreshold,   0,     32767,   false },
+  { "bounce_count",    CFG_INT,   &detectionConfig.bounceCount,       1,     100,     false },
+  { "bounce_window",   CFG_UINT,  &detectionConfig.bounceWindowMs,    1,     10000,   false },
+  { "bounce_debounce", CFG_UINT,  &detectionConfig.bounceDebounceMs,  0,     10000,   false },
+  { "fall_thresh",     CFG_INT,   &detectionConfig.fallThreshold,     0,     32767,   false },
+  { "fall_min_ms",     CFG_UINT,  &detectionConfig.fallMinMs,         0,     10000,   false },
+  { "impact_thresh",   CFG_INT,   &detectionConfig.impactThreshold,   0,     56755,   false },
+  { "shake_thresh",    CFG_INT,   &detectionConfig.shakeThreshold,    0,     56755,   false },
+  { "shake_count",     CFG_INT,   &detectionConfig.shakeCount,        1,     1000,    false },
+  { "shake_window",    CFG_UINT,  &detectionConfig.shakeWindowMs,     1,     10000,   false },
+  { "tremble_min",     CFG_INT,   &detectionConfig.trembleMin,        0,     56755,   false },
+  { "tremble_max",     CFG_INT,   &detectionConfig.trembleMax,        0,     56755,   false },
+  { "tremble_count",   CFG_INT,   &detectionConfig.trembleCount,      1,     1000,    false },
+  { "tremble_window",  CFG_UINT,  &detectionConfig.trembleWindowMs,   1,     10000,   false },
+  { "tremble_gap_ms",  CFG_UINT,  &detectionConfig.trembleGapMs,      0,     1000,    false },
+};
+const int DETECTION_CONFIG_ENTRY_COUNT = sizeof(DETECTION_CONFIG_ENTRIES) / sizeof(DETECTION_CONFIG_ENTRIES[0]);
+
+// Keys are matched case-insensitively (Pi commands arrive uppercased)
+const ConfigEntry* findConfigEntry(const ConfigEntry *table, int count, const char *key) {
+  for (int i = 0; i < count; i++) {
+    if (strcasecmp(table[i].key, key) == 0) return &table[i];
+  }
+  return nullptr;
+}
+
+// Parse text into the entry's field; false (field untouched) if malformed or out of range.
+// Does not apply: call applyDetectionConfig() / rebuildPSITable() afterwards.
+bool parseConfigValue(const ConfigEntry &e, const char *text) {
+  char *end;
+  float v = (e.type == CFG_FLOAT) ? strtof(text, &end) : (float)strtol(text, &end, 10);
+  if (end == text || *end != '\0' || !(v >= e.minValue && v <= e.maxValue)) return false;
+
+  switch (e.type) {
+    case CFG_INT:   *(int32_t *)e.value = (int32_t)v; break;
+    case CFG_UINT:  *(uint32_t *)e.value = (uint32_t)v; break;
+    case CFG_FLOAT: *(float *)e.value = v; break;
+  }
+  return true;
+}
+
+// Thresholds are range-checked one at a time; this checks the ordering the
+// classifiers rely on. nullptr when consistent, else the broken rule.
+const char* detectionConfigOrderError() {
+  const DetectionConfig &cfg = detectionConfig;
+  if (!(cfg.psiNoGrip < cfg.psiCalm && cfg.psiCalm < cfg.psiModerate && cfg.psiModerate < cfg.psiStressed)) {
+    return "psi_no_grip<psi_calm<psi_moderate<psi_stressed";
+  }
+  if (!(cfg.trembleMin < cfg.trembleMax)) return "tremble_min<tremble_max";
+  return nullptr;
+}
+
+int formatConfigValue(const ConfigEntry &e, char *buf, size_t len) {
+  switch (e.type) {
+    case CFG_INT:   return snprintf(buf, len, "%ld", (long)*(const int32_t *)e.value);
+    case CFG_UINT:  return snprintf(buf, len, "%lu", (unsigned long)*(const uint32_t *)e.value);
+    case CFG_FLOAT: return snprintf(buf, len, "%g", *(const float *)e.value);
+  }
+  return 0;
+}
+
+// Refresh the derived hot-path fields from the tunables
+void applyDetectionConfig() {
+  DetectionConfig &cfg = detectionConfig;
+  cfg.noGripQ = psiFromFloat(cfg.psiNoGrip);
+  cfg.calmQ = psiFromFloat(cfg.psiCalm);
+  cfg.moderateQ = psiFromFloat(cfg.psiModerate);
+  cfg.stressedQ = psiFromFloat(cfg.psiStressed);
+  cfg.fallThresholdSq = (uint32_t)cfg.fallThreshold * (uint32_t)cfg.fallThreshold;
+  cfg.impactThresholdSq = (uint32_t)cfg.impactThreshold * (uint32_t)cfg.impactThreshold;
+
+  gripAdcThresholds[GRIP_NONE] = psiToAdcCode(cfg.psiNoGrip);
+  gripAdcThresholds[GRIP_CALM] = psiToAdcCode(cfg.psiCalm);
+  gripAdcThresholds[GRIP_MODERATE] = psiToAdcCode(cfg.psiModerate);
+  gripAdcThresholds[GRIP_STRESSED] = psiToAdcCode(cfg.psiStressed);
+}
+
+// Factory defaults for every registry entry, then rebuild the table
+void resetDetectionConfig() {
+  detectionConfig = DetectionConfig();
+  fsrCalibration = { R_FIXED, FSR_AREA_MM2, FSR_CURVE_EXPONENT };
+  rebuildPSITable();
+}
+
+// ===================== FSR TO PSI CONVERSION =====================
+// Converts raw ADC reading to PSI (pounds per square inch)
+// Uses voltage divider formula and FSR characteristic curve.
+// The float math only runs when building psiTable; the hot path is a table lookup.
+
+float computeForceN(int adcValue, const FsrCalibration &cal) {
+  // Prevent division by zero and filter noise
+  if (adcValue < 50) return 0.0;
+
+  // Step 1: Calculate voltage from ADC reading
+  float voltage = adcValue * (VCC / ADC_MAX);
+
+  // Step 2: Calculate FSR resistance using voltage divider formula
+  // Vout = Vcc * R_fixed / (R_fixed + R_fsr)
+  // Solving for R_fsr: R_fsr = R_fixed * (Vcc - Vout) / Vout
+  float fsrResistance = cal.rFixed * (VCC - voltage) / voltage;
+
+  // Step 3: Convert resistance to force (Newtons)
+  // Based on FSR 402 characteristic curve: R ≈ 1/F^1.1 (approximately)
+  // Force (N) ≈ (1,000,000 / R)^(1/1.1)
+  float forceN = 0.0;
+  if (fsrResistance > 0 && fsrResistance < 1000000) {
+    forceN = pow(1000000.0 / fsrResistance, cal.exponent);  // 1/1.1 ≈ 0.909
+  }
+  return forceN;
+}
+
+float computePSI(int adcValue, const FsrCalibration &cal) {
+  float forceN = computeForceN(adcValue, cal);
+
+  // Step 4: Convert force to PSI
+  // PSI = Force(N) / Area(m²) / 6894.76 (Pa per PSI)
+  // Area in m² = Area_mm² * 1e-6
+  float areaM2 = cal.areaMm2 * 1e-6;
+  float psi = forceN / (areaM2 * 6894.76);
+
+  // Clamp to reasonable range for child grip (0-30 PSI max)
+  if (psi > 30.0) psi = 30.0;
+
+  return psi;
+}
+
+// Active area that makes adcValue read refPsi under cal's resistor and curve
+// (single-point fit for CAL:REF); 0 if the code is below the noise floor
+float fitFsrArea(int adcValue, float refPsi, const FsrCalibration &cal) {
+  float forceN = computeForceN(adcValue, cal);
+  if (forceN <= 0 || refPsi <= 0) return 0;
+  return forceN / (refPsi * 6894.76) * 1e6;
+}
+
+// Regenerate psiTable from the current fsrCalibration (~4096 pow() calls, boot/calibration only)
+void rebuildPSITable() {
+  for (int code = 0; code < ADC_CODES; code++) {
+    psiTable[code] = (uint16_t)(computePSI(code, fsrCalibration) * 100.0 + 0.5);
+  }
+  applyDetectionConfig();
+}
+
+// Lowest ADC code whose table entry reaches psi (ADC_CODES - 1 if none does)
+uint16_t psiToAdcCode(float psi) {
+  uint16_t target = (uint16_t)(psi * 100.0 + 0.5);
+  for (int code = 0; code < ADC_CODES; code++) {
+    if (psiTable[code] >= target) return code;
+  }
+  return ADC_CODES - 1;
+}
+
+// ADC code -> PSI via lookup table
+psi_t adcToPSI(int adcValue) {
+  if (adcValue < 0) adcValue = 0;
+  if (adcValue >= ADC_CODES) adcValue = ADC_CODES - 1;
+  return psiFromCenti(psiTable[adcValue]);
+}
+
+// One pass over the pad array: table lookup, moving average and the
+// max/sum/centroid features. Updates channelPSI and fsrFeatures.
+// In fixed point the truncating divide keeps threshold compares identical to
+// the float path: floor(sum / n) < t  <=>  sum / n < t for integer t.
+void updateFsrChannels(const SensorSample &s) {
+  if (psiWindowFill < FSR_SAMPLES) psiWindowFill++;
+  psi_t *row = psiWindow[psiWindowIndex];
+  psiWindowIndex = (psiWindowIndex + 1) % FSR_SAMPLES;
+
+  FsrFeatures &f = fsrFeatures;
+  psi_t weighted = 0;
+  f.maxPsi = 0;
+  f.sumPsi = 0;
+  f.maxChannel = 0;
+  f.activeCount = 0;
+
+  for (int c = 0; c < FSR_CHANNEL_COUNT; c++) {
+    psi_t psi = adcToPSI(s.fsrRaw[c]);
+    psiWindowSum[c] += psi - row[c];
+    row[c] = psi;
+
+    psi_t avg = psiWindowSum[c] / psiWindowFill;
+    channelPSI[c] = avg;
+
+    if (avg > f.maxPsi) {
+      f.maxPsi = avg;
+      f.maxChannel = c;
+    }
+    if (avg >= detectionConfig.noGripQ) f.activeCount++;
+    f.sumPsi += avg;
+    weighted += avg * c;
+  }
+
+  f.centroid = f.sumPsi > 0 ? (uint16_t)(weighted * 256 / f.sumPsi) : 0;
+}
+
+// ===================== GRIP STATE DETECTION =====================
+// Determines child's emotional state based on grip pressure
+
+GripState detectGripState(psi_t psi) {
+  const DetectionConfig &cfg = detectionConfig;
+  if (psi < cfg.noGripQ) {
+    return GRIP_NONE;
+  } else if (psi < cfg.calmQ) {
+    return GRIP_CALM;
+  } else if (psi < cfg.moderateQ) {
+    return GRIP_MODERATE;
+  } else if (psi < cfg.stressedQ) {
+    return GRIP_STRESSED;
+  } else {
+    return GRIP_TANTRUM;
+  }
+}
+
+// Same classification for one raw ADC code, without touching psiTable
+GripState detectGripStateAdc(uint16_t adcValue) {
+  int state = GRIP_NONE;
+  while (state < GRIP_TANTRUM && adcValue >= gripAdcThresholds[state]) state++;
+  return (GripState)state;
+}
+
+// Convert grip state to readable string
+const char* gripStateToString(GripState state) {
+  switch (state) {
+    case GRIP_NONE:     return "None";
+    case GRIP_CALM:     return "Calm";
+    case GRIP_MODERATE: return "Moderate";
+    case GRIP_STRESSED: return "Stressed";
+    case GRIP_TANTRUM:  return "Tantrum";
+    default:            return "Unknown";
+  }
+}
+
+// Update grip state with confirmation (prevents false triggers)
+// Returns true if state changed and was confirmed
+// maxPSI is the strongest pad (dominant hand or stronger grip)
+bool updateGripState(psi_t maxPSI) {
+  GripState detected = detectGripState(maxPSI);
+
+  if (detected == lastDetectedGripState) {
+    gripStateConfirmCounter++;
+  } else {
+    gripStateConfirmCounter = 1;
+    lastDetectedGripState = detected;
+  }
+
+  // Confirm state change after consistent readings
+  if (gripStateConfirmCounter >= detectionConfig.gripConfirmCount) {
+    if (detected != currentGripState) {
+      currentGripState = detected;
+      return true;  // State changed
+    }
+  }
+
+  return false;  // No change
+}
+
+// Check if child is in distress (tantrum or stressed state)
+bool isChildInDistress() {
+  return (currentGripState == GRIP_TANTRUM || currentGripState == GRIP_STRESSED);
+}
+
+// Determine dominant grip type from the grip sequence
+// Returns GRIP_TANTRUM if 2+ tantrum grips, otherwise GRIP_STRESSED
+GripState getDominantGripType() {
+  int tantrumCount = 0;
+  int stressedCount = 0;
+
+  for (int i = 0; i < GRIP_PATTERN_COUNT; i++) {
+    if (sequenceGrips[i] == GRIP_TANTRUM) {
+      tantrumCount++;
+    } else if (sequenceGrips[i] == GRIP_STRESSED) {
+      stressedCount++;
+    }
+  }
+
+  // Tantrum is dominant if 2 or more tantrum grips
+  if (tantrumCount >= 2) {
+    return GRIP_TANTRUM;
+  }
+  return GRIP_STRESSED;
+}
+
+// ===================== GRIP PATTERN LOGIC =====================
+// GRIP_PATTERN_COUNT distinct grips > psiStressed with gap < gapMaxMs between them.
+PatternStep updateGripPattern(psi_t maxPSI, unsigned long now) {
+  // 1. Detect Grip Start (Pressure > Stressed Threshold)
+  if (maxPSI >= detectionConfig.stressedQ) {
+    if (isGripping) {
+      // CONTINUING a grip
+      // Update max grip strength observed during this hold
+      GripState potentialState = detectGripState(maxPSI);
+      if (potentialState > currentMaxGrip) {
+        currentMaxGrip = potentialState;
+      }
+      return PATTERN_HOLD;
+    }
+
+    // START of a new grip
+    isGripping = true;
+    currentMaxGrip = detectGripState(maxPSI); // Initialize max for this grip
+    patternGapMs = now - lastReleaseTime;
+
+    // Check Gap Logic
+    PatternStep step = PATTERN_GRIP_START;
+    if (sequenceCount > 0) {
+      // We have previous grips. Check if gap is valid.
+      if (patternGapMs > detectionConfig.gapMaxMs) {
+        // TIMEOUT: Gap too long. Reset sequence; treat this as the NEW first grip
+        sequenceCount = 0;
+        step = PATTERN_GAP_RESET;
+      } else {
+        step = PATTERN_GAP_VALID;
+      }
+    }
+
+    // Increment count for this new grip
+    sequenceCount++;
+
+    // CHECK COMPLETION (Trigger on start of the last grip)
+    if (sequenceCount >= GRIP_PATTERN_COUNT) {
+      // Store the last grip type and pick the dominant one
+      sequenceGrips[GRIP_PATTERN_COUNT - 1] = currentMaxGrip;
+      dominantGripType = getDominantGripType();
+
+      // Reset sequence (keep isGripping=true to avoid double counting)
+      sequenceCount = 0;
+      return PATTERN_TRIGGERED;
+    }
+    return step;
+  }
+
+  // RELEASE (Pressure < Stressed Threshold)
+  if (!isGripping) return PATTERN_IDLE;
+
+  // END of a grip
+  isGripping = false;
+  lastReleaseTime = now;
+
+  // Store the max grip we saw (if we haven't triggered/reset yet)
+  // Note: If we triggered, sequenceCount is already 0.
+  if (sequenceCount > 0 && sequenceCount < GRIP_PATTERN_COUNT) {
+    sequenceGrips[sequenceCount - 1] = currentMaxGrip;
+  }
+  return PATTERN_RELEASED;
+}
+
+// ===================== MOTION FEATURES =====================
+const char* motionToString(MotionType motion) {
+  switch (motion) {
+    case MOTION_NONE:          return "None";
+    case MOTION_IMPACT:        return "Impact";
+    case MOTION_BOUNCE:        return "Bounce";
+    case MOTION_FREEFALL:      return "FreeFall";
+    case MOTION_VIOLENT_SHAKE: return "ViolentShake";
+    case MOTION_SPINNING:      return "Spinning";
+    case MOTION_ROCKING:       return "Rocking";
+    case MOTION_TREMBLE:       return "Tremble";
+    default:                   return "Unknown";
+  }
+}
+
+void extractImuFeatures(const SensorSample &s, ImuFeatures &f) {
+  ImuFeatureState &st = imuFeatureState;
+  const int16_t accel[3] = { s.ax, s.ay, s.az };
+  const int32_t tilt = detectionConfig.rockTilt;
+
+  // Each square is at most 2^30, so the sum fits in uint32_t
+  f.magSq = 0;
+  for (int i = 0; i < 3; i++) {
+    int32_t v = accel[i];
+    f.magSq += (uint32_t)(v * v);
+  }
+  f.mag = isqrt32(f.magSq);
+
+  f.magDelta = st.primed ? labs(f.mag - st.lastMag) : f.mag;
+  f.jerk = 0;
+  f.axisCrossings = 0;
+  for (int i = 0; i < 3; i++) {
+    if (st.primed) f.jerk += labs((long)accel[i] - st.lastAccel[i]);
+
+    bool isPositive = accel[i] > tilt;
+    bool isNegative = accel[i] < -tilt;
+    if ((st.axisPositive[i] && isNegative) || (!st.axisPositive[i] && isPositive)) {
+      f.axisCrossings |= (1 << i);
+      st.axisPositive[i] = isPositive;
+    }
+    st.lastAccel[i] = accel[i];
+  }
+
+  st.lastMag = f.mag;
+  st.primed = true;
+}
+
+// ===================== MOTION DETECTION =====================
+// Extract features, update all detectors, then pick the highest-priority hit
+MotionType classifyMotion(const SensorSample &s, unsigned long now) {
+  ImuFeatures &f = latestFeatures;
+  extractImuFeatures(s, f);
+
+  bool impact = impactDetector.update(f);
+  bool bounce = bounceDetector.update(s, now);
+  bool freeFall = freeFallDetector.update(f, now);
+  bool shake = shakeDetector.update(f, now);
+  bool spin = spinDetector.update(s, now);
+  bool rock = rockDetector.update(f, now);
+  bool tremble = trembleDetector.update(f, now);
+
+  if (impact) return MOTION_IMPACT;
+  if (bounce) return MOTION_BOUNCE;
+  if (freeFall) return MOTION_FREEFALL;
+  if (shake) return MOTION_VIOLENT_SHAKE;
+  if (spin) return MOTION_SPINNING;
+  if (rock) return MOTION_ROCKING;
+  if (tremble) return MOTION_TREMBLE;
+  return MOTION_NONE;
+}
+
+// Track consecutive same-type motions; true once motionRepeatCount is reached
+bool updateMotionRepeat(MotionType motion) {
+  if (motion == MOTION_NONE) return false;
+
+  if (motion == lastMotionType) {
+    consecutiveMotionCount++;
+  } else {
+    consecutiveMotionCount = 1;
+    lastMotionType = motion;
+  }
+
+  if (consecutiveMotionCount >= detectionConfig.motionRepeatCount) {
+    consecutiveMotionCount = 0;  // Reset after triggering
+    return true;
+  }
+  return false;
+}
+
+// ===================== PIPELINE =====================
+const char* engineToString(DetectionEngine engine) {
+  switch (engine) {
+    case ENGINE_RULES: return "rules";
+    case ENGINE_MODEL: return "model";
+    default:           return "unknown";
+  }
+}
+
+// Full per-sample pass: PSI average, grip state + pattern, motion + repeats.
+// All timing decisions use s.timeMs, so a recorded trace replays identically.
+void runRuleDetection(const SensorSample &s, DetectionResult &r) {
+  uint32_t t = detectionStageStart();
+  updateFsrChannels(s);
+  r.maxPSI = fsrFeatures.maxPsi;
+  detectionStageEnd(DETECT_STAGE_PSI, t);
+
+  t = detectionStageStart();
+  r.previousGrip = currentGripState;
+  r.gripChanged = updateGripState(r.maxPSI);
+  r.patternStep = updateGripPattern(r.maxPSI, s.timeMs);
+  detectionStageEnd(DETECT_STAGE_PATTERN, t);
+
+  t = detectionStageStart();
+  r.motion = classifyMotion(s, s.timeMs);
+  detectionStageEnd(DETECT_STAGE_MOTION, t);
+
+  r.motionTriggered = updateMotionRepeat(r.motion);
+  r.repeatMotion = lastMotionType;
+  r.repeatCount = r.motionTriggered ? detectionConfig.motionRepeatCount : consecutiveMotionCount;
+}
+
+// An engine switch starts the new engine from power-on state
+void runDetection(const SensorSample &s, DetectionResult &r) {
+  if (detectionConfig.engine != runningEngine) {
+    runningEngine = detectionConfig.engine;
+    resetDetection();
+  }
+
+  if (runningEngine == ENGINE_MODEL) {
+    runModelDetection(s, r);
+  } else {
+    runRuleDetection(s, r);
+  }
+}
+
+// Back to power-on state (psiTable, fsrCalibration and detectionConfig are kept)
+void resetDetection() {
+  currentGripState = GRIP_NONE;
+  lastDetectedGripState = GRIP_NONE;
+  gripStateConfirmCounter = 0;
+  memset(channelPSI, 0, sizeof(channelPSI));
+  fsrFeatures = FsrFeatures();
+
+  sequenceCount = 0;
+  lastReleaseTime = 0;
+  isGripping = false;
+  currentMaxGrip = GRIP_NONE;
+  memset(sequenceGrips, 0, sizeof(sequenceGrips));
+  dominantGripType = GRIP_STRESSED;
+  patternGapMs = 0;
+
+  lastMotionType = MOTION_NONE;
+  consecutiveMotionCount = 0;
+
+  memset(psiWindow, 0, sizeof(psiWindow));
+  memset(psiWindowSum, 0, sizeof(psiWindowSum));
+  psiWindowIndex = 0;
+  psiWindowFill = 0;
+
+  imuFeatureState = ImuFeatureState();
+  impactDetector = ImpactDetector();
+  bounceDetector = BounceDetector();
+  freeFallDetector = FreeFallDetector();
+  shakeDetector = ShakeDetector();
+  spinDetector = SpinDetector();
+  rockDetector = RockDetector();
+  trembleDetector = TrembleDetector();
+
+  resetModelEngine();
+}
@@ -0,0 +1,481 @@
+// Grip and motion detection core shared by the firmware and the host tools.
+// Plain C++ (stdint/math only): no Arduino globals, no millis(), no hardware.
+// Time comes from each sample's timeMs; stage timing goes through the
+// injectable detectionClock / detectionStageDone hooks.
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+// ===================== FSR TO PSI CONFIGURATION =====================
+// Circuit: FSR in voltage divider with 10kΩ resistor
+// 10kΩ Resistor Color Code: Brown-Black-Orange-Gold
+const float VCC = 3.3;                    // ESP32 ADC reference voltage
+const float ADC_MAX = 4095.0;             // 12-bit ADC resolution
+const float R_FIXED = 10000.0;            // 10kΩ fixed resistor
+const float FSR_AREA_MM2 = 20.0;          // FSR active area in mm² (typical for FSR402)
+const float FSR_CURVE_EXPONENT = 0.909;   // Force ≈ (1e6 / R_fsr)^exponent (1/1.1 for FSR402)
+const int ADC_CODES = 4096;               // Size of the ADC -> PSI lookup table
+const int FSR_SAMPLES = 5;                // Number of fixed-rate samples in the PSI moving average
+
+// Pressure pads in the FSR array (pin list in main.cpp). ADC1 has 8 channels,
+// GPIO32-39, so the DMA scan covers at most 8 pads.
+#ifndef FSR_CHANNEL_COUNT
+#define FSR_CHANNEL_COUNT 2
+#endif
+static_assert(FSR_CHANNEL_COUNT >= 1 && FSR_CHANNEL_COUNT <= 8, "FSR_CHANNEL_COUNT must be 1-8");
+
+// ===================== CHILD GRIP THRESHOLDS (PSI) =====================
+// Calibrated for autism child tantrum detection
+// Children aged 3-12 have lower grip strength than adults
+// These thresholds detect escalating emotional states
+
+const float PSI_NO_GRIP = 0.1;            // Below this = no contact
+const float PSI_CALM = 0.5;               // Light hold - child is calm
+const float PSI_MODERATE = 4.0;           // Moderate grip - mild anxiety/restlessness
+const float PSI_STRESSED = 8.0;           // Firm grip - stressed/agitated state
+const float PSI_TANTRUM = 16.0;            // Hard grip - tantrum/meltdown detected
+
+// ===================== PSI NUMBER FORMAT =====================
+// DETECTION_FIXED_POINT=1 (default) carries PSI as integer centi-PSI (the
+// psiTable unit) from the table lookup through the moving average, grip
+// thresholds and pattern logic, so the per-sample path has no float ops
+// (ESP32-C3/S2 have no FPU). Build with -DDETECTION_FIXED_POINT=0 to run
+// the float path for comparison. Floats remain for table generation and
+// for human-readable output (psiToFloat).
+#ifndef DETECTION_FIXED_POINT
+#define DETECTION_FIXED_POINT 1
+#endif
+
+#if DETECTION_FIXED_POINT
+typedef int32_t psi_t;  // Hundredths of a PSI
+inline psi_t psiFromFloat(float psi) { return (psi_t)(psi * 100.0f + 0.5f); }
+inline psi_t psiFromCenti(uint16_t centi) { return centi; }
+inline float psiToFloat(psi_t psi) { return psi * 0.01f; }
+inline uint16_t psiToCenti(psi_t psi) { return (uint16_t)psi; }
+#else
+typedef float psi_t;
+inline psi_t psiFromFloat(float psi) { return psi; }
+inline psi_t psiFromCenti(uint16_t centi) { return centi * 0.01f; }
+inline float psiToFloat(psi_t psi) { return psi; }
+inline uint16_t psiToCenti(psi_t psi) { return (uint16_t)(psi * 100.0f + 0.5f); }
+#endif
+
+// Grip state enumeration
+enum GripState {
+  GRIP_NONE,        // No contact with ball
+  GRIP_CALM,        // Relaxed holding - baseline state
+  GRIP_MODERATE,    // Slight anxiety - early warning
+  GRIP_STRESSED,    // Elevated stress - intervention may help
+  GRIP_TANTRUM      // Tantrum/meltdown - immediate attention needed
+};
+
+// Motion classification (values double as binary telemetry motion codes)
+enum MotionType : uint8_t {
+  MOTION_NONE,
+  MOTION_IMPACT,
+  MOTION_BOUNCE,
+  MOTION_FREEFALL,
+  MOTION_VIOLENT_SHAKE,
+  MOTION_SPINNING,
+  MOTION_ROCKING,
+  MOTION_TREMBLE,
+  MOTION_TYPE_COUNT
+};
+
+// Factory defaults below; the values actually used live in detectionConfig.
+
+// Consecutive readings required to confirm state change (prevents false triggers)
+const int GRIP_STATE_CONFIRM_COUNT = 5;
+
+// Pattern detection
+const unsigned long GAP_MAX_MS = 1000;      // Max gap allowed between grips (1000ms)
+const int GRIP_PATTERN_COUNT = 5;           // Number of grips to trigger
+
+// Consecutive same-type motions that trigger a sound
+const int CONSECUTIVE_MOTION_THRESHOLD = 5;
+
+const int ROCK_TILT_THRESHOLD = 12000;  // Was 5000 - now needs bigger tilt
+
+// Detection engine behind runDetection() (detectionConfig.engine)
+enum DetectionEngine : uint8_t {
+  ENGINE_RULES,     // Threshold detectors + grip confirmation (this file)
+  ENGINE_MODEL,     // Int8 window classifier (model_engine.h)
+  ENGINE_COUNT
+};
+
+// ===================== RUNTIME CONFIG =====================
+// Everything tunable per unit or per child. The firmware loads it from NVS once
+// at boot (CFG: commands change it); the host tools use the defaults or -s.
+// Call applyDetectionConfig() after changing a field (rebuildPSITable() does).
+// Aligned so the hot fields share as few cache lines as possible.
+struct alignas(32) DetectionConfig {
+  // Grip thresholds (PSI) and confirmation
+  float psiNoGrip = PSI_NO_GRIP;
+  float psiCalm = PSI_CALM;
+  float psiModerate = PSI_MODERATE;
+  float psiStressed = PSI_STRESSED;
+  int32_t gripConfirmCount = GRIP_STATE_CONFIRM_COUNT;
+  uint32_t gapMaxMs = GAP_MAX_MS;
+  int32_t motionRepeatCount = CONSECUTIVE_MOTION_THRESHOLD;
+  uint32_t engine = ENGINE_RULES;
+
+  // Model engine: consecutive inferences to confirm a grip change / trigger a motion
+  int32_t modelGripConfirm = 2;
+  int32_t modelMotionRepeat = 3;
+
+  // Motion detectors (raw MPU6050 counts at ±2g / ±250°/s)
+  int32_t spinThreshold = 25000;      // Was 10000 - now needs strong spin
+  uint32_t spinMinMs = 500;
+  int32_t rockTilt = ROCK_TILT_THRESHOLD;
+  int32_t rockCrossings = 4;
+  uint32_t rockWindowMs = 1500;
+  int32_t bounceThreshold = 28000;    // Was 20000 - now needs harder bounce
+  int32_t bounceCount = 3;
+  uint32_t bounceWindowMs = 1000;
+  uint32_t bounceDebounceMs = 200;
+  int32_t fallThreshold = 1500;       // Was 2000 - stricter (must be closer to zero-g)
+  uint32_t fallMinMs = 150;           // Was 100 - needs longer fall time
+  int32_t impactThreshold = 38000;    // Was 30000 - now needs harder impact
+  int32_t shakeThreshold = 15000;     // Was 8000 - now needs violent shaking
+  int32_t shakeCount = 12;            // Was 10 - needs more shakes
+  uint32_t shakeWindowMs = 1000;
+  int32_t trembleMin = 6000;          // Was 3500 - minimum change to count as tremble
+  int32_t trembleMax = 14000;         // Was 7000 - max change (above = shake)
+  int32_t trembleCount = 18;          // Was 15 - needs more trembles
+  uint32_t trembleWindowMs = 800;     // Time window to accumulate trembles
+  uint32_t trembleGapMs = 30;         // Minimum ms between counting trembles
+
+  // Derived by applyDetectionConfig() in the units the hot path compares
+  psi_t noGripQ = psiFromFloat(PSI_NO_GRIP);
+  psi_t calmQ = psiFromFloat(PSI_CALM);
+  psi_t moderateQ = psiFromFloat(PSI_MODERATE);
+  psi_t stressedQ = psiFromFloat(PSI_STRESSED);
+  uint32_t fallThresholdSq = 1500UL * 1500UL;
+  uint32_t impactThresholdSq = 38000UL * 38000UL;
+};
+extern DetectionConfig detectionConfig;
+
+// Typed registry over detectionConfig/fsrCalibration: one entry per tunable,
+// keyed by its NVS name (15 chars max) which is also the CFG: command name.
+// The firmware adds its own table for non-detection settings.
+enum ConfigType : uint8_t { CFG_INT, CFG_UINT, CFG_FLOAT };
+
+struct ConfigEntry {
+  const char *key;
+  ConfigType type;
+  void *value;            // int32_t / uint32_t / float, per type
+  float minValue;
+  float maxValue;
+  bool fsrCurve;          // Needs rebuildPSITable(), not just applyDetectionConfig()
+};
+extern const ConfigEntry DETECTION_CONFIG_ENTRIES[];
+extern const int DETECTION_CONFIG_ENTRY_COUNT;
+
+// ===================== SAMPLE =====================
+// One acquisition from the sampling task (or one row of a recorded trace)
+struct SensorSample {
+  unsigned long timeMs;   // Acquisition time derived from the sensor sample index (evenly spaced)
+  uint16_t fsrRaw[FSR_CHANNEL_COUNT];  // ADC code per pad, in FSR_PINS order
+  int16_t ax, ay, az;
+  int16_t gx, gy, gz;
+};
+
+// ===================== FSR CALIBRATION STATE =====================
+// Runtime copy of the curve parameters above; rebuildPSITable() must run after changes
+struct FsrCalibration {
+  float rFixed;       // Divider resistor (ohms)
+  float areaMm2;      // FSR active area (mm²)
+  float exponent;     // Resistance -> force curve exponent
+};
+extern FsrCalibration fsrCalibration;
+
+// ADC code -> PSI in hundredths (0-3000), generated at boot from fsrCalibration
+extern uint16_t psiTable[ADC_CODES];
+
+// Lowest ADC code of each grip state above GRIP_NONE (PSI thresholds inverted
+// through the table by rebuildPSITable), for classifying raw codes directly
+extern uint16_t gripAdcThresholds[GRIP_TANTRUM];
+
+// ===================== DETECTION STATE =====================
+// Per-sample features across the pad array, computed in one pass
+struct FsrFeatures {
+  psi_t maxPsi;           // Strongest pad (drives grip state)
+  psi_t sumPsi;           // Total pressure over all pads
+  uint16_t centroid;      // Pressure-weighted pad index x256 (0 with no pressure)
+  uint8_t maxChannel;     // Index of the strongest pad
+  uint8_t activeCount;    // Pads at or above psiNoGrip
+};
+
+// Averaged PSI per pad and the features derived from it
+extern psi_t channelPSI[FSR_CHANNEL_COUNT];
+extern FsrFeatures fsrFeatures;
+
+// Grip state tracking
+extern GripState currentGripState;
+extern GripState lastDetectedGripState;
+extern int gripStateConfirmCounter;
+
+// Pattern detection state
+extern int sequenceCount;                   // Current grip number (0-based or 1-based tracking)
+extern unsigned long lastReleaseTime;       // Time when last grip was released
+extern bool isGripping;                     // Are we currently in a grip?
+extern GripState currentMaxGrip;            // Max grip level reached during current grip
+extern GripState sequenceGrips[GRIP_PATTERN_COUNT]; // Store grip types for the pattern
+extern GripState dominantGripType;          // The dominant type across all 5 grips
+extern unsigned long patternGapMs;          // Gap before the latest grip start
+
+// Consecutive motion tracking
+extern MotionType lastMotionType;
+extern int consecutiveMotionCount;
+
+// Result of one updateGripPattern() call (callers log from this)
+enum PatternStep : uint8_t {
+  PATTERN_IDLE,         // No grip, nothing changed
+  PATTERN_HOLD,         // Grip continuing
+  PATTERN_GRIP_START,   // First grip of a sequence
+  PATTERN_GAP_VALID,    // Next grip within gapMaxMs (patternGapMs)
+  PATTERN_GAP_RESET,    // Gap too long (patternGapMs), sequence restarted
+  PATTERN_RELEASED,     // Grip released
+  PATTERN_TRIGGERED     // GRIP_PATTERN_COUNT grips completed
+};
+
+// ===================== STAGE TIMING HOOKS =====================
+// The firmware points these at the cycle-counter profiler, the host tools at
+// a steady clock. Either may be null (no timing).
+enum DetectionStage : uint8_t {
+  DETECT_STAGE_PSI,       // ADC -> PSI + moving average
+  DETECT_STAGE_PATTERN,   // Grip state + 5-grip pattern
+  DETECT_STAGE_MOTION,    // Feature pass + seven detectors
+  DETECT_STAGE_COUNT
+};
+typedef uint32_t (*DetectionClockFn)();
+typedef void (*DetectionStageFn)(DetectionStage stage, uint32_t start);
+extern DetectionClockFn detectionClock;
+extern DetectionStageFn detectionStageDone;
+
+inline uint32_t detectionStageStart() {
+  return detectionClock ? detectionClock() : 0;
+}
+
+inline void detectionStageEnd(DetectionStage stage, uint32_t start) {
+  if (detectionStageDone) detectionStageDone(stage, start);
+}
+
+// Everything runDetection() decided for one sample
+struct DetectionResult {
+  psi_t maxPSI;               // Averaged PSI of the strongest pad
+  bool gripChanged;           // Confirmed grip state change
+  GripState previousGrip;     // State before the change
+  PatternStep patternStep;
+  MotionType motion;          // Highest-priority detector hit (or None)
+  bool motionTriggered;       // motionRepeatCount same motions reached
+  MotionType repeatMotion;    // Motion counted toward the repeat (the alerted one when motionTriggered)
+  int repeatCount;            // Consecutive repeatMotion hits so far, the full count when triggered
+};
+
+// ===================== MOTION FEATURES =====================
+// Derived quantities computed once per sample and shared by every detector
+struct ImuFeatures {
+  uint32_t magSq;         // ax² + ay² + az² (integer, no sqrt)
+  long mag;               // floor(sqrt(magSq))
+  long magDelta;          // |mag - previous mag|
+  long jerk;              // |Δax| + |Δay| + |Δaz| since previous sample
+  uint8_t axisCrossings;  // Bit n set when accel axis n flipped past ±rockTilt
+};
+
+struct ImuFeatureState {
+  bool primed = false;
+  long lastMag = 0;
+  int16_t lastAccel[3] = {0, 0, 0};
+  bool axisPositive[3] = {true, true, true};  // Last side of the tilt band each axis was seen on
+};
+extern ImuFeatureState imuFeatureState;
+extern ImuFeatures latestFeatures;
+
+// ===================== MOTION DETECTION =====================
+// Every detector is updated on every sample; priority is applied afterwards
+// in classifyMotion() so one detector firing never starves another's state.
+// Thresholds increased for ball toy - needs significant motion to trigger
+struct SpinDetector {
+  unsigned long spinStartTime = 0;
+
+  bool update(const SensorSample &s, unsigned long now) {
+    const DetectionConfig &cfg = detectionConfig;
+
+    if (abs(s.gz) > cfg.spinThreshold) {
+      if (spinStartTime == 0) spinStartTime = now;
+      if (now - spinStartTime > cfg.spinMinMs) {
+        spinStartTime = 0;
+        return true;
+      }
+    } else spinStartTime = 0;
+
+    return false;
+  }
+};
+
+struct RockDetector {
+  unsigned long lastCrossTime = 0;
+  int crossCount = 0;
+
+  bool update(const ImuFeatures &f, unsigned long now) {
+    const DetectionConfig &cfg = detectionConfig;
+
+    if (now - lastCrossTime > cfg.rockWindowMs) crossCount = 0;
+
+    if (f.axisCrossings & 0x01) {  // X axis tilt flip
+      crossCount++;
+      lastCrossTime = now;
+    }
+
+    if (crossCount >= cfg.rockCrossings) {
+      crossCount = 0;
+      return true;
+    }
+
+    return false;
+  }
+};
+
+struct BounceDetector {
+  int bounceCount = 0;
+  unsigned long lastBounceTime = 0;
+
+  bool update(const SensorSample &s, unsigned long now) {
+    const DetectionConfig &cfg = detectionConfig;
+
+    if (now - lastBounceTime > cfg.bounceWindowMs) bounceCount = 0;
+
+    if (s.az > cfg.bounceThreshold) {
+      if (now - lastBounceTime > cfg.bounceDebounceMs) {
+        bounceCount++;
+        lastBounceTime = now;
+      }
+    }
+
+    if (bounceCount >= cfg.bounceCount) {
+      bounceCount = 0;
+      return true;
+    }
+    return false;
+  }
+};
+
+struct FreeFallDetector {
+  unsigned long fallStartTime = 0;
+
+  bool update(const ImuFeatures &f, unsigned long now) {
+    const DetectionConfig &cfg = detectionConfig;
+
+    if (f.magSq < cfg.fallThresholdSq) {
+      if (fallStartTime == 0) fallStartTime = now;
+      else if (now - fallStartTime > cfg.fallMinMs) return true;
+    } else fallStartTime = 0;
+
+    return false;
+  }
+};
+
+struct ImpactDetector {
+  bool update(const ImuFeatures &f) {
+    return f.magSq > detectionConfig.impactThresholdSq;
+  }
+};
+
+struct ShakeDetector {
+  int shakeCount = 0;
+  unsigned long lastTime = 0;
+
+  bool update(const ImuFeatures &f, unsigned long now) {
+    const DetectionConfig &cfg = detectionConfig;
+
+    if (now - lastTime > cfg.shakeWindowMs) shakeCount = 0;
+
+    if (f.magDelta > cfg.shakeThreshold) {
+      shakeCount++;
+      lastTime = now;
+    }
+
+    if (shakeCount >= cfg.shakeCount) {
+      shakeCount = 0;
+      return true;
+    }
+
+    return false;
+  }
+};
+
+struct TrembleDetector {
+  int trembleCount = 0;
+  unsigned long lastTime = 0;
+  unsigned long lastCountTime = 0;
+
+  bool update(const ImuFeatures &f, unsigned long now) {
+    const DetectionConfig &cfg = detectionConfig;
+
+    // Reset if window expired
+    if (now - lastTime > cfg.trembleWindowMs) trembleCount = 0;
+
+    // Only count if enough time passed since last count (prevents rapid false counting)
+    if (f.magDelta > cfg.trembleMin && f.magDelta < cfg.trembleMax) {
+      if (now - lastCountTime > cfg.trembleGapMs) {
+        trembleCount++;
+        lastCountTime = now;
+        lastTime = now;
+      }
+    }
+
+    if (trembleCount >= cfg.trembleCount) {
+      trembleCount = 0;
+      return true;
+    }
+
+    return false;
+  }
+};
+
+extern ImpactDetector impactDetector;
+extern BounceDetector bounceDetector;
+extern FreeFallDetector freeFallDetector;
+extern ShakeDetector shakeDetector;
+extern SpinDetector spinDetector;
+extern RockDetector rockDetector;
+extern TrembleDetector trembleDetector;
+
+// ===================== API =====================
+uint32_t isqrt32(uint32_t n);
+
+float computeForceN(int adcValue, const FsrCalibration &cal);
+float computePSI(int adcValue, const FsrCalibration &cal);
+float fitFsrArea(int adcValue, float refPsi, const FsrCalibration &cal);
+void rebuildPSITable();
+void applyDetectionConfig();
+uint16_t psiToAdcCode(float psi);
+psi_t adcToPSI(int adcValue);
+void updateFsrChannels(const SensorSample &s);
+
+GripState detectGripState(psi_t psi);
+GripState detectGripStateAdc(uint16_t adcValue);
+const char* gripStateToString(GripState state);
+bool updateGripState(psi_t maxPSI);
+bool isChildInDistress();
+GripState getDominantGripType();
+PatternStep updateGripPattern(psi_t maxPSI, unsigned long now);
+
+const char* motionToString(MotionType motion);
+void extractImuFeatures(const SensorSample &s, ImuFeatures &f);
+MotionType classifyMotion(const SensorSample &s, unsigned long now);
+bool updateMotionRepeat(MotionType motion);
+
+const ConfigEntry* findConfigEntry(const ConfigEntry *table, int count, const char *key);
+bool parseConfigValue(const ConfigEntry &e, const char *text);
+const char* detectionConfigOrderError();  // nullptr, or the threshold ordering that is broken
+int formatConfigValue(const ConfigEntry &e, char *buf, size_t len);
+void resetDetectionConfig();
+
+const char* engineToString(DetectionEngine engine);
+void runRuleDetection(const SensorSample &s, DetectionResult &r);
+void runDetection(const SensorSample &s, DetectionResult &r);  // Dispatches on detectionConfig.engine
+void resetDetection();
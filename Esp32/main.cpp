@@ -10,67 +10,430 @@
 #include <BLEAdvertising.h>
 #include <esp_coexist.h>
 #include <esp_wifi.h>
+#include <driver/adc.h>
+#include <lwip/sockets.h>
+#include <Preferences.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+
+#include "detection.h"  // Grip/motion detection core (also built by HostReplay/)
+#include "model_engine.h"  // Int8 classifier engine, selected with CFG:SET:engine=1
 
 // ===================== CONFIG =====================
+// NET_MODE_AP (default): this ball runs its own AP and the Pi joins it.
+// NET_MODE_STA (CFG:SET:net_mode=1, applied at boot): join the hub network so
+// one Pi serves a whole classroom of balls.
 const char* AP_SSID = "ESP32_StressBall";
 const char* AP_PASS = "12345678";
+const char* STA_SSID = "StressBall_Hub";  // Hub network (Pi hostapd or classroom router)
+const char* STA_PASS = "12345678";
 
 const char* PI_IP = "192.168.4.2";  // Pi AP mode IP
 const uint16_t PI_PORT = 4210;      // Pi receives sensor data
 const uint16_t ESP_COMMAND_PORT = 5006; // ESP receives Pi commands
 
+const char* DEVICE_ID_PREFIX = "BALL-";        // + last 3 MAC bytes, e.g. BALL-D748EA
+const unsigned long HEARTBEAT_INTERVAL_MS = 5000;
+const unsigned long HEARTBEAT_JITTER_MS = 500; // Random spread so a fleet's heartbeats don't collide
+
 // ===================== BLE BEACON CONFIG =====================
 // ESP32 advertises as BLE beacon, Raspberry Pi scans and measures RSSI
 const char* BLE_DEVICE_NAME = "ESP32-StressBall";
 // TX Power at 1 meter (calibrate this for accuracy)
 // Measure RSSI at exactly 1 meter and use that value
+// Default only: the per-unit value is firmwareConfig.bleTxPower (CFG:SET:ble_tx_power=n)
 const int8_t BLE_TX_POWER = -59;  // Typical value, adjust after calibration
 
 BLEAdvertising *pAdvertising;
 
+// Advertising scheduler intervals (units of 0.625ms), indexed by BleAdvLevel
+const uint16_t BLE_ADV_INTERVALS[3][2] = {
+  { 0x640, 0x800 },   // SLOW:   1000-1280ms (idle)
+  { 0x140, 0x190 },   // NORMAL: 200-250ms
+  { 0x20,  0x40  },   // FAST:   20-40ms (fresh RSSI for the Pi)
+};
+const unsigned long BLE_FAST_BOOST_MS = 30000;         // BLE:FAST / distress boost length
+const unsigned long BLE_ADV_HEALTH_TIMEOUT_MS = 2000;  // No START_COMPLETE within this -> restart
+
 // Pins
-const int FSR1_PIN = 34;
-const int FSR2_PIN = 35;
+// One ADC1 pin per pressure pad (FSR_CHANNEL_COUNT in detection.h, max 8: GPIO32-39)
+const int FSR_PINS[] = { 34, 35 };
+static_assert(sizeof(FSR_PINS) / sizeof(FSR_PINS[0]) == FSR_CHANNEL_COUNT, "One FSR pin per channel");
+const int FSR_LEGACY_CH2 = FSR_CHANNEL_COUNT > 1 ? 1 : 0;  // Pad reported as fsr2/psi2
 const int FSR_THRESHOLD = 1000;  // Legacy threshold (kept for compatibility)
 
-// ===================== FSR TO PSI CONFIGURATION =====================
-// Circuit: FSR in voltage divider with 10kΩ resistor
-// 10kΩ Resistor Color Code: Brown-Black-Orange-Gold
-const float VCC = 3.3;                    // ESP32 ADC reference voltage
-const float ADC_MAX = 4095.0;             // 12-bit ADC resolution
-const float R_FIXED = 10000.0;            // 10kΩ fixed resistor
-const float FSR_AREA_MM2 = 20.0;          // FSR active area in mm² (typical for FSR402)
-const int FSR_SAMPLES = 5;                // Number of samples for averaging (reduced for BLE performance)
-
-// ===================== CHILD GRIP THRESHOLDS (PSI) =====================
-// Calibrated for autism child tantrum detection
-// Children aged 3-12 have lower grip strength than adults
-// These thresholds detect escalating emotional states
-
-const float PSI_NO_GRIP = 0.1;            // Below this = no contact
-const float PSI_CALM = 0.5;               // Light hold - child is calm
-const float PSI_MODERATE = 4.0;           // Moderate grip - mild anxiety/restlessness
-const float PSI_STRESSED = 8.0;           // Firm grip - stressed/agitated state
-const float PSI_TANTRUM = 16.0;            // Hard grip - tantrum/meltdown detected
-
-// Grip state enumeration
-enum GripState {
-  GRIP_NONE,        // No contact with ball
-  GRIP_CALM,        // Relaxed holding - baseline state
-  GRIP_MODERATE,    // Slight anxiety - early warning
-  GRIP_STRESSED,    // Elevated stress - intervention may help
-  GRIP_TANTRUM      // Tantrum/meltdown - immediate attention needed
+// ===================== FIXED-RATE SAMPLING CONFIG =====================
+// FSR + MPU6050 acquisition runs in its own task, woken by the MPU6050 data-ready INT.
+// Motion thresholds below were tuned at the old ~50Hz loop rate.
+const uint32_t DEFAULT_SAMPLE_RATE_HZ = 50;   // Change at runtime with RATE:n (50/100/200/500)
+const BaseType_t SAMPLING_TASK_CORE = 1;      // App core (WiFi/BLE stacks live on core 0)
+const UBaseType_t SAMPLING_TASK_PRIORITY = 3; // Above the detect task (2) so detection bursts can't delay samples
+const int SAMPLE_RING_SIZE = 128;             // Power of two; >250ms of headroom at 500Hz
+const uint32_t I2C_FAST_MODE_HZ = 400000;     // MPU6050 supports 400kHz fast mode
+const uint32_t MPU_OUTPUT_RATE_HZ = 1000;     // Gyro output rate with the DLPF enabled
+const uint16_t MPU_FIFO_SIZE = 1024;          // Bytes of on-chip FIFO
+const uint8_t MPU_FIFO_FRAME_BYTES = 12;      // Accel XYZ + gyro XYZ per sample
+const uint8_t MPU_FIFO_BURST_FRAMES = 10;     // Frames per I2C read (120 bytes, fits the Wire buffer)
+const uint32_t MPU_FIFO_POLL_MS = 10;         // Drain interval if the INT line is missing
+
+// ===================== POWER MANAGEMENT CONFIG =====================
+const unsigned long IDLE_TIMEOUT_MS = 60000;  // No grip/motion for 1 minute -> idle
+const uint32_t IDLE_SAMPLE_RATE_HZ = 10;      // Wake latency from FSR contact <= 100ms
+const uint32_t IDLE_CPU_FREQ_MHZ = 80;        // Lowest clock that keeps WiFi running
+const uint32_t ACTIVE_CPU_FREQ_MHZ = 240;
+const uint8_t MPU_WAKE_MOTION_THRESHOLD = 20; // 2mg/LSB -> 40mg above the high-passed baseline
+const uint8_t MPU_WAKE_MOTION_DURATION = 1;   // ms above threshold
+const uint8_t MPU_INT_STATUS_MOTION = 0x40;   // MOT_INT bit in INT_STATUS
+const uint8_t MPU_INT_STATUS_FIFO_OFLOW = 0x10;  // FIFO_OFLOW_INT bit in INT_STATUS
+const unsigned long IDLE_LOOP_WAIT_MS = 100;  // The detect task blocks this long between idle passes
+
+// ===================== NETWORK TASK CONFIG =====================
+const BaseType_t NET_TASK_CORE = 0;           // Protocol core, next to the lwIP task
+const UBaseType_t NET_TASK_PRIORITY = 2;      // cmd_rx and net_tx
+const int COMMAND_RING_SIZE = 16;             // Parsed Pi commands waiting for the detect task
+const int NET_TX_RING_SIZE = 8;               // Telemetry, replies and IMU batches waiting for net_tx
+const int NET_TX_URGENT_RING_SIZE = 4;        // Alerts and clock sync requests, always sent first
+const size_t NET_PACKET_MAX = 1460;           // Largest datagram (the old WiFiUDP buffer size)
+const unsigned long NET_TX_BACKOFF_MS = 20;   // net_tx pause after lwIP refuses a packet
+
+// ===================== TASK LAYOUT CONFIG =====================
+// App core (1): sampling (3) and detect (2). Protocol core (0), next to the
+// WiFi/BLE stacks: cmd_rx and net_tx (2), io and log (1), boot tasks (1).
+const BaseType_t DETECT_TASK_CORE = 1;
+const UBaseType_t DETECT_TASK_PRIORITY = 2;   // Below sampling, above the Arduino loopTask it replaces
+const uint32_t DETECT_TASK_STACK = 8192;      // Same as the Arduino loopTask (telemetry Strings, STATUS)
+const unsigned long DETECT_WAIT_MS = 10;      // Longest wait for a sample/command before a timer pass
+const BaseType_t IO_TASK_CORE = 0;
+const UBaseType_t IO_TASK_PRIORITY = 1;
+const unsigned long IO_TASK_PERIOD_MS = 10;   // DFPlayer step / BLE scheduler cadence
+const int AUDIO_REQUEST_RING_SIZE = 16;       // DFPlayer steps posted by the detect task
+
+// ===================== STAGED BOOT CONFIG =====================
+// setup() starts sampling first; DFPlayer and radio bring-up finish in
+// background tasks and report readiness through bootStages[]
+const BaseType_t BOOT_TASK_CORE = 0;                  // Off the acquisition core
+const UBaseType_t BOOT_TASK_PRIORITY = 1;             // Below sampling (3) and the network tasks (2)
+const unsigned long WIFI_AP_START_TIMEOUT_MS = 3000;  // Wait for the AP_START event at most this long
+const unsigned long DFPLAYER_BOOT_TIMEOUT_MS = 5000;  // Module power-up + SD card scan
+const unsigned long DFPLAYER_POLL_TIMEOUT_MS = 200;   // Per status query while it boots
+
+// ===================== ADC DMA CONFIG =====================
+// FSR1/FSR2 are converted continuously by the ADC DMA engine. A background task
+// decimates the stream, so the sampling task only copies the latest value.
+const uint32_t ADC_DMA_SAMPLE_FREQ_HZ = 40000;  // Conversions/s shared by both pins
+const int ADC_OVERSAMPLE = 32;                  // Conversions averaged per output (625Hz per pin)
+const uint32_t ADC_DMA_FRAME_BYTES = 256;       // Bytes per DMA read (2 bytes per conversion)
+
+enum PowerMode : uint8_t {
+  POWER_ACTIVE,
+  POWER_IDLE
+};
+
+enum BleAdvLevel : uint8_t {
+  BLE_ADV_SLOW,
+  BLE_ADV_NORMAL,
+  BLE_ADV_FAST
+};
+
+enum NetMode : uint8_t {
+  NET_MODE_AP,
+  NET_MODE_STA
+};
+
+enum BootStage : uint8_t {
+  BOOT_WIFI,
+  BOOT_BLE,
+  BOOT_DFPLAYER,
+  BOOT_STAGE_COUNT
+};
+
+enum BootState : uint8_t {
+  BOOT_PENDING,
+  BOOT_READY,
+  BOOT_FAILED
+};
+
+enum WakeSource : uint8_t {
+  WAKE_NONE,
+  WAKE_MOTION,    // MPU6050 motion-detect interrupt
+  WAKE_GRIP,      // FSR above the no-grip ADC code
+  WAKE_COMMAND    // Command from the Pi
+};
+
+// ===================== TASK MONITOR =====================
+// Every long-lived task is started through startPinnedTask() and adds the
+// time it spends between blocking waits to its busyUs (single writer, the
+// task itself). TASKS reports stack headroom and CPU share per task.
+enum TaskId : uint8_t {
+  TASK_SAMPLING,
+  TASK_ADC_DMA,
+  TASK_DETECT,
+  TASK_CMD_RX,
+  TASK_NET_TX,
+  TASK_IO,
+  TASK_LOG,
+  TASK_COUNT
+};
+
+const char* const TASK_NAMES[TASK_COUNT] = {
+  "sampling", "adc_dma", "detect", "cmd_rx", "net_tx", "io", "log"
+};
+
+struct TaskStat {
+  TaskHandle_t handle;        // nullptr until started (cmd_rx waits for WiFi)
+  BaseType_t core;
+  UBaseType_t priority;
+  uint32_t stackBytes;
+  volatile uint32_t busyUs;   // Wraps after ~71 minutes; reports use deltas
+  uint32_t reportBusyUs;      // busyUs at the previous TASKS report
+};
+
+TaskStat taskStats[TASK_COUNT] = {};
+
+TaskHandle_t startPinnedTask(TaskId id, TaskFunction_t fn, uint32_t stackBytes, UBaseType_t priority,
+                             BaseType_t core) {
+  TaskStat &t = taskStats[id];
+  t.core = core;
+  t.priority = priority;
+  t.stackBytes = stackBytes;
+  xTaskCreatePinnedToCore(fn, TASK_NAMES[id], stackBytes, nullptr, priority, &t.handle, core);
+  return t.handle;
+}
+
+// Smallest stack high-water mark (bytes) over the started tasks
+uint32_t taskStackMinFree() {
+  uint32_t least = UINT32_MAX;
+  for (int i = 0; i < TASK_COUNT; i++) {
+    if (taskStats[i].handle == nullptr) continue;
+    uint32_t free = uxTaskGetStackHighWaterMark(taskStats[i].handle);
+    if (free < least) least = free;
+  }
+  return least == UINT32_MAX ? 0 : least;
+}
+
+// Wake a task blocked in ulTaskNotifyTake(); a no-op before it has started
+inline void notifyTask(TaskId id) {
+  TaskHandle_t h = taskStats[id].handle;
+  if (h != nullptr) xTaskNotifyGive(h);
+}
+
+inline int64_t taskBusyStart() {
+  return esp_timer_get_time();
+}
+
+inline void taskBusyEnd(TaskId id, int64_t start) {
+  taskStats[id].busyUs += (uint32_t)(esp_timer_get_time() - start);
+}
+
+// ===================== LOGGING =====================
+// LOG_x("TAG", fmt, ...) printf-formats "[TAG] message" into a fixed ring;
+// logDrainTask writes the ring to Serial at low priority, so callers never
+// wait on the 115200-baud UART. Levels above LOG_COMPILE_LEVEL compile out
+// (override with -DLOG_COMPILE_LEVEL=...); logLevel filters at runtime.
+#define LOG_LEVEL_ERROR   0
+#define LOG_LEVEL_WARN    1
+#define LOG_LEVEL_INFO    2   // DEBUG:OFF
+#define LOG_LEVEL_DEBUG   3   // DEBUG:ON - motion/pattern debug (default)
+#define LOG_LEVEL_VERBOSE 4   // DEBUG:VERBOSE - raw values every 2s (very spammy)
+
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_VERBOSE
+#endif
+
+const int LOG_RING_BYTES = 4096;              // Power of two
+const int LOG_LINE_MAX = 256;                 // Longer lines are cut and end in "..."
+const UBaseType_t LOG_TASK_PRIORITY = 1;      // Just above idle
+const BaseType_t LOG_TASK_CORE = 0;
+const uint32_t LOG_DRAIN_IDLE_MS = 10;        // Poll interval while the ring is empty
+
+volatile uint8_t logLevel = LOG_LEVEL_DEBUG;
+
+void logWrite(const char *tag, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+#define LOG_AT(level, tag, ...) do { if ((level) <= logLevel) logWrite(tag, __VA_ARGS__); } while (0)
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(tag, ...) LOG_AT(LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#else
+#define LOG_ERROR(tag, ...) do {} while (0)
+#endif
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(tag, ...) LOG_AT(LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#else
+#define LOG_WARN(tag, ...) do {} while (0)
+#endif
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(tag, ...) LOG_AT(LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#else
+#define LOG_INFO(tag, ...) do {} while (0)
+#endif
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(tag, ...) LOG_AT(LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#else
+#define LOG_DEBUG(tag, ...) do {} while (0)
+#endif
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_VERBOSE
+#define LOG_VERBOSE(tag, ...) LOG_AT(LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+#else
+#define LOG_VERBOSE(tag, ...) do {} while (0)
+#endif
+
+char logRing[LOG_RING_BYTES];
+volatile uint32_t logHead = 0;                // Bytes ever written (producers, under logMux)
+volatile uint32_t logTail = 0;                // Bytes ever drained (logDrainTask only)
+volatile uint32_t logDropped = 0;             // Lines dropped because the ring was full
+volatile uint32_t logTruncated = 0;           // Lines cut at LOG_LINE_MAX (under logMux)
+portMUX_TYPE logMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Safe from any task; formats on the caller's stack, then copies under a spinlock
+void logWrite(const char *tag, const char *fmt, ...) {
+  char line[LOG_LINE_MAX];
+  int n = snprintf(line, sizeof(line), "[%s] ", tag);
+
+  va_list args;
+  va_start(args, fmt);
+  int m = vsnprintf(line + n, sizeof(line) - n, fmt, args);
+  va_end(args);
+  if (m > 0) n += m;
+  bool truncated = n > (int)sizeof(line) - 2;
+  if (truncated) {
+    n = sizeof(line) - 2;
+    memcpy(line + n - 3, "...", 3);  // Mark the cut so a partial line isn't mistaken for a whole one
+  }
+  line[n++] = '\r';
+  line[n++] = '\n';
+
+  portENTER_CRITICAL(&logMux);
+  if (truncated) logTruncated++;
+  uint32_t head = logHead;
+  if (head - logTail + n > (uint32_t)LOG_RING_BYTES) {
+    logDropped++;
+  } else {
+    uint32_t offset = head & (LOG_RING_BYTES - 1);
+    uint32_t first = (uint32_t)n < LOG_RING_BYTES - offset ? n : LOG_RING_BYTES - offset;
+    memcpy(&logRing[offset], line, first);
+    memcpy(logRing, line + first, n - first);
+    logHead = head + n;
+  }
+  portEXIT_CRITICAL(&logMux);
+}
+
+void logDrainTask(void *param) {
+  uint32_t reportedDrops = 0;
+
+  for (;;) {
+    uint32_t tail = logTail;
+    uint32_t head = logHead;
+    __sync_synchronize();  // Read head before the bytes it covers
+
+    if (head == tail) {
+      uint32_t dropped = logDropped;
+      if (dropped != reportedDrops) {
+        Serial.printf("[LOG] %u lines dropped\r\n", (unsigned)(dropped - reportedDrops));
+        reportedDrops = dropped;
+      }
+      vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_IDLE_MS));
+      continue;
+    }
+
+    int64_t busy = taskBusyStart();
+    uint32_t offset = tail & (LOG_RING_BYTES - 1);
+    uint32_t chunk = head - tail;
+    if (chunk > LOG_RING_BYTES - offset) chunk = LOG_RING_BYTES - offset;
+    Serial.write((const uint8_t*)&logRing[offset], chunk);  // Blocks here, not in the caller
+
+    __sync_synchronize();
+    logTail = tail + chunk;
+    taskBusyEnd(TASK_LOG, busy);
+  }
+}
+
+void startLogging() {
+  startPinnedTask(TASK_LOG, logDrainTask, 3072, LOG_TASK_PRIORITY, LOG_TASK_CORE);
+}
+
+// ===================== LOOP PROFILER =====================
+// CCOUNT-based stage timing: per-stage count/min/avg/max plus a log2 latency
+// histogram. Each stage has a single writer (its task), so no locking; PROF
+// reads may tear by one sample, which is fine for field diagnostics.
+const int PROF_HIST_BUCKETS = 16;             // Bucket b counts [2^b, 2^(b+1)) us; last is open-ended
+const uint32_t PROF_LOOP_BUDGET_US = 20000;   // Detect pass longer than one 50Hz sample = overrun
+const unsigned long PROF_HEAP_INTERVAL_MS = 1000;
+
+enum ProfStageId : uint8_t {
+  PROF_LOOP,        // Whole detect pass (excluding the trailing wait)
+  PROF_COMMANDS,    // Dispatching queued Pi commands
+  PROF_PSI,         // PSI average + window stats (per sample)
+  PROF_PATTERN,     // Grip state + 5-grip pattern state machine (per sample)
+  PROF_MOTION,      // Feature extraction + detectors (per sample)
+  PROF_SEND,        // Telemetry build + UDP send
+  PROF_AUDIO,       // DFPlayer queue service
+  PROF_BLE,         // BLE advertising scheduler
+  PROF_MPU_READ,    // MPU6050 FIFO burst read (samplingTask)
+  PROF_CMD_RX,      // Command parse (commandReceiverTask)
+  PROF_STAGE_COUNT
+};
+
+const char* const PROF_STAGE_NAMES[PROF_STAGE_COUNT] = {
+  "loop", "cmd", "psi", "pattern", "motion", "send", "audio", "ble", "mpu", "cmd_rx"
 };
 
-// Consecutive readings required to confirm state change (prevents false triggers)
-const int GRIP_STATE_CONFIRM_COUNT = 5;
+struct ProfStage {
+  uint32_t count;
+  uint32_t minUs;
+  uint32_t maxUs;
+  uint64_t totalUs;
+  uint32_t hist[PROF_HIST_BUCKETS];
+};
+
+ProfStage profStages[PROF_STAGE_COUNT];
+volatile uint32_t profCpuMhz = 240;           // Refreshed when the CPU clock changes
+uint32_t profLoopOverruns = 0;
+uint32_t profHeapFree = 0;
+uint32_t profHeapLargest = 0;                 // Largest allocatable block
+uint32_t profHeapLargestMin = UINT32_MAX;     // Worst fragmentation seen
+
+inline uint32_t profStart() {
+  return ESP.getCycleCount();
+}
+
+// Record one stage duration; returns it in microseconds
+uint32_t profEnd(ProfStageId stage, uint32_t startCycles) {
+  uint32_t us = (ESP.getCycleCount() - startCycles) / profCpuMhz;
+  ProfStage &p = profStages[stage];
+  if (p.count == 0 || us < p.minUs) p.minUs = us;
+  if (us > p.maxUs) p.maxUs = us;
+  p.totalUs += us;
+  p.count++;
+
+  int bucket = (us == 0) ? 0 : 31 - __builtin_clz(us);
+  if (bucket >= PROF_HIST_BUCKETS) bucket = PROF_HIST_BUCKETS - 1;
+  p.hist[bucket]++;
+  return us;
+}
+
+// detectionStageDone hook: detection core stages -> profiler stages
+void profDetectionStage(DetectionStage stage, uint32_t startCycles) {
+  static const ProfStageId map[DETECT_STAGE_COUNT] = { PROF_PSI, PROF_PATTERN, PROF_MOTION };
+  profEnd(map[stage], startCycles);
+}
+
+void profReset() {
+  memset(profStages, 0, sizeof(profStages));
+  profLoopOverruns = 0;
+  profHeapLargestMin = UINT32_MAX;
+}
+
+void profSampleHeap() {
+  profHeapFree = ESP.getFreeHeap();
+  profHeapLargest = ESP.getMaxAllocHeap();
+  if (profHeapLargest < profHeapLargestMin) profHeapLargestMin = profHeapLargest;
+}
 
-// ===================== DEBUG MODE =====================
-// Set to true to see real-time sensor values for calibration
-bool DEBUG_MOTION = true;           // Enable motion debug output
-bool DEBUG_MOTION_VERBOSE = false;  // Show all values every loop (very spammy)
-unsigned long lastMotionDebugTime = 0;
-const unsigned long MOTION_DEBUG_INTERVAL = 500;  // Print debug every 500ms
+uint32_t profAvgUs(ProfStageId stage) {
+  const ProfStage &p = profStages[stage];
+  return p.count ? (uint32_t)(p.totalUs / p.count) : 0;
+}
 
 // DFPlayer pins
 #define PIN_MP3_TX 26
@@ -79,14 +442,75 @@ int currentVolume = 30;
 bool alarmPlaying = false;
 unsigned long alarmStartTime = 0;
 const unsigned long ALARM_DURATION = 5000;  // 5 seconds for alarm
+const unsigned long AUDIO_STOP_SETTLE_MS = 80;   // DFPlayer flush time after stop()
+const unsigned long AUDIO_LATCH_SETTLE_MS = 50;  // DFPlayer needs time to latch a track/volume
+const int AUDIO_QUEUE_SIZE = 8;                  // Pending DFPlayer steps
 
 // MPU pins
 #define I2C_SDA 21
 #define I2C_SCL 22
+#define MPU_INT_PIN 19  // MPU6050 INT (data ready, active high)
 
-// Cooldown
+// Cooldown (default for firmwareConfig.cooldownMs)
 const unsigned long COOLDOWN_MS = 1000;
 
+// ===================== RUNTIME CONFIG STORE =====================
+// Registry values (detection.h plus FIRMWARE_CONFIG_ENTRIES) persist in this
+// NVS namespace, one typed key per entry; missing keys keep their defaults.
+const char* CONFIG_NVS_NAMESPACE = "stressball";
+const unsigned long CAL_REF_DURATION_MS = 2000;  // CAL:REF averaging window
+
+// ===================== TELEMETRY FORMAT =====================
+// Text CSV is the default; the Pi switches to the binary frame with FORMAT:BIN
+const uint8_t TELEMETRY_MAGIC = 0xCB;       // First byte of every binary frame
+const uint8_t TELEMETRY_VERSION = 5;        // Bump when TelemetryFrame layout changes
+
+// TelemetryFrame.flags bits
+const uint8_t TELEMETRY_FLAG_SQUEEZE = 0x01;        // action:Squeeze
+const uint8_t TELEMETRY_FLAG_ALERT_PATTERN = 0x02;  // alert:PATTERN_3GRIP (dominantType valid)
+const uint8_t TELEMETRY_FLAG_ALERT_MOTION = 0x04;   // alert:MOTION_3X (alertMotion valid)
+const uint8_t TELEMETRY_FLAG_PERIODIC = 0x08;       // psiMax/motion are 5s aggregates
+const uint8_t TELEMETRY_FLAG_KEYFRAME = 0x10;       // Reference for change-only reports, Pi answers ACK:<seq>
+
+// ===================== CHANGE-ONLY REPORTING CONFIG =====================
+// With firmwareConfig.reportDelta and binary telemetry, heartbeats are
+// ReportFrames against the last keyframe the Pi acknowledged
+const uint8_t REPORT_MAGIC = 0xCD;                        // First byte of every ReportFrame
+const uint8_t REPORT_VERSION = 1;
+const unsigned long REPORT_KEYFRAME_INTERVAL_MS = 60000;  // Full frame at least this often
+
+// ===================== ALERT DELIVERY CONFIG =====================
+// Distress alerts go through the urgent net_tx ring and are retransmitted with
+// exponential backoff until the Pi answers ACK:<seq> on the command port
+const int ALERT_QUEUE_SIZE = 4;                     // Unacknowledged alerts held for retransmit
+const size_t ALERT_PAYLOAD_MAX = 768;               // Largest alert datagram (text format, 8 pads)
+const unsigned long ALERT_RETRY_INITIAL_MS = 100;   // First ACK timeout, doubled per retransmit
+const unsigned long ALERT_RETRY_MAX_MS = 800;       // Backoff ceiling
+const uint8_t ALERT_MAX_ATTEMPTS = 6;               // Sends per alert; last retransmit at ~2.3s, expires ~3.1s after the first send
+const unsigned long ALERT_LATENCY_BUDGET_MS = 250;  // ACKs slower than this are counted as late
+
+// ===================== CLOCK SYNC CONFIG =====================
+// NTP-style exchange with the Pi: SYNC:REQ:<t1> to the telemetry port, reply
+// SYNC:<t1>,<t2>,<t3> on the command port. Times are µs; the Pi's are Unix time.
+const unsigned long SYNC_INTERVAL_MS = 10000;      // Steady-state request period
+const unsigned long SYNC_BURST_GAP_MS = 250;       // Spacing while (re)acquiring
+const uint8_t SYNC_BURST_COUNT = 4;                // Requests per burst
+const unsigned long SYNC_REPLY_TIMEOUT_MS = 1000;  // Unanswered request counts as lost
+const uint32_t SYNC_RTT_MAX_US = 100000;           // Replies slower than this are rejected
+const int SYNC_FILTER_SIZE = 8;                    // Min-RTT clock filter window
+const int64_t SYNC_DRIFT_MIN_SPAN_US = 30000000;   // Reference points this far apart update drift
+const float SYNC_DRIFT_MAX_PPM = 200.0f;           // Crystal tolerance; larger slopes are noise
+const unsigned long SYNC_STALE_MS = 60000;         // No good sample for this long -> "stale"
+
+// ===================== RAW IMU STREAM CONFIG =====================
+// STREAM:IMU:<hz>HZ ships every raw MPU6050 sample in batched datagrams
+const uint8_t IMU_STREAM_MAGIC = 0xCC;            // First byte of every IMU batch datagram
+const uint8_t IMU_STREAM_VERSION = 2;
+const int IMU_STREAM_BATCH_MAX = 64;              // Samples per datagram (924 bytes, below one MTU)
+const unsigned long IMU_STREAM_FLUSH_MS = 250;    // Send a partial batch after this long
+const unsigned long IMU_STREAM_MIN_GAP_MS = 20;   // Minimum spacing between batch datagrams
+const unsigned long IMU_STREAM_MAX_GAP_MS = 400;  // Back-off ceiling while lwIP is congested
+
 // ===================== OBJECTS =====================
 HardwareSerial mp3Serial(1);
 DFRobotDFPlayerMini dfplayer;
@@ -95,49 +519,231 @@ WiFiUDP udp;
 
 // ===================== STATE =====================
 unsigned long lastTriggerTime = 0;
-unsigned long lastUDPSend = 0;
 int musicChoice = 1;
 bool isPlaying = false;
+bool binaryTelemetry = false;  // FORMAT:BIN / FORMAT:TEXT
+uint16_t telemetrySeq = 0;     // Incremented per telemetry packet (binary frame or text line)
+
+// Fleet identity (see NETWORK IDENTITY)
+uint32_t deviceIdNum = 0;           // Last 3 MAC bytes
+char deviceId[16] = "";             // DEVICE_ID_PREFIX + 6 hex digits
+char bleDeviceName[32] = "";        // BLE_DEVICE_NAME + "-" + 6 hex digits
+NetMode netMode = NET_MODE_AP;      // Latched from firmwareConfig.netMode at boot
+volatile uint32_t netHubAddr = 0;   // STA: sender of the last Pi command (network order), 0 = unknown
+
+// Power management (see POWER MANAGEMENT)
+volatile PowerMode powerMode = POWER_ACTIVE;
+volatile uint8_t powerWakeSource = WAKE_NONE;  // Set by samplingTask while idle
+TaskHandle_t detectTaskHandle = nullptr;       // Notified by samplingTask/cmd_rx with new work
+unsigned long lastActivityMs = 0;
+unsigned long powerIdleSinceMs = 0;
+uint32_t powerRestoreRateHz = DEFAULT_SAMPLE_RATE_HZ;
+
+// BLE advertising scheduler (see BLE ADVERTISING SCHEDULER)
+volatile bool bleAdvRunning = false;        // From GAP START/STOP_COMPLETE events
+volatile uint32_t bleAdvStartFailures = 0;
+BleAdvLevel bleAdvLevel = BLE_ADV_NORMAL;   // Level currently programmed
+unsigned long bleAdvRequestMs = 0;          // Last start() call
+unsigned long bleFastUntilMs = 0;           // 0 = no FAST boost pending (io task only)
+volatile unsigned long bleBoostRequestUntilMs = 0;  // Latest bleAdvBoost() request
+volatile uint32_t bleBoostRequestSeq = 0;
+uint32_t bleAdvRestarts = 0;
+
+// Staged boot (see STAGED BOOT); written once by the boot tasks, polled by the detect and io tasks
+struct BootStageStatus {
+  volatile BootState state;
+  volatile uint32_t readyMs;                // millis() when it finished (ready or failed)
+};
+BootStageStatus bootStages[BOOT_STAGE_COUNT] = {};
+volatile uint32_t bootFirstSampleMs = 0;    // millis() of the first acquired sample
+uint32_t bootSetupMs = 0;                   // millis() when setup() returned
 
-// Consecutive motion tracking
-String lastMotionType = "";
-int consecutiveMotionCount = 0;
-const int CONSECUTIVE_MOTION_THRESHOLD = 5;
+inline bool bootReady(BootStage stage) {
+  return bootStages[stage].state == BOOT_READY;
+}
 
 // Motion aggregation for periodic updates (track most frequent motion in 5s window)
-const int MAX_MOTION_HISTORY = 50;  // Store up to 50 motion detections per 5s period
-String motionHistory[MAX_MOTION_HISTORY];
+const int MAX_MOTION_HISTORY = 50;  // Keep the last 50 motion detections per 5s period
+MotionType motionHistory[MAX_MOTION_HISTORY];
+int motionHistoryHead = 0;          // Next slot to write
 int motionHistoryCount = 0;
+uint16_t motionCounts[MOTION_TYPE_COUNT];  // Histogram of motionHistory
+
+// PSI aggregation for periodic updates: 5s sliding window of 500ms buckets.
+// Each bucket keeps exact integer sums of centi-PSI so every sample is O(1),
+// float-free, and the window never truncates, regardless of sample rate.
+const int PSI_BUCKET_MS = 500;
+const int PSI_BUCKET_COUNT = 10;  // 10 x 500ms = 5s window
+struct PsiBucket {
+  uint32_t count;
+  uint32_t sum;                   // Σ centi-PSI
+  uint64_t sumSq;                 // Σ centi-PSI²
+  uint16_t minCenti;
+  uint16_t maxCenti;
+  unsigned long slotStartMs;      // Start of the 500ms slot this bucket covers
+};
+PsiBucket psiBuckets[PSI_BUCKET_COUNT];
+
+struct PsiStats {
+  uint32_t count;
+  float mean;
+  float stddev;
+  float minPsi;
+  float maxPsi;
+};
+
+// ===================== LOCK-FREE RING BUFFER =====================
+// Bounded single-producer/single-consumer queue. push() is only called from one
+// task and pop() from one other; head/tail are published with full barriers so
+// producer and consumer may run on different cores.
+template <typename T, uint32_t N>
+struct SpscRing {
+  static_assert((N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+  T items[N];
+  volatile uint32_t head = 0;     // Only written by the producer
+  volatile uint32_t tail = 0;     // Only written by the consumer
+  volatile uint32_t drops = 0;    // Items rejected because the ring was full
+
+  bool push(const T &item) {
+    uint32_t h = head;
+    if (h - tail >= N) {
+      drops++;
+      return false;
+    }
+    items[h % N] = item;
+    __sync_synchronize();  // Publish the item before moving head
+    head = h + 1;
+    return true;
+  }
+
+  bool pop(T &item) {
+    uint32_t t = tail;
+    if (t == head) return false;
+    item = items[t % N];
+    __sync_synchronize();  // Finish reading before releasing the slot
+    tail = t + 1;
+    return true;
+  }
+
+  uint32_t count() const { return head - tail; }
+};
+
+// ===================== PI COMMAND STATE =====================
+enum PiCommandId : uint8_t {
+  CMD_PLAY_STOP,
+  CMD_PLAY,
+  CMD_VOLUME,
+  CMD_RATE,
+  CMD_CALIBRATE_REF,
+  CMD_CALIBRATE,
+  CMD_CONFIG_GET_ALL,
+  CMD_CONFIG_GET,
+  CMD_CONFIG_SET,
+  CMD_CONFIG_RESET,
+  CMD_ALERT_ACK,
+  CMD_FORMAT_BIN,
+  CMD_FORMAT_TEXT,
+  CMD_STREAM_IMU,
+  CMD_STREAM_OFF,
+  CMD_BLE_FAST,
+  CMD_DEBUG_ON,
+  CMD_DEBUG_OFF,
+  CMD_DEBUG_VERBOSE,
+  CMD_STATUS,
+  CMD_PROF,
+  CMD_PROF_RESET,
+  CMD_SYNC,
+  CMD_REPORT_KEY,
+  CMD_TASKS,
+  CMD_COUNT,
+  CMD_UNKNOWN = CMD_COUNT
+};
+
+enum PiCommandArgs : uint8_t {
+  CMD_ARGS_NONE,      // Exact keyword match
+  CMD_ARGS_INT,       // Keyword prefix followed by an integer
+  CMD_ARGS_FLOAT3,    // Keyword prefix followed by three comma-separated floats
+  CMD_ARGS_TEXT       // Keyword prefix followed by free text (argText)
+};
+
+// Parsed command, produced by commandReceiverTask
+struct PiCommand {
+  PiCommandId id;
+  int32_t intArg;
+  float floatArgs[3];
+  char argText[56];   // Text after the keyword (CMD_ARGS_TEXT)
+  char text[24];      // Normalized command text (for logging)
+  int64_t rxUs;       // esp_timer_get_time() when the datagram arrived
+};
 
-// PSI aggregation for periodic updates (track average PSI over 5s window)
-const int MAX_PSI_HISTORY = 250;  // Store up to 250 samples (5s at 20ms loop = ~250 samples)
-float psiHistory[MAX_PSI_HISTORY];
-int psiHistoryCount = 0;
-
-// Grip state tracking
-GripState currentGripState = GRIP_NONE;
-GripState lastDetectedGripState = GRIP_NONE;
-int gripStateConfirmCounter = 0;
-float lastPSI1 = 0.0;
-float lastPSI2 = 0.0;
-
-// ===================== PATTERN DETECTION STATE =====================
-const unsigned long GAP_MAX_MS = 1000;      // Max gap allowed between grips (1000ms)
-const int GRIP_PATTERN_COUNT = 5;           // Number of grips to trigger
-int sequenceCount = 0;                      // Current grip number (0-based or 1-based tracking)
-unsigned long lastReleaseTime = 0;          // Time when last grip was released
-bool isGripping = false;                    // Are we currently in a grip?
-GripState currentMaxGrip = GRIP_NONE;       // Max grip level reached during current grip
-GripState sequenceGrips[5];                 // Store grip types for the pattern
-GripState dominantGripType = GRIP_STRESSED; // The dominant type across all 5 grips
+struct PiCommandSpec {
+  const char *keyword;
+  PiCommandArgs args;
+  const char *usage;
+  void (*handler)(const PiCommand &cmd);
+};
 
+SpscRing<PiCommand, COMMAND_RING_SIZE> commandRing;
+
+// ===================== SAMPLING STATE =====================
+// Sampling task -> detect task; drops = samples lost because detection fell behind
+SpscRing<SensorSample, SAMPLE_RING_SIZE> sampleRing;
+
+TaskHandle_t samplingTaskHandle = nullptr;
+uint32_t samplingRateHz = DEFAULT_SAMPLE_RATE_HZ;      // Requested rate (detect task side)
+volatile uint32_t samplingPendingRateHz = 0;           // Set by setSamplingRate(), applied by the task
+volatile uint32_t samplingMissedSamples = 0;           // Sensor samples lost to FIFO overflow
+volatile uint32_t mpuFifoOverflows = 0;
+// Owned by the sampling task after startSampling()
+uint32_t samplingActiveRateHz = DEFAULT_SAMPLE_RATE_HZ;
+uint32_t samplingIndex = 0;                            // Sensor samples since the last (re)configure
+unsigned long samplingStartMs = 0;                     // millis() of sample index 0
+
+// Acquisition time of the sample being processed, used by detectors instead of millis()
+unsigned long sampleNowMs = 0;
+
+// Latest processed sample (raw values for telemetry/debug)
+SensorSample latestSample = {};
+
+// ADC DMA double buffer: adcDmaTask writes the back buffer, then flips the front
+// index and bumps fsrFilteredSeq. A reader that sees the seq change during its
+// copy retries, since two flips may have reused the buffer it was reading.
+uint16_t fsrFiltered[2][FSR_CHANNEL_COUNT];  // [buffer][pad]
+volatile uint8_t fsrFilteredFront = 0;
+volatile uint32_t fsrFilteredSeq = 0;       // Flips so far
+bool adcDmaActive = false;                  // false = fall back to analogRead()
+volatile uint32_t adcDmaOverruns = 0;       // DMA pool overflowed before we read it
 
 // ===================== BLE BEACON SETUP =====================
 // Simple BLE beacon for Pi proximity detection
 // The ESP32 MAC address is: EC:E3:34:D7:48:EA (use this in Pi scanner)
 
+// Runs in the Bluedroid task: only record what the controller reports
+void bleGapHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
+  switch (event) {
+    case ESP_GAP_BLE_ADV_START_COMPLETE_EVT:
+      bleAdvRunning = (param->adv_start_cmpl.status == ESP_BT_STATUS_SUCCESS);
+      if (!bleAdvRunning) bleAdvStartFailures++;
+      break;
+    case ESP_GAP_BLE_ADV_STOP_COMPLETE_EVT:
+      bleAdvRunning = false;
+      break;
+    default:
+      break;
+  }
+}
+
+const char* bleAdvLevelToString(BleAdvLevel level) {
+  switch (level) {
+    case BLE_ADV_SLOW: return "slow";
+    case BLE_ADV_FAST: return "fast";
+    default:           return "normal";
+  }
+}
+
 void setupBLE() {
-  Serial.println("[BLE] Initializing BLE beacon...");
+  LOG_INFO("BLE", "Initializing BLE beacon...");
 
   // Enable BT stack and configure WiFi/BLE coexistence
   // ESP32 shares 2.4GHz radio between WiFi and BLE - must configure coexistence
@@ -146,15 +752,16 @@ void setupBLE() {
   // Set coexistence preference (use BT constant for better BLE performance)
   #ifdef ESP_COEX_PREFER_BT
     esp_coex_preference_set(ESP_COEX_PREFER_BT);
-    Serial.println("[BLE] Coexistence mode: PREFER_BT");
+    LOG_INFO("BLE", "Coexistence mode: PREFER_BT");
   #else
     // Fallback: Disable WiFi power saving for better BLE reliability
     esp_wifi_set_ps(WIFI_PS_NONE);
-    Serial.println("[BLE] WiFi power saving disabled for BLE reliability");
+    LOG_INFO("BLE", "WiFi power saving disabled for BLE reliability");
   #endif
 
   // Initialize BLE with device name
-  BLEDevice::init("ESP32-StressBall");
+  BLEDevice::init(bleDeviceName);
+  BLEDevice::setCustomGapHandler(bleGapHandler);
 
   // Set TX power to maximum for better range
   esp_ble_tx_power_set(ESP_BLE_PWR_TYPE_DEFAULT, ESP_PWR_LVL_P9);
@@ -166,384 +773,519 @@ void setupBLE() {
   // Configure advertisement data
   BLEAdvertisementData advData;
   advData.setFlags(ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT);
-  advData.setName("ESP32-StressBall");
+  advData.setName(bleDeviceName);
 
   pAdvertising->setAdvertisementData(advData);
 
-  // Set fast advertising interval for better detection
-  pAdvertising->setMinInterval(0x20);   // 20ms
-  pAdvertising->setMaxInterval(0x40);   // 40ms
+  // Interval comes from the scheduler level (NORMAL at boot)
+  pAdvertising->setMinInterval(BLE_ADV_INTERVALS[bleAdvLevel][0]);
+  pAdvertising->setMaxInterval(BLE_ADV_INTERVALS[bleAdvLevel][1]);
 
   // Start advertising
   pAdvertising->start();
+  bleAdvRequestMs = millis();
 
-  Serial.println("[BLE] Beacon started: ESP32-StressBall");
-  Serial.println("[BLE] TX Power: MAX (+9 dBm), Interval: 20-40ms");
+  LOG_INFO("BLE", "Beacon started: %s", bleDeviceName);
+  LOG_INFO("BLE", "TX Power: MAX (+9 dBm), Advertising: %s", bleAdvLevelToString(bleAdvLevel));
 }
 
-// ===================== HELPERS =====================
-long getMagnitude(int16_t ax, int16_t ay, int16_t az) {
-  long la = ax, lb = ay, lc = az;
-  return sqrt((double)(la*la + lb*lb + lc*lc));
-}
-
-// ===================== FSR TO PSI CONVERSION =====================
-// Converts raw ADC reading to PSI (pounds per square inch)
-// Uses voltage divider formula and FSR characteristic curve
+// ===================== FSR CALIBRATION =====================
+// Conversion itself lives in detection.cpp (computePSI/psiTable/adcToPSI)
 
-float adcToPSI(int adcValue) {
-  // Prevent division by zero and filter noise
-  if (adcValue < 50) return 0.0;
+// Change curve parameters and rebuild the lookup table
+void setFsrCalibration(float rFixed, float areaMm2, float exponent) {
+  fsrCalibration.rFixed = rFixed;
+  fsrCalibration.areaMm2 = areaMm2;
+  fsrCalibration.exponent = exponent;
+  rebuildPSITable();
 
-  // Step 1: Calculate voltage from ADC reading
-  float voltage = adcValue * (VCC / ADC_MAX);
-
-  // Step 2: Calculate FSR resistance using voltage divider formula
-  // Vout = Vcc * R_fixed / (R_fixed + R_fsr)
-  // Solving for R_fsr: R_fsr = R_fixed * (Vcc - Vout) / Vout
-  float fsrResistance = R_FIXED * (VCC - voltage) / voltage;
+  LOG_INFO("FSR", "Calibration updated: R_FIXED=%.2f AREA=%.2f EXP=%.3f", rFixed, areaMm2, exponent);
+}
 
-  // Step 3: Convert resistance to force (Newtons)
-  // Based on FSR 402 characteristic curve: R ≈ 1/F^1.1 (approximately)
-  // Force (N) ≈ (1,000,000 / R)^(1/1.1)
-  float forceN = 0.0;
-  if (fsrResistance > 0 && fsrResistance < 1000000) {
-    forceN = pow(1000000.0 / fsrResistance, 0.909);  // 1/1.1 ≈ 0.909
-  }
+// ===================== RUNTIME CONFIG =====================
+// Firmware-side tunables; detection tunables live in detectionConfig/fsrCalibration
+struct FirmwareConfig {
+  uint32_t cooldownMs = COOLDOWN_MS;   // Min gap between distress sends
+  int32_t bleTxPower = BLE_TX_POWER;   // Measured RSSI at 1m, reported for the Pi's distance model
+  uint32_t netMode = NET_MODE_AP;      // NetMode, takes effect at the next boot
+  uint32_t reportDelta = 1;            // 1 = change-only heartbeats (binary format), 0 = full frames
+};
+FirmwareConfig firmwareConfig;
 
-  // Step 4: Convert force to PSI
-  // PSI = Force(N) / Area(m²) / 6894.76 (Pa per PSI)
-  // Area in m² = Area_mm² * 1e-6
-  float areaM2 = FSR_AREA_MM2 * 1e-6;
-  float psi = forceN / (areaM2 * 6894.76);
+const ConfigEntry FIRMWARE_CONFIG_ENTRIES[] = {
+  { "cooldown_ms",  CFG_UINT, &firmwareConfig.cooldownMs, 0,    60000, false },
+  { "ble_tx_power", CFG_INT,  &firmwareConfig.bleTxPower, -127, 20,    false },
+  { "net_mode",     CFG_UINT, &firmwareConfig.netMode,    0,    1,     false },
+  { "report_delta", CFG_UINT, &firmwareConfig.reportDelta, 0,   1,     false },
+};
+const int FIRMWARE_CONFIG_ENTRY_COUNT = sizeof(FIRMWARE_CONFIG_ENTRIES) / sizeof(FIRMWARE_CONFIG_ENTRIES[0]);
 
-  // Clamp to reasonable range for child grip (0-30 PSI max)
-  if (psi > 30.0) psi = 30.0;
+Preferences configStore;
+bool configStoreOpen = false;
 
-  return psi;
+// Registry lookup across both tables by index (detection entries first)
+int configEntryCount() {
+  return DETECTION_CONFIG_ENTRY_COUNT + FIRMWARE_CONFIG_ENTRY_COUNT;
 }
 
-// Get averaged PSI reading for reliability (reduces noise)
-float getAveragedPSI(int pin) {
-  float total = 0.0;
-  for (int i = 0; i < FSR_SAMPLES; i++) {
-    total += adcToPSI(analogRead(pin));
-    delayMicroseconds(500);  // 0.5ms delay (reduced from 2ms for BLE performance)
-  }
-  return total / FSR_SAMPLES;
+const ConfigEntry &configEntryAt(int i) {
+  return i < DETECTION_CONFIG_ENTRY_COUNT ? DETECTION_CONFIG_ENTRIES[i]
+                                          : FIRMWARE_CONFIG_ENTRIES[i - DETECTION_CONFIG_ENTRY_COUNT];
 }
 
-// ===================== GRIP STATE DETECTION =====================
-// Determines child's emotional state based on grip pressure
+const ConfigEntry* findConfig(const char *key) {
+  const ConfigEntry *e = findConfigEntry(DETECTION_CONFIG_ENTRIES, DETECTION_CONFIG_ENTRY_COUNT, key);
+  return e ? e : findConfigEntry(FIRMWARE_CONFIG_ENTRIES, FIRMWARE_CONFIG_ENTRY_COUNT, key);
+}
 
-GripState detectGripState(float psi) {
-  if (psi < PSI_NO_GRIP) {
-    return GRIP_NONE;
-  } else if (psi < PSI_CALM) {
-    return GRIP_CALM;
-  } else if (psi < PSI_MODERATE) {
-    return GRIP_MODERATE;
-  } else if (psi < PSI_STRESSED) {
-    return GRIP_STRESSED;
-  } else {
-    return GRIP_TANTRUM;
+// Write one entry's current value to NVS
+bool saveConfigEntry(const ConfigEntry &e) {
+  if (!configStoreOpen) return false;
+  size_t written = 0;
+  switch (e.type) {
+    case CFG_INT:   written = configStore.putInt(e.key, *(const int32_t *)e.value); break;
+    case CFG_UINT:  written = configStore.putUInt(e.key, *(const uint32_t *)e.value); break;
+    case CFG_FLOAT: written = configStore.putFloat(e.key, *(const float *)e.value); break;
   }
+  if (written == 0) LOG_WARN("CFG", "NVS write failed for %s", e.key);
+  return written > 0;
 }
 
-// Convert grip state to readable string
-String gripStateToString(GripState state) {
-  switch (state) {
-    case GRIP_NONE:     return "None";
-    case GRIP_CALM:     return "Calm";
-    case GRIP_MODERATE: return "Moderate";
-    case GRIP_STRESSED: return "Stressed";
-    case GRIP_TANTRUM:  return "Tantrum";
-    default:            return "Unknown";
+void saveFsrCalibration() {
+  for (int i = 0; i < DETECTION_CONFIG_ENTRY_COUNT; i++) {
+    if (DETECTION_CONFIG_ENTRIES[i].fsrCurve) saveConfigEntry(DETECTION_CONFIG_ENTRIES[i]);
   }
 }
 
-// Update grip state with confirmation (prevents false triggers)
-// Returns true if state changed and was confirmed
-bool updateGripState(float psi1, float psi2) {
-  // Use the higher PSI reading (dominant hand or stronger grip)
-  float maxPSI = max(psi1, psi2);
-
-  GripState detected = detectGripState(maxPSI);
-
-  if (detected == lastDetectedGripState) {
-    gripStateConfirmCounter++;
-  } else {
-    gripStateConfirmCounter = 1;
-    lastDetectedGripState = detected;
+// Boot: open the namespace and overlay stored values on the defaults.
+// Out-of-range values (older firmware, corrupted flash) are ignored.
+// The caller rebuilds psiTable afterwards.
+void loadConfig() {
+  configStoreOpen = configStore.begin(CONFIG_NVS_NAMESPACE, false);
+  if (!configStoreOpen) {
+    LOG_ERROR("CFG", "NVS namespace %s unavailable, using defaults", CONFIG_NVS_NAMESPACE);
+    return;
   }
 
-  // Confirm state change after consistent readings
-  if (gripStateConfirmCounter >= GRIP_STATE_CONFIRM_COUNT) {
-    if (detected != currentGripState) {
-      GripState previousState = currentGripState;
-      currentGripState = detected;
-
-      Serial.print("[GRIP] State changed: ");
-      Serial.print(gripStateToString(previousState));
-      Serial.print(" -> ");
-      Serial.println(gripStateToString(currentGripState));
-
-      return true;  // State changed
+  int loaded = 0;
+  for (int i = 0; i < configEntryCount(); i++) {
+    const ConfigEntry &e = configEntryAt(i);
+    if (!configStore.isKey(e.key)) continue;
+
+    int32_t intValue = 0;
+    uint32_t uintValue = 0;
+    float v = 0;
+    switch (e.type) {
+      case CFG_INT:   v = intValue = configStore.getInt(e.key); break;
+      case CFG_UINT:  v = uintValue = configStore.getUInt(e.key); break;
+      case CFG_FLOAT: v = configStore.getFloat(e.key); break;
+    }
+    if (!(v >= e.minValue && v <= e.maxValue)) {
+      LOG_WARN("CFG", "Ignoring stored %s (out of range)", e.key);
+      continue;
     }
+    switch (e.type) {
+      case CFG_INT:   *(int32_t *)e.value = intValue; break;
+      case CFG_UINT:  *(uint32_t *)e.value = uintValue; break;
+      case CFG_FLOAT: *(float *)e.value = v; break;
+    }
+    loaded++;
   }
+  LOG_INFO("CFG", "Loaded %d of %d settings from NVS", loaded, configEntryCount());
 
-  return false;  // No change
+  // Saved by firmware that didn't check ordering; the FSR calibration is kept
+  if (const char *orderError = detectionConfigOrderError()) {
+    LOG_ERROR("CFG", "Stored thresholds break %s, using default detection settings", orderError);
+    detectionConfig = DetectionConfig();
+  }
 }
 
-// Check if child is in distress (tantrum or stressed state)
-bool isChildInDistress() {
-  return (currentGripState == GRIP_TANTRUM || currentGripState == GRIP_STRESSED);
+// Erase the namespace and return every entry to its compiled-in default
+void resetConfig() {
+  if (configStoreOpen) configStore.clear();
+  firmwareConfig = FirmwareConfig();
+  resetDetectionConfig();
 }
 
-// Determine dominant grip type from the 3-grip sequence
-// Returns GRIP_TANTRUM if 2+ tantrum grips, otherwise GRIP_STRESSED
-GripState getDominantGripType() {
-  int tantrumCount = 0;
-  int stressedCount = 0;
-
-  for (int i = 0; i < GRIP_PATTERN_COUNT; i++) {
-    if (sequenceGrips[i] == GRIP_TANTRUM) {
-      tantrumCount++;
-    } else if (sequenceGrips[i] == GRIP_STRESSED) {
-      stressedCount++;
-    }
-  }
-
-  // Tantrum is dominant if 2 or more tantrum grips
-  if (tantrumCount >= 2) {
-    return GRIP_TANTRUM;
-  }
-  return GRIP_STRESSED;
-}
+// ===================== PER-UNIT FSR CALIBRATION =====================
+// CAL:REF:<psi> - hold a known pressure on one pad; the strongest pad's raw
+// code is averaged for CAL_REF_DURATION_MS and areaMm2 is refitted so that
+// code reads <psi> with this unit's resistor and curve. The result persists.
+struct CalRefState {
+  bool active;
+  float refPsi;
+  unsigned long endMs;
+  uint32_t sum;
+  uint32_t count;
+};
 
-// Get most frequent motion from history (excludes "None" unless it's the only motion)
-String getMostFrequentMotion() {
-  if (motionHistoryCount == 0) {
-    return "None";
-  }
-
-  // Count frequency of each motion type
-  struct MotionCount {
-    String type;
-    int count;
-  };
-
-  MotionCount counts[10];  // Max 10 different motion types
-  int uniqueCount = 0;
-
-  for (int i = 0; i < motionHistoryCount; i++) {
-    String motion = motionHistory[i];
-
-    // Find if this motion type already counted
-    bool found = false;
-    for (int j = 0; j < uniqueCount; j++) {
-      if (counts[j].type == motion) {
-        counts[j].count++;
-        found = true;
-        break;
+CalRefState calRef = {};
+
+// ===================== ADC DMA SAMPLING =====================
+// Continuous ADC1 conversions of every FSR pin into the DMA pool. adcDmaTask
+// averages ADC_OVERSAMPLE conversions per pin and publishes the whole array
+// through the fsrFiltered double buffer, replacing blocking analogRead() bursts.
+// The scan pattern converts all pads in hardware, so adding pads costs no CPU
+// in the sampling task; the per-pin rate is ADC_DMA_SAMPLE_FREQ_HZ / pads.
+
+void adcDmaTask(void *param) {
+  const uint8_t allPending = (1 << FSR_CHANNEL_COUNT) - 1;
+  uint8_t frame[ADC_DMA_FRAME_BYTES];
+  int8_t padOfChannel[8];                  // ADC1 channel -> pad index (-1 = not ours)
+  uint32_t sum[FSR_CHANNEL_COUNT] = {};
+  int count[FSR_CHANNEL_COUNT] = {};
+  uint16_t pending[FSR_CHANNEL_COUNT] = {};
+  uint8_t pendingMask = 0;
+
+  memset(padOfChannel, -1, sizeof(padOfChannel));
+  for (int c = 0; c < FSR_CHANNEL_COUNT; c++) padOfChannel[digitalPinToAnalogChannel(FSR_PINS[c]) & 7] = c;
+
+  for (;;) {
+    uint32_t length = 0;
+    esp_err_t err = adc_digi_read_bytes(frame, sizeof(frame), &length, 100);
+    if (err == ESP_ERR_INVALID_STATE) adcDmaOverruns++;  // Data was still returned
+    else if (err != ESP_OK) continue;
+
+    int64_t busy = taskBusyStart();
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+      adc_digi_output_data_t *d = (adc_digi_output_data_t*)&frame[i];
+      int idx = padOfChannel[d->type1.channel & 7];
+      if (idx < 0) continue;
+
+      sum[idx] += d->type1.data;
+      if (++count[idx] < ADC_OVERSAMPLE) continue;
+
+      pending[idx] = sum[idx] / ADC_OVERSAMPLE;
+      pendingMask |= (1 << idx);
+      sum[idx] = 0;
+      count[idx] = 0;
+
+      // Publish once every pin has a fresh value
+      if (pendingMask == allPending) {
+        uint8_t back = fsrFilteredFront ^ 1;
+        memcpy(fsrFiltered[back], pending, sizeof(pending));
+        __sync_synchronize();
+        fsrFilteredFront = back;
+        fsrFilteredSeq = fsrFilteredSeq + 1;
+        pendingMask = 0;
       }
     }
-
-    // New motion type
-    if (!found && uniqueCount < 10) {
-      counts[uniqueCount].type = motion;
-      counts[uniqueCount].count = 1;
-      uniqueCount++;
-    }
+    taskBusyEnd(TASK_ADC_DMA, busy);
   }
+}
 
-  // Find most frequent (excluding "None" if other motions exist)
-  String mostFrequent = "None";
-  int maxCount = 0;
-  bool hasNonNone = false;
-
-  for (int i = 0; i < uniqueCount; i++) {
-    if (counts[i].type != "None") {
-      hasNonNone = true;
-      if (counts[i].count > maxCount) {
-        maxCount = counts[i].count;
-        mostFrequent = counts[i].type;
-      }
-    }
+bool startAdcDma() {
+  adc_digi_init_config_t initConfig = {};
+  initConfig.max_store_buf_size = ADC_DMA_FRAME_BYTES * 4;
+  initConfig.conv_num_each_intr = ADC_DMA_FRAME_BYTES;
+  initConfig.adc1_chan_mask = 0;
+  for (int c = 0; c < FSR_CHANNEL_COUNT; c++) initConfig.adc1_chan_mask |= 1 << digitalPinToAnalogChannel(FSR_PINS[c]);
+  initConfig.adc2_chan_mask = 0;
+  if (adc_digi_initialize(&initConfig) != ESP_OK) return false;
+
+  adc_digi_pattern_config_t pattern[FSR_CHANNEL_COUNT] = {};
+  for (int i = 0; i < FSR_CHANNEL_COUNT; i++) {
+    pattern[i].atten = ADC_ATTEN_DB_11;  // Same 0-3.3V range as analogSetPinAttenuation
+    pattern[i].channel = digitalPinToAnalogChannel(FSR_PINS[i]);
+    pattern[i].unit = 0;                 // ADC1
+    pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
   }
 
-  // If only "None" motions, return "None"
-  if (!hasNonNone) {
-    return "None";
+  adc_digi_configuration_t config = {};
+  config.conv_limit_en = true;
+  config.conv_limit_num = 250;
+  config.pattern_num = FSR_CHANNEL_COUNT;
+  config.adc_pattern = pattern;
+  config.sample_freq_hz = ADC_DMA_SAMPLE_FREQ_HZ;
+  config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+  if (adc_digi_controller_configure(&config) != ESP_OK || adc_digi_start() != ESP_OK) {
+    adc_digi_deinitialize();
+    return false;
   }
 
-  return mostFrequent;
+  startPinnedTask(TASK_ADC_DMA, adcDmaTask, 4096, SAMPLING_TASK_PRIORITY, SAMPLING_TASK_CORE);
+  return true;
 }
 
-// Get average PSI from history (for periodic updates)
-float getAveragePSI() {
-  if (psiHistoryCount == 0) {
-    return 0.0;
-  }
-
-  float total = 0.0;
-  for (int i = 0; i < psiHistoryCount; i++) {
-    total += psiHistory[i];
+// Latest filtered FSR readings (ADC codes, FSR_PINS order) - free when DMA is running
+void readFilteredFSR(uint16_t *fsr) {
+  if (!adcDmaActive) {
+    for (int c = 0; c < FSR_CHANNEL_COUNT; c++) fsr[c] = analogRead(FSR_PINS[c]);
+    return;
   }
+  uint32_t seq;
+  do {
+    seq = fsrFilteredSeq;
+    __sync_synchronize();  // Read seq before the front index and data
+    memcpy(fsr, fsrFiltered[fsrFilteredFront], sizeof(fsrFiltered[0]));
+    __sync_synchronize();  // Finish the copy before re-checking seq
+  } while (seq != fsrFilteredSeq);
+}
 
-  return total / psiHistoryCount;
+// ===================== FIXED-RATE SAMPLING TASK =====================
+// MPU6050 data-ready INT -> task notification -> burst-drain the sensor FIFO
+// -> ring buffer. The MPU6050 sample-rate divider is the timebase, so motion
+// samples queue up on-chip instead of being lost while the task is busy.
+// The detect task drains the ring, so every detector sees evenly spaced samples even
+// while a detect pass is busy with commands or telemetry.
+
+void IRAM_ATTR onMpuDataReady() {
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(samplingTaskHandle, &woken);
+  if (woken) portYIELD_FROM_ISR();
 }
 
-// ===================== MOTION DETECTION =====================
-// Thresholds increased for ball toy - needs significant motion to trigger
-bool detectSpinning(int16_t gx, int16_t gy, int16_t gz) {
-  const int spinThreshold = 25000;  // Was 10000 - now needs strong spin
-  static unsigned long spinStartTime = 0;
+// Program the sample-rate divider and FIFO. Only called before the sampling
+// task starts or from the task itself, which owns the I2C bus.
+void configureMpuFifo(uint32_t hz) {
+  mpu.setDLPFMode(MPU6050_DLPF_BW_188);  // DLPF on -> 1kHz gyro output rate
+  mpu.setRate(MPU_OUTPUT_RATE_HZ / hz - 1);
+
+  mpu.setFIFOEnabled(false);
+  mpu.setTempFIFOEnabled(false);
+  mpu.setAccelFIFOEnabled(true);
+  mpu.setXGyroFIFOEnabled(true);
+  mpu.setYGyroFIFOEnabled(true);
+  mpu.setZGyroFIFOEnabled(true);
+
+  mpu.setInterruptMode(MPU6050_INTMODE_ACTIVEHIGH);
+  mpu.setInterruptDrive(MPU6050_INTDRV_PUSHPULL);
+  mpu.setInterruptLatch(MPU6050_INTLATCH_50USPULSE);
+  mpu.setInterruptLatchClear(MPU6050_INTCLEAR_ANYREAD);
+  mpu.setIntDataReadyEnabled(true);
+  mpu.setIntFIFOBufferOverflowEnabled(true);  // Latches FIFO_OFLOW in INT_STATUS
+
+  // Motion-detect INT shares the pin and is only armed while idle
+  mpu.setDHPFMode(MPU6050_DHPF_5);
+  mpu.setMotionDetectionThreshold(MPU_WAKE_MOTION_THRESHOLD);
+  mpu.setMotionDetectionDuration(MPU_WAKE_MOTION_DURATION);
+  mpu.setIntMotionEnabled(powerMode == POWER_IDLE);
+
+  mpu.resetFIFO();
+  mpu.setFIFOEnabled(true);
+
+  samplingActiveRateHz = hz;
+  samplingIndex = 0;
+  samplingStartMs = millis();
+}
 
-  if (abs(gz) > spinThreshold) {
-    if (spinStartTime == 0) spinStartTime = millis();
-    if (millis() - spinStartTime > 500) {
-      spinStartTime = 0;
-      return true;
-    }
-  } else spinStartTime = 0;
+// Idle wake source fired (see POWER MANAGEMENT); unblocks the detect task immediately
+void requestWake(uint8_t source) {
+  if (powerWakeSource == WAKE_NONE) powerWakeSource = source;
+  if (detectTaskHandle != nullptr) xTaskNotifyGive(detectTaskHandle);
+}
 
-  return false;
+inline int16_t fifoWord(const uint8_t *p) {
+  return (int16_t)((p[0] << 8) | p[1]);  // MPU6050 registers are big-endian
 }
 
-bool detectRocking(int16_t ax, int16_t ay) {
-  static unsigned long lastCrossTime = 0;
-  static int crossCount = 0;
-  static bool wasPositive = true;
+void samplingTask(void *param) {
+  uint8_t burst[MPU_FIFO_BURST_FRAMES * MPU_FIFO_FRAME_BYTES];
 
-  const int tiltThreshold = 12000;  // Was 5000 - now needs bigger tilt
-  unsigned long now = millis();
+  for (;;) {
+    // Data-ready INT wakes us every sample; the timeout keeps the FIFO
+    // draining if the INT line isn't wired.
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MPU_FIFO_POLL_MS));
 
-  bool isPositive = (ax > tiltThreshold);
-  bool isNegative = (ax < -tiltThreshold);
+    uint32_t newRate = samplingPendingRateHz;
+    if (newRate != 0) {
+      samplingPendingRateHz = 0;
+      configureMpuFifo(newRate);
+      continue;
+    }
 
-  if (now - lastCrossTime > 1500) crossCount = 0;
+    int64_t busy = taskBusyStart();
+    uint32_t profT = profStart();
+    // Read INT_STATUS before anything else: any register read clears it
+    uint8_t intStatus = mpu.getIntStatus();
+    if (powerMode == POWER_IDLE && (intStatus & MPU_INT_STATUS_MOTION)) requestWake(WAKE_MOTION);
+
+    uint32_t hz = samplingActiveRateHz;
+    uint16_t fifoCount = mpu.getFIFOCount();
+    if ((intStatus & MPU_INT_STATUS_FIFO_OFLOW) || fifoCount >= MPU_FIFO_SIZE) {
+      // Overflowed: the oldest frames were overwritten, so restart and count the gap
+      mpu.resetFIFO();
+      mpuFifoOverflows++;
+      uint32_t expected = (uint32_t)((uint64_t)(millis() - samplingStartMs) * hz / 1000);
+      if (expected > samplingIndex) {
+        samplingMissedSamples += expected - samplingIndex;
+        samplingIndex = expected;
+      }
+      taskBusyEnd(TASK_SAMPLING, busy);
+      continue;
+    }
 
-  if ((wasPositive && isNegative) || (!wasPositive && isPositive)) {
-    crossCount++;
-    lastCrossTime = now;
-    wasPositive = isPositive;
-  }
+    // FSRs come from the ADC DMA filter, so one read covers the whole burst
+    uint16_t fsr[FSR_CHANNEL_COUNT];
+    readFilteredFSR(fsr);
+    if (powerMode == POWER_IDLE) {
+      uint16_t strongest = 0;
+      for (int c = 0; c < FSR_CHANNEL_COUNT; c++) strongest = max(strongest, fsr[c]);
+      if (detectGripStateAdc(strongest) != GRIP_NONE) requestWake(WAKE_GRIP);
+    }
 
-  if (crossCount >= 4) {
-    crossCount = 0;
-    return true;
+    // Whole frames only; a frame the MPU6050 is still writing waits for the next pass
+    uint16_t frames = fifoCount / MPU_FIFO_FRAME_BYTES;
+    bool drained = frames > 0;
+    while (frames > 0) {
+      uint8_t chunk = frames > MPU_FIFO_BURST_FRAMES ? MPU_FIFO_BURST_FRAMES : frames;
+      mpu.getFIFOBytes(burst, chunk * MPU_FIFO_FRAME_BYTES);
+
+      for (uint8_t i = 0; i < chunk; i++) {
+        const uint8_t *p = &burst[i * MPU_FIFO_FRAME_BYTES];
+        SensorSample s;
+        s.timeMs = samplingStartMs + (unsigned long)((uint64_t)samplingIndex * 1000 / hz);
+        memcpy(s.fsrRaw, fsr, sizeof(s.fsrRaw));
+        s.ax = fifoWord(p + 0);
+        s.ay = fifoWord(p + 2);
+        s.az = fifoWord(p + 4);
+        s.gx = fifoWord(p + 6);
+        s.gy = fifoWord(p + 8);
+        s.gz = fifoWord(p + 10);
+        sampleRing.push(s);
+        samplingIndex++;
+        if (bootFirstSampleMs == 0) bootFirstSampleMs = millis();
+      }
+      frames -= chunk;
+    }
+    profEnd(PROF_MPU_READ, profT);
+    // While active the detect task runs once per burst; idle passes only wake on requestWake()
+    if (drained && powerMode == POWER_ACTIVE && detectTaskHandle != nullptr) xTaskNotifyGive(detectTaskHandle);
+
+    // The MPU6050 oscillator drifts against millis(); nudge the timebase by
+    // at most 1ms per burst so timestamps stay monotonic at 500Hz.
+    unsigned long lastSampleMs = samplingStartMs + (unsigned long)((uint64_t)samplingIndex * 1000 / hz);
+    long drift = (long)(millis() - lastSampleMs);
+    long deadband = 1000 / hz + 2;
+    if (drift > deadband) samplingStartMs++;
+    else if (drift < -deadband) samplingStartMs--;
+    taskBusyEnd(TASK_SAMPLING, busy);
   }
-
-  return false;
 }
 
-bool detectBouncing(int16_t az) {
-  static int bounceCount = 0;
-  static unsigned long lastBounceTime = 0;
-
-  const int impactThreshold = 28000;  // Was 20000 - now needs harder bounce
-  unsigned long now = millis();
-
-  if (now - lastBounceTime > 1000) bounceCount = 0;
+void updateImuStreamDecimation();
 
-  if (az > impactThreshold) {
-    if (now - lastBounceTime > 200) {
-      bounceCount++;
-      lastBounceTime = now;
-    }
-  }
+// Request a new sensor sample rate; the sampling task applies it
+void setSamplingRate(uint32_t hz) {
+  samplingRateHz = hz;
+  samplingPendingRateHz = hz;
+  xTaskNotifyGive(samplingTaskHandle);
+  updateImuStreamDecimation();  // An active stream keeps its output rate
 
-  if (bounceCount >= 3) {
-    bounceCount = 0;
-    return true;
-  }
-  return false;
+  LOG_INFO("SAMPLING", "Rate set to %u Hz", (unsigned)hz);
 }
 
-bool detectFreeFall(int16_t ax, int16_t ay, int16_t az) {
-  long mag = getMagnitude(ax, ay, az);
-  static unsigned long fallStartTime = 0;
+void startSampling() {
+  adcDmaActive = startAdcDma();
+  if (adcDmaActive) {
+    LOG_INFO("ADC", "DMA sampling active: %u Hz, oversample x%d", (unsigned)ADC_DMA_SAMPLE_FREQ_HZ, ADC_OVERSAMPLE);
+  } else {
+    LOG_WARN("ADC", "DMA init failed - falling back to analogRead()");
+  }
 
-  const int freeFallThreshold = 1500;   // Was 2000 - stricter (must be closer to zero-g)
-  const int minFallDuration = 150;      // Was 100 - needs longer fall time
+  samplingRateHz = DEFAULT_SAMPLE_RATE_HZ;
+  configureMpuFifo(DEFAULT_SAMPLE_RATE_HZ);
 
-  if (mag < freeFallThreshold) {
-    if (fallStartTime == 0) fallStartTime = millis();
-    else if (millis() - fallStartTime > minFallDuration) return true;
-  } else fallStartTime = 0;
+  samplingTaskHandle = startPinnedTask(TASK_SAMPLING, samplingTask, 4096, SAMPLING_TASK_PRIORITY, SAMPLING_TASK_CORE);
 
-  return false;
-}
+  pinMode(MPU_INT_PIN, INPUT);
+  attachInterrupt(digitalPinToInterrupt(MPU_INT_PIN), onMpuDataReady, RISING);
 
-bool detectImpact(int16_t ax, int16_t ay, int16_t az) {
-  return getMagnitude(ax, ay, az) > 38000;  // Was 30000 - now needs harder impact
+  LOG_INFO("SAMPLING", "MPU6050 FIFO at %u Hz, data-ready INT on GPIO %d", (unsigned)DEFAULT_SAMPLE_RATE_HZ, MPU_INT_PIN);
 }
 
-bool detectViolentShake(int16_t ax, int16_t ay, int16_t az) {
-  static long lastMag = 0;
-  static int shakeCount = 0;
-  static unsigned long lastTime = 0;
-
-  long mag = getMagnitude(ax, ay, az);
-  long delta = abs(mag - lastMag);
+// ===================== MOTION HISTORY =====================
+// Ring of the last MAX_MOTION_HISTORY non-None detections plus a per-type
+// histogram kept in step with it, so "most frequent" is an O(k) argmax.
 
-  const int shakeThreshold = 15000;   // Was 8000 - now needs violent shaking
-  const int countThreshold = 12;      // Was 10 - needs more shakes
-
-  if (millis() - lastTime > 1000) shakeCount = 0;
-
-  if (delta > shakeThreshold) {
-    shakeCount++;
-    lastTime = millis();
+void recordMotion(MotionType motion) {
+  if (motionHistoryCount == MAX_MOTION_HISTORY) {
+    // Full: the oldest entry falls out of the window
+    motionCounts[motionHistory[motionHistoryHead]]--;
+  } else {
+    motionHistoryCount++;
   }
+  motionHistory[motionHistoryHead] = motion;
+  motionCounts[motion]++;
+  motionHistoryHead = (motionHistoryHead + 1) % MAX_MOTION_HISTORY;
+}
 
-  lastMag = mag;
+void resetMotionHistory() {
+  motionHistoryHead = 0;
+  motionHistoryCount = 0;
+  memset(motionCounts, 0, sizeof(motionCounts));
+}
 
-  if (shakeCount >= countThreshold) {
-    shakeCount = 0;
-    return true;
+// Get most frequent motion from history (excludes "None" unless it's the only motion)
+MotionType getMostFrequentMotion() {
+  MotionType mostFrequent = MOTION_NONE;
+  uint16_t maxCount = 0;
+
+  for (int m = MOTION_NONE + 1; m < MOTION_TYPE_COUNT; m++) {
+    if (motionCounts[m] > maxCount) {
+      maxCount = motionCounts[m];
+      mostFrequent = (MotionType)m;
+    }
   }
-
-  return false;
+  return mostFrequent;
 }
 
-bool detectTremble(int16_t ax, int16_t ay, int16_t az) {
-  static long lastMag = 0;
-  static int trembleCount = 0;
-  static unsigned long lastTime = 0;
-  static unsigned long lastCountTime = 0;
-
-  long mag = getMagnitude(ax, ay, az);
-  long delta = abs(mag - lastMag);
-
-  // Thresholds raised for ball toy - needs real trembling, not just movement
-  const int trembleThreshold = 6000;  // Was 3500 - minimum change to count as tremble
-  const int trembleMax = 14000;       // Was 7000 - max change (above = shake)
-  const int required = 18;            // Was 15 - needs more trembles
-  const int windowMs = 800;           // Time window to accumulate trembles
-  const int minTimeBetweenCounts = 30; // Minimum ms between counting trembles
-
-  // Reset if window expired
-  if (millis() - lastTime > windowMs) trembleCount = 0;
-
-  // Only count if enough time passed since last count (prevents rapid false counting)
-  if (delta > trembleThreshold && delta < trembleMax) {
-    if (millis() - lastCountTime > minTimeBetweenCounts) {
-      trembleCount++;
-      lastCountTime = millis();
-      lastTime = millis();
-    }
+// ===================== PSI WINDOW STATS =====================
+// Add one PSI sample to the bucket for its 500ms slot
+void addPsiSample(psi_t psi, unsigned long now) {
+  unsigned long slotStart = now - (now % PSI_BUCKET_MS);
+  PsiBucket &b = psiBuckets[(now / PSI_BUCKET_MS) % PSI_BUCKET_COUNT];
+  uint16_t centi = psiToCenti(psi);
+
+  if (b.count == 0 || b.slotStartMs != slotStart) {
+    // Slot wrapped around: drop the stale bucket and start fresh
+    b.count = 0;
+    b.sum = 0;
+    b.sumSq = 0;
+    b.minCenti = centi;
+    b.maxCenti = centi;
+    b.slotStartMs = slotStart;
   }
 
-  lastMag = mag;
+  b.count++;
+  b.sum += centi;
+  b.sumSq += (uint32_t)centi * centi;
+  if (centi < b.minCenti) b.minCenti = centi;
+  if (centi > b.maxCenti) b.maxCenti = centi;
+}
 
-  if (trembleCount >= required) {
-    trembleCount = 0;
-    return true;
+// Merge all buckets inside the last 5s. The sums are exact, so the variance
+// numerator n·Σx² - (Σx)² has no cancellation error; floats only appear here.
+void getPsiWindowStats(unsigned long now, PsiStats &out) {
+  unsigned long windowMs = (unsigned long)PSI_BUCKET_MS * PSI_BUCKET_COUNT;
+  uint32_t n = 0;
+  uint64_t sum = 0;
+  uint64_t sumSq = 0;
+  uint16_t minCenti = 0;
+  uint16_t maxCenti = 0;
+
+  for (int i = 0; i < PSI_BUCKET_COUNT; i++) {
+    const PsiBucket &b = psiBuckets[i];
+    if (b.count == 0 || now - b.slotStartMs >= windowMs) continue;
+
+    if (n == 0) {
+      minCenti = b.minCenti;
+      maxCenti = b.maxCenti;
+    } else {
+      if (b.minCenti < minCenti) minCenti = b.minCenti;
+      if (b.maxCenti > maxCenti) maxCenti = b.maxCenti;
+    }
+    n += b.count;
+    sum += b.sum;
+    sumSq += b.sumSq;
   }
 
-  return false;
+  out.count = n;
+  out.minPsi = minCenti * 0.01f;
+  out.maxPsi = maxCenti * 0.01f;
+  out.mean = n > 0 ? (float)sum / n * 0.01f : 0.0f;
+  out.stddev = n > 1 ? sqrtf((float)(n * sumSq - sum * sum) / ((float)n * (n - 1))) * 0.01f : 0.0f;
 }
 
 // ===================== MOTION DEBUG =====================
@@ -589,348 +1331,2045 @@ bool detectTremble(int16_t ax, int16_t ay, int16_t az) {
   // Serial.println("==================================");
 // }
 
-// ===================== PLAY SOUND =====================
-void playSound(int idx) {
-  dfplayer.stop();
-  delay(80);
-
-  dfplayer.play(idx);
-  delay(50);                 // DFPlayer needs time to latch track
-  dfplayer.volume(currentVolume);
+// ===================== AUDIO COMMAND QUEUE =====================
+// DFPlayer commands are queued as timed steps and executed by serviceAudioQueue()
+// on the io task, so stop -> settle -> play -> volume never blocks sampling,
+// detection or UDP. The detect task posts steps through audioRing; only the io
+// task touches audioQueue and the DFPlayer serial port.
+enum AudioOp : uint8_t {
+  AUDIO_OP_STOP,
+  AUDIO_OP_PLAY,
+  AUDIO_OP_VOLUME,
+  AUDIO_OP_CLEAR          // Drop every step not yet sent (posted by clearAudioQueue())
+};
 
-  isPlaying = true;
+struct AudioStep {
+  AudioOp op;
+  uint8_t arg;            // Track or volume
+  uint16_t settleMs;      // Wait after this step before the next one
+};
 
-  Serial.print("[AUDIO] Playing track ");
-  Serial.print(idx);
-  Serial.print(" at volume ");
-  Serial.println(currentVolume);
-}
+SpscRing<AudioStep, AUDIO_REQUEST_RING_SIZE> audioRing;  // detect task -> io task
 
-// ===================== SAFE UDP SEND =====================
-void sendUDP(const String &msg) {
-  if (millis() - lastUDPSend < 200) return;  // prevent mbox crash
-  lastUDPSend = millis();
+AudioStep audioQueue[AUDIO_QUEUE_SIZE];
+int audioQueueHead = 0;
+volatile int audioQueueCount = 0;         // Read by updatePowerMode() on the detect task
+unsigned long audioNextStepTime = 0;
 
-  udp.beginPacket(PI_IP, PI_PORT);
-  udp.write((uint8_t*)msg.c_str(), msg.length());
-  udp.endPacket();
+// Detect task side: post a step for the io task
+void enqueueAudioStep(AudioOp op, uint8_t arg, uint16_t settleMs) {
+  if (!audioRing.push({ op, arg, settleMs })) {
+    LOG_WARN("AUDIO", "Request ring full - command dropped");
+    return;
+  }
+  notifyTask(TASK_IO);
+}
 
-  delay(5);  // allow network task to flush
+// Drop everything not yet sent - a new stop/play sequence supersedes it
+void clearAudioQueue() {
+  enqueueAudioStep(AUDIO_OP_CLEAR, 0, 0);
 }
 
-// ===================== RECEIVE COMMANDS FROM PI =====================
-void handlePiCommand(String cmd) {
-  cmd.trim();
-  cmd.toUpperCase();
-  Serial.print("Handling Pi command: ");
-  Serial.println(cmd);
-
-  if (cmd == "PLAY:STOP") {
-    dfplayer.stop();
-    isPlaying = false;
-    alarmPlaying = false;  // Clear alarm flag if stopped
-  }
-  else if (cmd.startsWith("PLAY:")) {
-    int track = cmd.substring(5).toInt();
-    dfplayer.stop();          // HARD stop current audio
-    delay(80);                // Allow DFPlayer to flush buffer
-
-    // Track 14 is "Find My Device" alarm - play at MAX volume
-    if (track == 14) {
-      Serial.println("[ALARM] Find My Device activated - MAX VOLUME");
-      dfplayer.volume(30);    // Set to max volume
-      delay(50);
-      dfplayer.play(track);
-      alarmPlaying = true;
-      alarmStartTime = millis();
-      Serial.print("[ALARM] Will restore volume to ");
-      Serial.print(currentVolume);
-      Serial.print(" after ");
-      Serial.print(ALARM_DURATION / 1000);
-      Serial.println(" seconds");
-    } else {
-      // Normal track - use configured volume
-      dfplayer.play(track);
-      dfplayer.volume(currentVolume);
+// io task side: move one posted step into the timed queue
+void queueAudioStep(const AudioStep &step) {
+  if (step.op == AUDIO_OP_CLEAR) {
+    audioQueueHead = 0;
+    audioQueueCount = 0;
+    return;
+  }
+
+  // Coalesce: a volume change right behind another one simply updates it. An
+  // earlier VOLUME (e.g. the track 14 alarm level ahead of its PLAY) is left alone.
+  if (step.op == AUDIO_OP_VOLUME && audioQueueCount > 0) {
+    AudioStep &tail = audioQueue[(audioQueueHead + audioQueueCount - 1) % AUDIO_QUEUE_SIZE];
+    if (tail.op == AUDIO_OP_VOLUME) {
+      tail.arg = step.arg;
+      return;
     }
+  }
 
-    isPlaying = true;
-    Serial.print("[AUDIO] Switched to track ");
-    Serial.println(track);
+  if (audioQueueCount >= AUDIO_QUEUE_SIZE) {
+    LOG_WARN("AUDIO", "Queue full - command dropped");
+    return;
   }
-  else if (cmd.startsWith("VOLUME:")) {
-    int vol = cmd.substring(7).toInt();
-    currentVolume = constrain(vol, 0, 30);
+  audioQueue[(audioQueueHead + audioQueueCount) % AUDIO_QUEUE_SIZE] = step;
+  audioQueueCount++;
+}
 
-    dfplayer.volume(currentVolume);
+// Execute at most one DFPlayer step per call once the previous step has settled
+// Steps wait in the queue until the DFPlayer has booted, and are dropped if it never does.
+void serviceAudioQueue(unsigned long now) {
+  AudioStep posted;
+  while (audioRing.pop(posted)) queueAudioStep(posted);
 
-    Serial.print("[AUDIO] Volume set to ");
-    Serial.println(currentVolume);
-  }
-  // Debug mode commands
-  else if (cmd == "DEBUG:ON") {
-    DEBUG_MOTION = true;
-    Serial.println("[DEBUG] Motion debug ENABLED");
+  if (bootStages[BOOT_DFPLAYER].state == BOOT_FAILED) {
+    audioQueueHead = 0;
+    audioQueueCount = 0;
   }
-  else if (cmd == "DEBUG:OFF") {
-    DEBUG_MOTION = false;
-    Serial.println("[DEBUG] Motion debug DISABLED");
-  }
-  else if (cmd == "DEBUG:VERBOSE") {
-    DEBUG_MOTION_VERBOSE = !DEBUG_MOTION_VERBOSE;
-    Serial.print("[DEBUG] Verbose mode: ");
-    Serial.println(DEBUG_MOTION_VERBOSE ? "ON" : "OFF");
-  }
-  else if (cmd == "STATUS") {
-    // Send back current status
-    String status = "STATUS:debug=" + String(DEBUG_MOTION ? "on" : "off");
-    status += ",grip=" + gripStateToString(currentGripState);
-    status += ",psi=" + String(max(lastPSI1, lastPSI2), 2);
-    status += ",ble=stealth";
-    Serial.println(status);
-    sendUDP(status);
-  }
-  else {
-    Serial.println("Unknown command. Available: PLAY:n, PLAY:STOP, VOLUME:n, DEBUG:ON, DEBUG:OFF, DEBUG:VERBOSE, STATUS");
+  if (!bootReady(BOOT_DFPLAYER)) return;
+  if (audioQueueCount == 0 || (long)(now - audioNextStepTime) < 0) return;
+
+  AudioStep step = audioQueue[audioQueueHead];
+  audioQueueHead = (audioQueueHead + 1) % AUDIO_QUEUE_SIZE;
+  audioQueueCount--;
+
+  switch (step.op) {
+    case AUDIO_OP_STOP:   dfplayer.stop();           break;
+    case AUDIO_OP_PLAY:   dfplayer.play(step.arg);   break;
+    case AUDIO_OP_VOLUME: dfplayer.volume(step.arg); break;
+    case AUDIO_OP_CLEAR:  break;  // Handled in queueAudioStep()
   }
+  audioNextStepTime = now + step.settleMs;
 }
 
-// ===================== SETUP =====================
-void setup() {
-  Serial.begin(115200);
-  delay(300);
+// ===================== PLAY SOUND =====================
+void playSound(int idx) {
+  clearAudioQueue();
+  enqueueAudioStep(AUDIO_OP_STOP, 0, AUDIO_STOP_SETTLE_MS);
+  enqueueAudioStep(AUDIO_OP_PLAY, idx, AUDIO_LATCH_SETTLE_MS);
+  enqueueAudioStep(AUDIO_OP_VOLUME, currentVolume, 0);
 
-  Serial.println("========================================");
-  Serial.println("   ESP32 Stress Ball  ");
-  Serial.println("========================================");
+  isPlaying = true;
 
-  analogSetPinAttenuation(FSR1_PIN, ADC_11db);
-  analogSetPinAttenuation(FSR2_PIN, ADC_11db);
+  LOG_INFO("AUDIO", "Playing track %d at volume %d", idx, currentVolume);
+}
 
-  Wire.begin(I2C_SDA, I2C_SCL);
-  mpu.initialize();
-  Serial.println("[MPU6050] Initialized");
+// ===================== RAW IMU STREAM STATE =====================
+struct __attribute__((packed)) ImuBatchHeader {
+  uint8_t magic;          // IMU_STREAM_MAGIC
+  uint8_t version;        // IMU_STREAM_VERSION
+  uint16_t count;         // Samples in this batch
+  uint16_t batchSeq;      // Wraps at 65535
+  uint16_t rateHz;        // Effective stream rate
+  uint32_t firstIndex;    // Stream index of the first sample (gaps = loss on the way)
+  uint32_t firstTimeMs;   // Acquisition time of the first sample
+  uint32_t lostSamples;   // Cumulative samples dropped on the ESP32
+  int64_t firstSyncMs;    // firstTimeMs in the Pi's Unix ms, 0 = not synced (v2)
+};
 
-  mp3Serial.begin(9600, SERIAL_8N1, PIN_MP3_RX, PIN_MP3_TX);
-  delay(500);
-
-  Serial.println("[DEBUG] Initializing DFPlayer...");
-  if (!dfplayer.begin(mp3Serial)) {
-    Serial.println("[ERROR] DFPlayer init FAILED! Check:");
-    Serial.println("  - SD card inserted and FAT32 formatted?");
-    Serial.println("  - MP3 files named 001.mp3, 002.mp3, etc?");
-    Serial.println("  - TX/RX wiring correct? (ESP TX->DFPlayer RX)");
-    Serial.println("  - 1K resistor on TX line?");
-  } else {
-    Serial.println("[DEBUG] DFPlayer initialized successfully!");
-  }
+struct __attribute__((packed)) ImuBatchSample {
+  uint16_t dtMs;          // Acquisition time relative to firstTimeMs
+  int16_t ax, ay, az;
+  int16_t gx, gy, gz;
+};
 
-  delay(1000);
-  dfplayer.volume(30);
-  Serial.println("[DEBUG] Volume set to 30");
+struct __attribute__((packed)) ImuBatchPacket {
+  ImuBatchHeader header;
+  ImuBatchSample samples[IMU_STREAM_BATCH_MAX];
+};
+static_assert(sizeof(ImuBatchHeader) == 28 && sizeof(ImuBatchSample) == 14,
+              "IMU batch layout is shared with the Pi decoder");
+
+ImuBatchPacket imuBatch;
+bool imuStreamActive = false;
+uint32_t imuStreamRateHz = 0;
+uint32_t imuStreamRestoreRateHz = 0;      // Sampling rate to restore on STREAM:OFF (0 = unchanged)
+uint32_t imuStreamDecimation = 1;         // Keep every Nth fixed-rate sample
+uint32_t imuStreamDecimationCount = 0;
+uint32_t imuStreamIndex = 0;              // Index of the next streamed sample
+uint32_t imuStreamLost = 0;               // Samples dropped (buffer full while backing off / send failed)
+uint16_t imuStreamBatchSeq = 0;
+unsigned long imuStreamLastSend = 0;
+unsigned long imuStreamGapMs = IMU_STREAM_MIN_GAP_MS;
+
+// ===================== NETWORK IDENTITY =====================
+// Every packet names its ball (device field / v4 frame deviceId) and carries
+// telemetrySeq, so one hub can demultiplex a fleet and count loss per ball.
+
+void initDeviceIdentity() {
+  uint64_t mac = ESP.getEfuseMac();  // Byte 0 of the MAC in the low bits
+  deviceIdNum = (uint32_t)((mac >> 24) & 0xFF) << 16 | (uint32_t)((mac >> 32) & 0xFF) << 8 | (uint32_t)((mac >> 40) & 0xFF);
+  snprintf(deviceId, sizeof(deviceId), "%s%06X", DEVICE_ID_PREFIX, (unsigned)deviceIdNum);
+  snprintf(bleDeviceName, sizeof(bleDeviceName), "%s-%06X", BLE_DEVICE_NAME, (unsigned)deviceIdNum);
+  netMode = (NetMode)firmwareConfig.netMode;
+}
 
-  // Initialize BLE Beacon
-  setupBLE();
+// AP: up once the AP has started. STA: associated and holding a DHCP lease.
+bool netLinkUp() {
+  if (!bootReady(BOOT_WIFI)) return false;  // No lwIP until the interface is up
+  return netMode == NET_MODE_AP || (WiFi.getStatusBits() & STA_HAS_IP_BIT);
+}
 
-  // WiFi AP
-  WiFi.mode(WIFI_AP);
-  WiFi.softAP(AP_SSID, AP_PASS);
-  delay(400);
+// AP: the Pi's fixed lease. STA: whoever last sent us a command, else the gateway.
+IPAddress netPeerIP() {
+  if (netMode == NET_MODE_AP) {
+    IPAddress ip;
+    ip.fromString(PI_IP);
+    return ip;
+  }
+  uint32_t hub = netHubAddr;
+  return hub != 0 ? IPAddress(hub) : WiFi.gatewayIP();
+}
+
+// Modem sleep is mandatory for a station with BLE running; the AP keeps full power
+wifi_ps_type_t netActivePowerSave() {
+  return netMode == NET_MODE_STA ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE;
+}
+
+const char* netModeToString(NetMode mode) {
+  return mode == NET_MODE_STA ? "sta" : "ap";
+}
 
-  udp.begin(ESP_COMMAND_PORT);
-  Serial.println("[WiFi] AP started: " + String(AP_SSID));
-  Serial.println("[WiFi] UDP command listener on port " + String(ESP_COMMAND_PORT));
+// ===================== NETWORK TX TASK =====================
+// Every datagram to the Pi is sent by netTxTask on the protocol core, so the
+// detect task never waits on lwIP (this replaces the old 200ms send throttle
+// and delay(5) flush). The detect task is the only producer: netTxUrgent
+// (alerts, clock sync) is always drained before netTxRing (telemetry, command
+// replies, IMU batches). A packet lwIP refuses is counted and dropped, and
+// net_tx pauses NET_TX_BACKOFF_MS before the next one.
+enum NetPacketKind : uint8_t {
+  NET_PACKET_DATA,
+  NET_PACKET_IMU,       // IMU batch: refusals also drive the stream back-off
+  NET_PACKET_SYNC_REQ   // Built by net_tx at send time, so t1 is the real send time
+};
 
-  // Test DFPlayer at startup
-  Serial.println("[DEBUG] Testing DFPlayer");
-  dfplayer.volume(0);      // mute
-  delay(200);
-  dfplayer.stop();         // ensure idle
-  delay(200);
-  dfplayer.volume(30);     // restore default volume
-  Serial.println("[DEBUG] Startup test complete. Ready for sensor input.");
+struct NetPacket {
+  NetPacketKind kind;
+  uint16_t length;
+  uint8_t data[NET_PACKET_MAX];
+};
 
-  Serial.println("========================================");
-  Serial.println("   System Ready - Monitoring Active");
-  Serial.println("========================================");
+SpscRing<NetPacket, NET_TX_URGENT_RING_SIZE> netTxUrgent;
+SpscRing<NetPacket, NET_TX_RING_SIZE> netTxRing;
+volatile uint32_t netTxSent = 0;
+volatile uint32_t netTxRefused = 0;      // lwIP rejected the packet (buffers/mbox full)
+volatile uint32_t netTxImuRefused = 0;
+volatile uint32_t netTxOversize = 0;     // Longer than NET_PACKET_MAX, never queued
+
+// t1 of the last SYNC:REQ that left the ball (0 = refused); 64-bit, so under a lock
+portMUX_TYPE netSyncMux = portMUX_INITIALIZER_UNLOCKED;
+int64_t netSyncT1 = 0;
+
+int64_t netSyncSentT1() {
+  portENTER_CRITICAL(&netSyncMux);
+  int64_t t1 = netSyncT1;
+  portEXIT_CRITICAL(&netSyncMux);
+  return t1;
 }
 
-// ===================== MAIN LOOP =====================
-void loop() {
-  // ----- 1) RECEIVE COMMANDS -----
-  int packetSize = udp.parsePacket();
-  if (packetSize) {
-    char buffer[256];
-    int len = udp.read(buffer, sizeof(buffer) - 1);
-    if (len > 0) buffer[len] = '\0';
-    handlePiCommand(String(buffer));
+// Copy a datagram into a ring and wake net_tx; false when the ring is full
+template <uint32_t N>
+bool netEnqueue(SpscRing<NetPacket, N> &ring, NetPacketKind kind, const uint8_t *data, size_t length) {
+  if (length > NET_PACKET_MAX) {
+    netTxOversize++;
+    return false;
   }
+  NetPacket p;
+  p.kind = kind;
+  p.length = length;
+  if (length > 0) memcpy(p.data, data, length);
+  if (!ring.push(p)) return false;
+  notifyTask(TASK_NET_TX);
+  return true;
+}
 
-  // ----- 2) SENSOR READING -----
-  // Read raw ADC values
-  int fsr1_raw = analogRead(FSR1_PIN);
-  int fsr2_raw = analogRead(FSR2_PIN);
+bool netTxSend(NetPacket &p) {
+  if (p.kind == NET_PACKET_SYNC_REQ) {
+    int64_t t1 = esp_timer_get_time();
+    p.length = snprintf((char*)p.data, sizeof(p.data), "SYNC:REQ:%lld", (long long)t1);
+    portENTER_CRITICAL(&netSyncMux);
+    netSyncT1 = t1;
+    portEXIT_CRITICAL(&netSyncMux);
+  }
 
-  // Convert to PSI with averaging for reliability
-  lastPSI1 = getAveragedPSI(FSR1_PIN);
-  lastPSI2 = getAveragedPSI(FSR2_PIN);
-  float maxPSI = max(lastPSI1, lastPSI2);
+  bool sent = netLinkUp() &&
+              udp.beginPacket(netPeerIP(), PI_PORT) &&
+              udp.write(p.data, p.length) == p.length &&
+              udp.endPacket();
+  if (sent) {
+    netTxSent++;
+    return true;
+  }
 
-  // Record PSI to history for aggregation (for periodic updates)
-  if (psiHistoryCount < MAX_PSI_HISTORY) {
-    psiHistory[psiHistoryCount] = maxPSI;
-    psiHistoryCount++;
+  netTxRefused++;
+  if (p.kind == NET_PACKET_IMU) netTxImuRefused++;
+  if (p.kind == NET_PACKET_SYNC_REQ) {
+    portENTER_CRITICAL(&netSyncMux);
+    netSyncT1 = 0;
+    portEXIT_CRITICAL(&netSyncMux);
   }
+  return false;
+}
 
-  // Update grip state (with confirmation to prevent false triggers)
-  bool gripStateChanged = updateGripState(lastPSI1, lastPSI2);
+void netTxTask(void *param) {
+  static NetPacket p;  // Only this task touches it; keeps 1.4KB off the stack
 
-  // Determine if child is squeezing (any significant pressure)
-  bool squeeze = (maxPSI > PSI_NO_GRIP);
-
-  // ===================== 3-GRIP PATTERN LOGIC =====================
-  // Logic: 3 distinct grips > PSI_STRESSED with gap < 3s between them.
-  
-  bool patternTriggered = false;
-  
-  // 1. Detect Grip Start (Pressure > Stressed Threshold)
-  if (maxPSI >= PSI_STRESSED) {
-    if (!isGripping) {
-      // START of a new grip
-      isGripping = true;
-      currentMaxGrip = detectGripState(maxPSI); // Initialize max for this grip
-      
-      unsigned long timeSinceLastRelease = millis() - lastReleaseTime;
-      
-      // Check Gap Logic
-      if (sequenceCount > 0) {
-        // We have previous grips. Check if gap is valid.
-        if (timeSinceLastRelease > GAP_MAX_MS) {
-           // TIMEOUT: Gap too long. Reset sequence.
-           Serial.println("[PATTERN] Gap too long (" + String(timeSinceLastRelease) + "ms). Resetting sequence.");
-           sequenceCount = 0; 
-           // Treat this as the NEW first grip
-        } else {
-           // VALID GAP: Continue sequence
-           Serial.println("[PATTERN] Valid gap (" + String(timeSinceLastRelease) + "ms). Grip #" + String(sequenceCount + 1));
-        }
-      }
-      
-      // Increment count for this new grip
-      sequenceCount++;
-      
-      // CHECK COMPLETION (Trigger on Start of 3rd Grip)
-      if (sequenceCount >= GRIP_PATTERN_COUNT) {
-        patternTriggered = true;
-
-        // Store the 3rd grip type
-        sequenceGrips[GRIP_PATTERN_COUNT - 1] = currentMaxGrip;
-
-        // Determine dominant grip type across all 3 grips
-        dominantGripType = getDominantGripType();
-
-        Serial.println("[PATTERN] 3-GRIP PATTERN DETECTED!");
-        Serial.print("[PATTERN] Grips: ");
-        Serial.print(gripStateToString(sequenceGrips[0]));
-        Serial.print(" -> ");
-        Serial.print(gripStateToString(sequenceGrips[1]));
-        Serial.print(" -> ");
-        Serial.println(gripStateToString(sequenceGrips[2]));
-        Serial.print("[PATTERN] Dominant type: ");
-        Serial.println(gripStateToString(dominantGripType));
-
-        // Reset sequence (keep isGripping=true to avoid double counting)
-        sequenceCount = 0;
-      }
-    } else {
-      // CONTINUING a grip
-      // Update max grip strength observed during this hold
-      GripState potentialState = detectGripState(maxPSI);
-      if (potentialState > currentMaxGrip) {
-        currentMaxGrip = potentialState;
-      }
-    }
-  } else {
-    // RELEASE (Pressure < Stressed Threshold)
-    if (isGripping) {
-      // END of a grip
-      isGripping = false;
-      lastReleaseTime = millis();
-      Serial.println("[PATTERN] Grip released. Waiting for next...");
-      
-      // Store the max grip we saw (if we haven't triggered/reset yet)
-      // Note: If we triggered, sequenceCount is already 0.
-      if (sequenceCount > 0 && sequenceCount < GRIP_PATTERN_COUNT) {
-        sequenceGrips[sequenceCount - 1] = currentMaxGrip;
-      }
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // Woken by netEnqueue()
+
+    while (netTxUrgent.pop(p) || netTxRing.pop(p)) {
+      int64_t busy = taskBusyStart();
+      bool sent = netTxSend(p);
+      taskBusyEnd(TASK_NET_TX, busy);
+      if (!sent) vTaskDelay(pdMS_TO_TICKS(NET_TX_BACKOFF_MS));
     }
   }
+}
 
-  // Check if child is in distress state
-  bool inDistress = isChildInDistress();
+// ===================== CLOCK SYNC =====================
+// The ball is the NTP client and the Pi's wall clock is the shared timebase.
+// t1 = request sent (local), t2/t3 = Pi receive/send, t4 = reply received
+// (local, stamped in commandReceiverTask). offset = ((t2-t1) + (t3-t4)) / 2
+// with error <= rtt/2, so the lowest-RTT sample of the last SYNC_FILTER_SIZE
+// becomes the reference. Drift is the smoothed slope between successive
+// references at least SYNC_DRIFT_MIN_SPAN_US apart. Samples and alerts are
+// stamped with syncTimeMs() of their acquisition time, never the send time.
+struct SyncSample {
+  int64_t localUs;        // Midpoint of t1..t4
+  int64_t offsetUs;       // Pi - local
+  uint32_t rttUs;
+};
 
-  int16_t ax, ay, az, gx, gy, gz;
-  mpu.getMotion6(&ax, &ay, &az, &gx, &gy, &gz);
+struct ClockSyncState {
+  bool valid;
+  int64_t refLocalUs;     // Reference point of the current estimate
+  int64_t refOffsetUs;
+  float driftPpm;         // d(offset)/d(local); Pi clock fast = positive
+  bool driftValid;
+  uint32_t rttUs;         // Last accepted exchange
+  uint32_t rttMinUs;      // Best in the filter window (error bound x2)
+  unsigned long lastGoodMs;
+  uint32_t count;         // Accepted replies
+  uint32_t lost;          // Requests without a reply in time
+  uint32_t rejected;      // Replies over SYNC_RTT_MAX_US or not matching the pending request
+  bool pending;           // Request queued; its t1 is netSyncSentT1()
+  unsigned long pendingSentMs;
+  unsigned long nextRequestMs;
+  uint8_t burstLeft;
+};
 
-  // Print motion debug info (controlled by DEBUG_MOTION flag)
-  // printMotionDebug(ax, ay, az, gx, gy, gz);
+ClockSyncState clockSync = {};
+SyncSample syncWindow[SYNC_FILTER_SIZE];
+int syncWindowCount = 0;
+int syncWindowHead = 0;
 
-  String motion = "";
-  if (detectImpact(ax, ay, az)) motion = "Impact";
-  else if (detectBouncing(az)) motion = "Bounce";
-  else if (detectFreeFall(ax, ay, az)) motion = "FreeFall";
-  else if (detectViolentShake(ax, ay, az)) motion = "ViolentShake";
-  else if (detectSpinning(gx, gy, gz)) motion = "Spinning";
-  else if (detectRocking(ax, ay)) motion = "Rocking";
-  else if (detectTremble(ax, ay, az)) motion = "Tremble";
-  else motion = "None";
+String int64ToString(int64_t v) {
+  char buffer[24];
+  snprintf(buffer, sizeof(buffer), "%lld", (long long)v);
+  return String(buffer);
+}
 
-  // Record motion to history ONLY if it's not "None" (for periodic updates)
-  // This way, actual motions aren't drowned out by hundreds of "None" entries
-  if (motion != "None" && motionHistoryCount < MAX_MOTION_HISTORY) {
-    motionHistory[motionHistoryCount] = motion;
-    motionHistoryCount++;
-  }
+// Pi - local at a local time, extrapolated with the drift estimate
+int64_t syncOffsetAtUs(int64_t localUs) {
+  int64_t offset = clockSync.refOffsetUs;
+  if (clockSync.driftValid) offset += (int64_t)(clockSync.driftPpm * (float)(localUs - clockSync.refLocalUs) * 1e-6f);
+  return offset;
+}
 
-  // ----- 3) TRACK CONSECUTIVE MOTIONS -----
-  bool shouldPlayForMotion = false;
-  if (motion != "None") {
-    if (motion == lastMotionType) {
-      consecutiveMotionCount++;
-      Serial.print("[DEBUG] Same motion detected: ");
-      Serial.print(motion);
-      Serial.print(" count: ");
-      Serial.println(consecutiveMotionCount);
-    } else {
-      consecutiveMotionCount = 1;
-      lastMotionType = motion;
-      Serial.print("[DEBUG] New motion type: ");
-      Serial.println(motion);
-    }
+// Shared-timebase ms for a millis()-based acquisition time, 0 until the first sync
+int64_t syncTimeMs(unsigned long localMs) {
+  if (!clockSync.valid) return 0;
+  int64_t nowUs = esp_timer_get_time();       // millis() is this clock / 1000
+  unsigned long nowMs = (unsigned long)(nowUs / 1000);
+  int64_t localUs = nowUs - (int64_t)(int32_t)(nowMs - localMs) * 1000;
+  return (localUs + syncOffsetAtUs(localUs)) / 1000;
+}
 
-    if (consecutiveMotionCount >= CONSECUTIVE_MOTION_THRESHOLD) {
-      shouldPlayForMotion = true;
-      consecutiveMotionCount = 0;  // Reset after triggering
-      Serial.println("[DEBUG] 5 consecutive motions reached - triggering sound!");
-    }
-  }
+const char* syncStateToString(unsigned long now) {
+  if (!clockSync.valid) return "none";
+  return now - clockSync.lastGoodMs > SYNC_STALE_MS ? "stale" : "ok";
+}
+
+// net_tx stamps t1 and fills in the payload when the request actually goes out
+void sendSyncRequest(unsigned long now) {
+  clockSync.pending = netEnqueue(netTxUrgent, NET_PACKET_SYNC_REQ, nullptr, 0);
+  clockSync.pendingSentMs = now;
+}
+
+// Request schedule: a burst while unsynced (or after a lost link), then every SYNC_INTERVAL_MS
+void serviceClockSync(unsigned long now) {
+  static bool linkWasUp = false;
+  bool linkUp = netLinkUp();
+  if (linkUp && !linkWasUp) {
+    clockSync.burstLeft = SYNC_BURST_COUNT;
+    clockSync.nextRequestMs = now;
+  }
+  linkWasUp = linkUp;
+  if (!linkUp) return;
+
+  if (clockSync.pending && now - clockSync.pendingSentMs > SYNC_REPLY_TIMEOUT_MS) {
+    clockSync.pending = false;
+    clockSync.lost++;
+  }
+  if (clockSync.pending || (long)(now - clockSync.nextRequestMs) < 0) return;
+
+  sendSyncRequest(now);
+  if (clockSync.burstLeft > 0) clockSync.burstLeft--;
+  bool burst = clockSync.burstLeft > 0 || !clockSync.valid;
+  clockSync.nextRequestMs = now + (burst ? SYNC_BURST_GAP_MS : SYNC_INTERVAL_MS);
+}
+
+void clockSyncReply(int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+  if (!clockSync.pending || t1 != netSyncSentT1()) {
+    clockSync.rejected++;  // Late reply to a request we already gave up on
+    return;
+  }
+  clockSync.pending = false;
+
+  int64_t rtt = (t4 - t1) - (t3 - t2);
+  if (rtt < 0 || rtt > SYNC_RTT_MAX_US) {
+    clockSync.rejected++;
+    return;
+  }
+
+  SyncSample sample = { t1 + (t4 - t1) / 2, ((t2 - t1) + (t3 - t4)) / 2, (uint32_t)rtt };
+  syncWindow[syncWindowHead] = sample;
+  syncWindowHead = (syncWindowHead + 1) % SYNC_FILTER_SIZE;
+  if (syncWindowCount < SYNC_FILTER_SIZE) syncWindowCount++;
+  clockSync.rttUs = sample.rttUs;
+  clockSync.count++;
+  clockSync.lastGoodMs = millis();
+
+  const SyncSample *best = &syncWindow[0];
+  for (int i = 1; i < syncWindowCount; i++) {
+    if (syncWindow[i].rttUs < best->rttUs) best = &syncWindow[i];
+  }
+  clockSync.rttMinUs = best->rttUs;
+
+  if (!clockSync.valid) {
+    clockSync.valid = true;
+    clockSync.refLocalUs = best->localUs;
+    clockSync.refOffsetUs = best->offsetUs;
+    LOG_INFO("SYNC", "Locked: offset %lldms, rtt %uus", (long long)(best->offsetUs / 1000), (unsigned)best->rttUs);
+    return;
+  }
+
+  // Move the reference forward only; the older one anchors the drift slope
+  if (best->localUs <= clockSync.refLocalUs) return;
+  int64_t span = best->localUs - clockSync.refLocalUs;
+  if (span >= SYNC_DRIFT_MIN_SPAN_US) {
+    float measured = (float)(best->offsetUs - clockSync.refOffsetUs) * 1e6f / (float)span;
+    if (fabsf(measured) <= SYNC_DRIFT_MAX_PPM) {
+      clockSync.driftPpm = clockSync.driftValid ? clockSync.driftPpm * 0.75f + measured * 0.25f : measured;
+      clockSync.driftValid = true;
+    }
+    clockSync.refLocalUs = best->localUs;
+    clockSync.refOffsetUs = best->offsetUs;
+  } else if (!clockSync.driftValid) {
+    // No drift yet: the better sample simply replaces the reference
+    clockSync.refLocalUs = best->localUs;
+    clockSync.refOffsetUs = best->offsetUs;
+  }
+}
+
+// ===================== SAFE UDP SEND =====================
+// Best-effort send through net_tx; false when the packet was dropped (no link
+// or netTxRing full)
+bool sendUDP(const uint8_t *data, size_t length) {
+  if (!netLinkUp()) return false;
+  return netEnqueue(netTxRing, NET_PACKET_DATA, data, length);
+}
+
+bool sendUDP(const String &msg) {
+  return sendUDP((const uint8_t*)msg.c_str(), msg.length());
+}
+
+// Send a "<TAG>:key=value,..." reply that may outgrow one datagram. Longer
+// replies are cut at field boundaries and each later part starts with
+// "<TAG>:device=<id>", so every datagram parses on its own. False if any part
+// was dropped.
+bool sendFieldReply(const String &reply) {
+  int total = reply.length();
+  if (total <= (int)NET_PACKET_MAX) return sendUDP(reply);
+
+  String prefix = reply.substring(0, reply.indexOf(':') + 1) + "device=" + String(deviceId);
+  bool ok = true;
+  int start = 0;  // Later parts start at the ',' that ends the previous one
+  while (start < total) {
+    int room = NET_PACKET_MAX - (start == 0 ? 0 : prefix.length());
+    int end = start + room >= total ? total : reply.lastIndexOf(',', start + room);
+    if (end <= start) return false;  // One field longer than a datagram
+    ok = sendUDP(start == 0 ? reply.substring(0, end) : prefix + reply.substring(start, end)) && ok;
+    start = end;
+  }
+  return ok;
+}
+
+// ===================== ALERT DELIVERY =====================
+// Each alert is queued with its sequence number (the binary frame seq or the
+// text alert_seq field) and sent at once. serviceAlerts() resends it after
+// 100, 200, 400, 800, 800ms until the Pi ACKs, then drops it as expired.
+// The Pi ACKs every copy and ignores repeated seqs. ACK latency (first send
+// to ACK dispatch) is tracked for STATUS.
+struct PendingAlert {
+  bool active;
+  uint8_t attempts;
+  uint16_t seq;
+  uint16_t length;
+  unsigned long firstSendMs;
+  unsigned long nextSendMs;
+  uint8_t payload[ALERT_PAYLOAD_MAX];
+};
+
+struct AlertStats {
+  uint32_t sent;          // Alerts queued and sent once
+  uint32_t retransmits;
+  uint32_t acked;
+  uint32_t expired;       // ALERT_MAX_ATTEMPTS sends without an ACK
+  uint32_t evicted;       // Pushed out of a full queue by a newer alert
+  uint32_t late;          // Acked after ALERT_LATENCY_BUDGET_MS
+  uint32_t latencySumMs;
+  uint32_t latencyMaxMs;
+};
+
+PendingAlert alertQueue[ALERT_QUEUE_SIZE];
+AlertStats alertStats = {};
+
+int alertsPending() {
+  int pending = 0;
+  for (int i = 0; i < ALERT_QUEUE_SIZE; i++) pending += alertQueue[i].active;
+  return pending;
+}
+
+// Queued ahead of best-effort telemetry; a copy lost in lwIP is covered by the retransmit
+void transmitAlert(PendingAlert &a, unsigned long now) {
+  bool sent = netLinkUp() && netEnqueue(netTxUrgent, NET_PACKET_DATA, a.payload, a.length);
+
+  if (a.attempts > 0) alertStats.retransmits++;
+  a.attempts++;
+  unsigned long timeout = min(ALERT_RETRY_MAX_MS, ALERT_RETRY_INITIAL_MS << (a.attempts - 1));
+  a.nextSendMs = now + timeout;
+
+  if (!sent) LOG_WARN("ALERT", "seq=%u send %u dropped (no link or queue full)", a.seq, a.attempts);
+}
+
+void queueAlert(uint16_t seq, const uint8_t *data, size_t length, unsigned long now) {
+  if (length > ALERT_PAYLOAD_MAX) {
+    LOG_ERROR("ALERT", "seq=%u is %u bytes (max %u), sent unreliably", seq, (unsigned)length,
+              (unsigned)ALERT_PAYLOAD_MAX);
+    sendUDP(data, length);
+    return;
+  }
+
+  // Free slot, else evict the oldest pending alert
+  PendingAlert *slot = &alertQueue[0];
+  for (int i = 0; i < ALERT_QUEUE_SIZE; i++) {
+    PendingAlert &a = alertQueue[i];
+    if (!a.active) {
+      slot = &a;
+      break;
+    }
+    if ((long)(a.firstSendMs - slot->firstSendMs) < 0) slot = &a;
+  }
+  if (slot->active) {
+    alertStats.evicted++;
+    LOG_WARN("ALERT", "Queue full, dropping unacknowledged seq=%u", slot->seq);
+  }
+
+  slot->active = true;
+  slot->attempts = 0;
+  slot->seq = seq;
+  slot->length = length;
+  slot->firstSendMs = now;
+  memcpy(slot->payload, data, length);
+  alertStats.sent++;
+  transmitAlert(*slot, now);
+}
+
+// Retransmit alerts whose ACK timeout has passed; expire after ALERT_MAX_ATTEMPTS
+void serviceAlerts(unsigned long now) {
+  for (int i = 0; i < ALERT_QUEUE_SIZE; i++) {
+    PendingAlert &a = alertQueue[i];
+    if (!a.active || (long)(now - a.nextSendMs) < 0) continue;
+
+    if (a.attempts >= ALERT_MAX_ATTEMPTS) {
+      a.active = false;
+      alertStats.expired++;
+      LOG_ERROR("ALERT", "seq=%u never acknowledged after %u sends", a.seq, a.attempts);
+      continue;
+    }
+    transmitAlert(a, now);
+  }
+}
+
+// ACK:<seq> from the Pi; repeated ACKs for a retransmitted alert are ignored
+void alertAcked(uint16_t seq, unsigned long now) {
+  for (int i = 0; i < ALERT_QUEUE_SIZE; i++) {
+    PendingAlert &a = alertQueue[i];
+    if (!a.active || a.seq != seq) continue;
+
+    uint32_t latency = now - a.firstSendMs;
+    a.active = false;
+    alertStats.acked++;
+    alertStats.latencySumMs += latency;
+    if (latency > alertStats.latencyMaxMs) alertStats.latencyMaxMs = latency;
+    if (latency > ALERT_LATENCY_BUDGET_MS) {
+      alertStats.late++;
+      LOG_WARN("ALERT", "seq=%u acked late: %ums after %u sends", seq, (unsigned)latency, a.attempts);
+    } else {
+      LOG_DEBUG("ALERT", "seq=%u acked in %ums (%u sends)", seq, (unsigned)latency, a.attempts);
+    }
+    return;
+  }
+}
+
+// ===================== BINARY TELEMETRY =====================
+// Little-endian layout, decoded on the Pi with struct '<BBBBHIHHHHHhhhhhhBBBBHHHBBHH'
+// followed by fsrCount x 'H', then '<I' (v4) and '<q' (v5). fsr1/fsr2/psi1/psi2 mirror pads 0 and FSR_LEGACY_CH2.
+// Motion codes are MotionType values: 0=None 1=Impact 2=Bounce 3=FreeFall 4=ViolentShake 5=Spinning 6=Rocking 7=Tremble
+struct __attribute__((packed)) TelemetryFrame {
+  uint8_t magic;          // TELEMETRY_MAGIC
+  uint8_t version;        // TELEMETRY_VERSION
+  uint8_t flags;          // TELEMETRY_FLAG_*
+  uint8_t gripState;      // GripState
+  uint16_t seq;           // Wraps at 65535
+  uint32_t timeMs;        // millis() at send
+  uint16_t fsr1Raw;
+  uint16_t fsr2Raw;
+  uint16_t psi1Centi;     // PSI * 100
+  uint16_t psi2Centi;
+  uint16_t psiMaxCenti;   // Aggregated for periodic frames, instant for alerts
+  int16_t ax, ay, az;
+  int16_t gx, gy, gz;
+  uint8_t motion;         // MotionType
+  uint8_t alertMotion;    // MotionType for MOTION_3X
+  uint8_t dominantType;   // GripState for PATTERN_3GRIP
+  uint8_t reserved;
+  uint16_t psiMinCenti;   // 5s window min (v2)
+  uint16_t psiPeakCenti;  // 5s window max (v2)
+  uint16_t psiStdCenti;   // 5s window standard deviation (v2)
+  uint8_t fsrCount;       // Pads in padPsiCenti (v3)
+  uint8_t maxChannel;     // Strongest pad (v3)
+  uint16_t psiSumCenti;   // Sum over pads (v3)
+  uint16_t centroid;      // Pressure-weighted pad index x256 (v3)
+  uint16_t padPsiCenti[FSR_CHANNEL_COUNT];  // Averaged PSI per pad (v3)
+  uint32_t deviceId;      // deviceIdNum, last 3 MAC bytes (v4)
+  int64_t syncTimeMs;     // Acquisition time of the reported sample, Pi Unix ms, 0 = not synced (v5)
+};
+static_assert(sizeof(TelemetryFrame) == 60 + 2 * FSR_CHANNEL_COUNT,
+              "TelemetryFrame layout is shared with the Pi decoder");
+
+void buildTelemetryFrame(TelemetryFrame &f, unsigned long now, unsigned long sampleMs, float psiMax,
+                         const PsiStats &stats, MotionType motion, MotionType alertMotion, uint8_t flags) {
+  f.magic = TELEMETRY_MAGIC;
+  f.version = TELEMETRY_VERSION;
+  f.flags = flags;
+  f.gripState = (uint8_t)currentGripState;
+  f.seq = telemetrySeq++;
+  f.timeMs = now;
+  f.fsr1Raw = latestSample.fsrRaw[0];
+  f.fsr2Raw = latestSample.fsrRaw[FSR_LEGACY_CH2];
+  f.psi1Centi = psiToCenti(channelPSI[0]);
+  f.psi2Centi = psiToCenti(channelPSI[FSR_LEGACY_CH2]);
+  f.psiMaxCenti = (uint16_t)(psiMax * 100.0f + 0.5f);
+  f.ax = latestSample.ax;
+  f.ay = latestSample.ay;
+  f.az = latestSample.az;
+  f.gx = latestSample.gx;
+  f.gy = latestSample.gy;
+  f.gz = latestSample.gz;
+  f.motion = motion;
+  f.alertMotion = (flags & TELEMETRY_FLAG_ALERT_MOTION) ? alertMotion : MOTION_NONE;
+  f.dominantType = (flags & TELEMETRY_FLAG_ALERT_PATTERN) ? (uint8_t)dominantGripType : 0;
+  f.reserved = 0;
+  f.psiMinCenti = (uint16_t)(stats.minPsi * 100.0f + 0.5f);
+  f.psiPeakCenti = (uint16_t)(stats.maxPsi * 100.0f + 0.5f);
+  f.psiStdCenti = (uint16_t)(stats.stddev * 100.0f + 0.5f);
+  f.fsrCount = FSR_CHANNEL_COUNT;
+  f.maxChannel = fsrFeatures.maxChannel;
+  f.psiSumCenti = psiToCenti(fsrFeatures.sumPsi);
+  f.centroid = fsrFeatures.centroid;
+  for (int c = 0; c < FSR_CHANNEL_COUNT; c++) f.padPsiCenti[c] = psiToCenti(channelPSI[c]);
+  f.deviceId = deviceIdNum;
+  f.syncTimeMs = syncTimeMs(sampleMs);
+}
+
+// ===================== CHANGE-ONLY REPORTING =====================
+// The ball keeps the last keyframe (a flagged TelemetryFrame) the Pi ACKed.
+// Each heartbeat is compared against it field by field: nothing outside the
+// deadbands -> a bare keepalive header, else a delta with only the changed
+// fields as zigzag varints (value - keyframe). Deltas never chain, so a lost
+// one costs nothing. Keyframes go out every REPORT_KEYFRAME_INTERVAL_MS, on
+// REPORT:KEY, and at every heartbeat until one is ACKed (a Pi that never
+// ACKs gets the old full heartbeats). Grip transitions go out at once as a
+// small event instead of waiting for the heartbeat.
+enum ReportKind : uint8_t {
+  REPORT_KEEPALIVE,   // Nothing changed since the keyframe
+  REPORT_DELTA,       // Changed fields follow the header
+  REPORT_GRIP_EVENT,  // ReportGripEvent follows the header
+};
+
+// Keyframe fields compared for deltas, in wire order (mirrored by the Pi)
+enum ReportField : uint8_t {
+  REPORT_FSR1_RAW,
+  REPORT_FSR2_RAW,
+  REPORT_PSI1,
+  REPORT_PSI2,
+  REPORT_PSI_MAX,
+  REPORT_AX, REPORT_AY, REPORT_AZ,
+  REPORT_GX, REPORT_GY, REPORT_GZ,
+  REPORT_MOTION,
+  REPORT_PSI_MIN,
+  REPORT_PSI_PEAK,
+  REPORT_PSI_STD,
+  REPORT_MAX_PAD,
+  REPORT_PSI_SUM,
+  REPORT_CENTROID,
+  REPORT_SQUEEZE,
+  REPORT_PADS,        // FSR_CHANNEL_COUNT pad PSI fields from here
+};
+const int REPORT_FIELD_COUNT = REPORT_PADS + FSR_CHANNEL_COUNT;
+static_assert(REPORT_FIELD_COUNT <= 32, "ReportFrame.changed is a 32-bit mask");
+
+// Changes up to this size (field units) are not reported: ADC noise, a ball
+// resting slightly off level, sensor jitter. Pads use the PSI deadband.
+const int32_t REPORT_DEADBAND[REPORT_PADS] = {
+  40, 40,             // fsr raw, ADC codes
+  10, 10, 10,         // psi1/psi2/psi_max, centi-PSI
+  512, 512, 512,      // accel, 1/32 g
+  256, 256, 256,      // gyro, ~2 deg/s
+  0,                  // motion
+  10, 10, 10,         // psi_min/peak/std
+  0,                  // max pad
+  10,                 // psi_sum
+  16,                 // centroid, 1/16 pad
+  0,                  // squeeze
+};
+const int32_t REPORT_PAD_DEADBAND = 10;
+
+struct __attribute__((packed)) ReportHeader {
+  uint8_t magic;      // REPORT_MAGIC
+  uint8_t version;    // REPORT_VERSION
+  uint8_t kind;       // ReportKind
+  uint8_t gripState;  // Current GripState, in every report
+  uint16_t seq;       // telemetrySeq, shared with full frames
+  uint32_t timeMs;    // millis() at send
+  uint32_t deviceId;  // deviceIdNum
+  uint16_t keySeq;    // Keyframe the delta is against
+  uint32_t changed;   // Bit per ReportField present (REPORT_DELTA)
+};
+static_assert(sizeof(ReportHeader) == 20, "ReportHeader layout is shared with the Pi decoder");
+
+struct __attribute__((packed)) ReportGripEvent {
+  uint8_t previousGrip;  // GripState before the transition
+  uint16_t psiCenti;     // Instant PSI at the transition
+  int64_t syncTimeMs;    // Transition time, Pi Unix ms, 0 = not synced
+};
+
+// Header + up to 5 varint bytes per field
+const size_t REPORT_FRAME_MAX = sizeof(ReportHeader) + REPORT_FIELD_COUNT * 5;
+
+struct ReportState {
+  bool keyValid;                             // Pi ACKed a keyframe
+  uint16_t keySeq;
+  unsigned long keyMs;                       // When the ACKed keyframe was sent
+  int32_t key[REPORT_FIELD_COUNT];
+  bool pendingValid;                         // Keyframe sent, ACK not seen yet
+  uint16_t pendingSeq;
+  unsigned long pendingMs;
+  int32_t pending[REPORT_FIELD_COUNT];
+  bool keyRequested;                         // REPORT:KEY
+  // Grip transition waiting for sendUDP() (TX ring full or link down)
+  bool gripPending;
+  GripState gripPrevious;
+  psi_t gripPsi;
+  unsigned long gripMs;
+  // STATUS counters
+  uint32_t keyframes;
+  uint32_t deltas;
+  uint32_t keepalives;
+  uint32_t gripEvents;
+  uint32_t bytesSaved;                       // Versus a full frame per heartbeat
+};
+ReportState reportState = {};
+
+bool reportDeltaActive() {
+  return binaryTelemetry && firmwareConfig.reportDelta;
+}
+
+void reportFieldsFromFrame(const TelemetryFrame &f, int32_t v[REPORT_FIELD_COUNT]) {
+  v[REPORT_FSR1_RAW] = f.fsr1Raw;
+  v[REPORT_FSR2_RAW] = f.fsr2Raw;
+  v[REPORT_PSI1] = f.psi1Centi;
+  v[REPORT_PSI2] = f.psi2Centi;
+  v[REPORT_PSI_MAX] = f.psiMaxCenti;
+  v[REPORT_AX] = f.ax;
+  v[REPORT_AY] = f.ay;
+  v[REPORT_AZ] = f.az;
+  v[REPORT_GX] = f.gx;
+  v[REPORT_GY] = f.gy;
+  v[REPORT_GZ] = f.gz;
+  v[REPORT_MOTION] = f.motion;
+  v[REPORT_PSI_MIN] = f.psiMinCenti;
+  v[REPORT_PSI_PEAK] = f.psiPeakCenti;
+  v[REPORT_PSI_STD] = f.psiStdCenti;
+  v[REPORT_MAX_PAD] = f.maxChannel;
+  v[REPORT_PSI_SUM] = f.psiSumCenti;
+  v[REPORT_CENTROID] = f.centroid;
+  v[REPORT_SQUEEZE] = (f.flags & TELEMETRY_FLAG_SQUEEZE) ? 1 : 0;
+  for (int c = 0; c < FSR_CHANNEL_COUNT; c++) v[REPORT_PADS + c] = f.padPsiCenti[c];
+}
+
+// Zigzag LEB128: small deltas of either sign take one byte
+size_t putZigzagVarint(uint8_t *out, int32_t value) {
+  uint32_t z = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+  size_t n = 0;
+  while (z >= 0x80) {
+    out[n++] = (uint8_t)(z | 0x80);
+    z >>= 7;
+  }
+  out[n++] = (uint8_t)z;
+  return n;
+}
+
+void fillReportHeader(ReportHeader &h, ReportKind kind, uint16_t seq, unsigned long now) {
+  h.magic = REPORT_MAGIC;
+  h.version = REPORT_VERSION;
+  h.kind = kind;
+  h.gripState = (uint8_t)currentGripState;
+  h.seq = seq;
+  h.timeMs = now;
+  h.deviceId = deviceIdNum;
+  h.keySeq = reportState.keySeq;
+  h.changed = 0;
+}
+
+// Send one periodic heartbeat: keyframe, delta or keepalive. Returns the kind
+// for logging ("key" when the full frame went out).
+const char* sendReport(TelemetryFrame &frame, unsigned long now) {
+  ReportState &rs = reportState;
+  int32_t v[REPORT_FIELD_COUNT];
+  reportFieldsFromFrame(frame, v);
+
+  bool keyDue = !rs.keyValid || rs.keyRequested || now - rs.keyMs >= REPORT_KEYFRAME_INTERVAL_MS;
+  if (keyDue) {
+    frame.flags |= TELEMETRY_FLAG_KEYFRAME;
+    if (sendUDP((const uint8_t*)&frame, sizeof(frame))) {
+      memcpy(rs.pending, v, sizeof(rs.pending));
+      rs.pendingSeq = frame.seq;
+      rs.pendingMs = now;
+      rs.pendingValid = true;
+      rs.keyRequested = false;
+      rs.keyframes++;
+    }
+    return "key";
+  }
+
+  uint8_t packet[REPORT_FRAME_MAX];
+  ReportHeader h;
+  size_t length = sizeof(h);
+  fillReportHeader(h, REPORT_KEEPALIVE, frame.seq, now);
+  for (int i = 0; i < REPORT_FIELD_COUNT; i++) {
+    int32_t delta = v[i] - rs.key[i];
+    int32_t deadband = i < REPORT_PADS ? REPORT_DEADBAND[i] : REPORT_PAD_DEADBAND;
+    if (abs(delta) <= deadband) continue;
+    h.changed |= 1UL << i;
+    length += putZigzagVarint(packet + length, delta);
+  }
+  if (h.changed) h.kind = REPORT_DELTA;
+  memcpy(packet, &h, sizeof(h));
+
+  if (sendUDP(packet, length)) {
+    if (h.changed) rs.deltas++;
+    else rs.keepalives++;
+    rs.bytesSaved += sizeof(frame) - length;
+  }
+  return h.changed ? "delta" : "keepalive";
+}
+
+// ACK:<seq> for the pending keyframe makes it the new reference
+void reportKeyAcked(uint16_t seq) {
+  ReportState &rs = reportState;
+  if (!rs.pendingValid || rs.pendingSeq != seq) return;
+  memcpy(rs.key, rs.pending, sizeof(rs.key));
+  rs.keySeq = seq;
+  rs.keyMs = rs.pendingMs;
+  rs.keyValid = true;
+  rs.pendingValid = false;
+  LOG_DEBUG("REPORT", "Keyframe seq=%u acknowledged", seq);
+}
+
+// Called from processSample() on every grip transition; the first previous
+// state is kept if several transitions land before the event goes out
+void reportGripChange(GripState previous, psi_t psi, unsigned long sampleMs) {
+  ReportState &rs = reportState;
+  if (!rs.gripPending) rs.gripPrevious = previous;
+  rs.gripPending = true;
+  rs.gripPsi = psi;
+  rs.gripMs = sampleMs;
+}
 
-  // ----- 4) SEND SENSOR EVENT -----
+// Push a pending grip transition; retried on the next pass if sendUDP() drops it
+void serviceGripEvent(unsigned long now) {
+  ReportState &rs = reportState;
+  if (!rs.gripPending || !netLinkUp()) return;
+
+  bool sent;
+  int64_t ts = syncTimeMs(rs.gripMs);
+  if (binaryTelemetry) {
+    uint8_t packet[sizeof(ReportHeader) + sizeof(ReportGripEvent)];
+    ReportHeader h;
+    fillReportHeader(h, REPORT_GRIP_EVENT, telemetrySeq, now);
+    ReportGripEvent e;
+    e.previousGrip = (uint8_t)rs.gripPrevious;
+    e.psiCenti = psiToCenti(rs.gripPsi);
+    e.syncTimeMs = ts;
+    memcpy(packet, &h, sizeof(h));
+    memcpy(packet + sizeof(h), &e, sizeof(e));
+    sent = sendUDP(packet, sizeof(packet));
+  } else {
+    String msg = "device:" + String(deviceId) + ",seq:" + String(telemetrySeq) + ",time:" + String(now);
+    if (ts != 0) msg += ",ts:" + int64ToString(ts);
+    msg += ",event:grip,grip_state:";
+    msg += gripStateToString(currentGripState);
+    msg += ",previous_grip:";
+    msg += gripStateToString(rs.gripPrevious);
+    msg += ",psi_max:" + String(psiToFloat(rs.gripPsi), 2);
+    sent = sendUDP(msg);
+  }
+  if (!sent) return;
+
+  telemetrySeq++;
+  rs.gripPending = false;
+  rs.gripEvents++;
+  LOG_DEBUG("REPORT", "Grip event %s -> %s", gripStateToString(rs.gripPrevious), gripStateToString(currentGripState));
+}
+
+// ===================== RAW IMU STREAMING =====================
+// Every Nth fixed-rate sample is appended to imuBatch; serviceImuStream()
+// ships full (or stale) batches as one datagram. Sends are paced by
+// imuStreamGapMs, which doubles when netTxRing is full or lwIP refuses a batch (the old "mbox
+// crash") and recovers on success. Samples that arrive while the batch is
+// full and waiting are counted in imuStreamLost.
+
+void startImuStream(uint32_t hz) {
+  // Raise the acquisition rate if the stream needs more samples than we take
+  if (hz > samplingRateHz) {
+    if (imuStreamRestoreRateHz == 0) imuStreamRestoreRateHz = samplingRateHz;
+    setSamplingRate(hz);
+  }
+
+  imuStreamRateHz = hz;
+  updateImuStreamDecimation();
+  imuStreamIndex = 0;
+  imuStreamLost = 0;
+  imuStreamGapMs = IMU_STREAM_MIN_GAP_MS;
+  imuBatch.header.count = 0;
+  imuStreamLastSend = millis();
+  imuStreamActive = true;
+
+  LOG_INFO("STREAM", "IMU streaming at %u Hz", (unsigned)(samplingRateHz / imuStreamDecimation));
+}
+
+// Keep every Nth sample so the stream stays at imuStreamRateHz across RATE
+// changes; below that rate every sample is streamed
+void updateImuStreamDecimation() {
+  if (imuStreamRateHz == 0) return;
+  imuStreamDecimation = max(samplingRateHz / imuStreamRateHz, (uint32_t)1);
+  imuStreamDecimationCount = 0;
+}
+
+void stopImuStream() {
+  imuStreamActive = false;
+  if (imuStreamRestoreRateHz != 0) {
+    setSamplingRate(imuStreamRestoreRateHz);
+    imuStreamRestoreRateHz = 0;
+  }
+  LOG_INFO("STREAM", "IMU streaming stopped, lost samples: %u", (unsigned)imuStreamLost);
+}
+
+void streamImuSample(const SensorSample &s) {
+  if (!imuStreamActive) return;
+  if (++imuStreamDecimationCount < imuStreamDecimation) return;
+  imuStreamDecimationCount = 0;
+
+  uint32_t index = imuStreamIndex++;
+  ImuBatchHeader &h = imuBatch.header;
+  if (h.count >= IMU_STREAM_BATCH_MAX) {
+    imuStreamLost++;
+    return;
+  }
+
+  if (h.count == 0) {
+    h.firstIndex = index;
+    h.firstTimeMs = s.timeMs;
+  }
+
+  ImuBatchSample &out = imuBatch.samples[h.count++];
+  out.dtMs = (uint16_t)(s.timeMs - h.firstTimeMs);
+  out.ax = s.ax;
+  out.ay = s.ay;
+  out.az = s.az;
+  out.gx = s.gx;
+  out.gy = s.gy;
+  out.gz = s.gz;
+}
+
+void serviceImuStream(unsigned long now) {
+  ImuBatchHeader &h = imuBatch.header;
+  if (!imuStreamActive || h.count == 0) return;
+
+  bool full = (h.count >= IMU_STREAM_BATCH_MAX);
+  bool stale = (now - imuStreamLastSend >= IMU_STREAM_FLUSH_MS);
+  if (!full && !stale) return;
+  if (now - imuStreamLastSend < imuStreamGapMs) return;
+
+  h.magic = IMU_STREAM_MAGIC;
+  h.version = IMU_STREAM_VERSION;
+  h.batchSeq = imuStreamBatchSeq++;
+  h.rateHz = samplingRateHz / imuStreamDecimation;
+  h.lostSamples = imuStreamLost;
+  h.firstSyncMs = syncTimeMs(h.firstTimeMs);
+
+  size_t length = sizeof(ImuBatchHeader) + h.count * sizeof(ImuBatchSample);
+  imuStreamLastSend = now;
+
+  // Back off when the ring is full or net_tx saw lwIP refuse an earlier batch
+  static uint32_t refusedSeen = 0;
+  uint32_t refused = netTxImuRefused;
+  bool sent = netLinkUp() && netEnqueue(netTxRing, NET_PACKET_IMU, (const uint8_t*)&imuBatch, length) &&
+              refused == refusedSeen;
+  refusedSeen = refused;
+  if (sent) {
+    imuStreamGapMs = max(IMU_STREAM_MIN_GAP_MS, imuStreamGapMs / 2);
+  } else {
+    imuStreamLost += h.count;
+    imuStreamGapMs = min(IMU_STREAM_MAX_GAP_MS, imuStreamGapMs * 2);
+  }
+  h.count = 0;
+}
+
+// ===================== BLE ADVERTISING SCHEDULER =====================
+// FAST while the Pi needs fresh RSSI (BLE:FAST or a distress event), SLOW
+// while idle, NORMAL otherwise. Restarts are driven by GAP completion events,
+// and the coexistence preference follows the radio's current priority.
+
+// Stretch the FAST window; overlapping requests extend it. Called from the
+// detect task, so it only posts the request for the io task's scheduler.
+void bleAdvBoost(unsigned long now, unsigned long durationMs) {
+  bleBoostRequestUntilMs = now + durationMs;
+  bleBoostRequestSeq++;
+  notifyTask(TASK_IO);
+}
+
+BleAdvLevel desiredBleAdvLevel(unsigned long now) {
+  static uint32_t seenSeq = 0;
+  if (bleBoostRequestSeq != seenSeq) {
+    seenSeq = bleBoostRequestSeq;
+    unsigned long until = bleBoostRequestUntilMs;
+    if (bleFastUntilMs == 0 || (long)(until - bleFastUntilMs) > 0) bleFastUntilMs = until;
+  }
+
+  if (bleFastUntilMs != 0) {
+    if ((long)(bleFastUntilMs - now) > 0) return BLE_ADV_FAST;
+    bleFastUntilMs = 0;
+  }
+  return powerMode == POWER_IDLE ? BLE_ADV_SLOW : BLE_ADV_NORMAL;
+}
+
+// WiFi wins while raw IMU batches stream, BLE while fast advertising for RSSI
+void updateCoexPreference(BleAdvLevel level) {
+  static int current = -1;
+  esp_coex_prefer_t wanted = imuStreamActive ? ESP_COEX_PREFER_WIFI
+                           : (level == BLE_ADV_FAST ? ESP_COEX_PREFER_BT : ESP_COEX_PREFER_BALANCE);
+  if (wanted == current) return;
+  esp_coex_preference_set(wanted);
+  current = wanted;
+}
+
+void applyBleAdvLevel(BleAdvLevel level, unsigned long now) {
+  pAdvertising->stop();
+  pAdvertising->setMinInterval(BLE_ADV_INTERVALS[level][0]);
+  pAdvertising->setMaxInterval(BLE_ADV_INTERVALS[level][1]);
+  pAdvertising->start();
+  bleAdvLevel = level;
+  bleAdvRequestMs = now;
+
+  LOG_INFO("BLE", "Advertising %s", bleAdvLevelToString(level));
+}
+
+void serviceBleScheduler(unsigned long now) {
+  if (bootStages[BOOT_BLE].state == BOOT_PENDING) return;  // radioBootTask still owns BLE
+
+  if (pAdvertising == nullptr) {
+    // Critical: pAdvertising is null, reinitialize BLE
+    LOG_WARN("BLE", "WARNING: pAdvertising is NULL! Reinitializing...");
+    setupBLE();
+    return;
+  }
+
+  BleAdvLevel level = desiredBleAdvLevel(now);
+  updateCoexPreference(level);
+
+  if (level != bleAdvLevel) {
+    applyBleAdvLevel(level, now);
+  } else if (!bleAdvRunning && now - bleAdvRequestMs > BLE_ADV_HEALTH_TIMEOUT_MS) {
+    // Controller never confirmed start (or reported a stop) - restart once per timeout
+    bleAdvRestarts++;
+    LOG_WARN("BLE", "Advertising not running - restarting");
+    applyBleAdvLevel(level, now);
+  }
+}
+
+// ===================== POWER MANAGEMENT =====================
+// ACTIVE -> IDLE after IDLE_TIMEOUT_MS without grip, motion, audio or streaming.
+// Idle drops the sample rate and CPU clock (the BLE scheduler drops to SLOW); the
+// MPU6050 motion interrupt or FSR contact (checked in samplingTask) wakes the detect task.
+
+const char* wakeSourceToString(uint8_t source) {
+  switch (source) {
+    case WAKE_MOTION:  return "motion";
+    case WAKE_GRIP:    return "grip";
+    case WAKE_COMMAND: return "command";
+    default:           return "activity";
+  }
+}
+
+void enterIdleMode() {
+  powerRestoreRateHz = samplingRateHz;
+  powerWakeSource = WAKE_NONE;
+  powerMode = POWER_IDLE;            // configureMpuFifo() arms the motion INT
+  setSamplingRate(IDLE_SAMPLE_RATE_HZ);
+
+  // Modem sleep only applies while the radio is a station; the softAP keeps
+  // beaconing, so in AP mode this is a no-op and the CPU clock is the main saving
+  esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+  setCpuFrequencyMhz(IDLE_CPU_FREQ_MHZ);
+  profCpuMhz = getCpuFrequencyMhz();
+
+  LOG_INFO("POWER", "Idle: %u Hz sampling, %u MHz CPU, BLE 1s interval",
+           (unsigned)IDLE_SAMPLE_RATE_HZ, (unsigned)IDLE_CPU_FREQ_MHZ);
+}
+
+void exitIdleMode(unsigned long now) {
+  uint8_t source = powerWakeSource;
+  setCpuFrequencyMhz(ACTIVE_CPU_FREQ_MHZ);
+  profCpuMhz = getCpuFrequencyMhz();
+  esp_wifi_set_ps(netActivePowerSave());
+
+  powerMode = POWER_ACTIVE;
+  setSamplingRate(powerRestoreRateHz);
+  powerWakeSource = WAKE_NONE;
+  lastActivityMs = now;
+
+  LOG_INFO("POWER", "Active (wake: %s, idle %lus)", wakeSourceToString(source), (now - powerIdleSinceMs) / 1000);
+}
+
+void updatePowerMode(unsigned long now) {
+  if (powerMode == POWER_IDLE) {
+    if (powerWakeSource != WAKE_NONE || now - lastActivityMs < IDLE_TIMEOUT_MS) {
+      exitIdleMode(now);
+    }
+    return;
+  }
+
+  bool busy = currentGripState != GRIP_NONE || alarmPlaying || audioQueueCount > 0 || audioRing.count() > 0 || imuStreamActive;
+  if (busy) {
+    lastActivityMs = now;
+  } else if (now - lastActivityMs >= IDLE_TIMEOUT_MS) {
+    powerIdleSinceMs = now;
+    enterIdleMode();
+  }
+}
+
+// ===================== STAGED BOOT =====================
+// Sensors and sampling start in setup(), so detection runs within a few
+// hundred ms of reset (brown-out reboots included). The slow peripherals come
+// up in parallel on the protocol core and flip their bootStages[] entry when
+// done; until then sendUDP() drops packets, DFPlayer steps stay queued and the
+// BLE scheduler leaves the radio alone. Every wait polls a readiness signal
+// instead of sleeping a fixed time.
+
+const char* BOOT_STAGE_NAMES[BOOT_STAGE_COUNT] = { "wifi", "ble", "dfplayer" };
+
+const char* resetReasonToString(esp_reset_reason_t reason) {
+  switch (reason) {
+    case ESP_RST_POWERON:   return "poweron";
+    case ESP_RST_EXT:       return "ext";
+    case ESP_RST_SW:        return "sw";
+    case ESP_RST_PANIC:     return "panic";
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:       return "wdt";
+    case ESP_RST_DEEPSLEEP: return "deepsleep";
+    case ESP_RST_BROWNOUT:  return "brownout";
+    default:                return "unknown";
+  }
+}
+
+void bootStageDone(BootStage stage, bool ok) {
+  bootStages[stage].readyMs = millis();
+  bootStages[stage].state = ok ? BOOT_READY : BOOT_FAILED;
+
+  if (ok) {
+    LOG_INFO("BOOT", "%s ready at %lums", BOOT_STAGE_NAMES[stage], (unsigned long)bootStages[stage].readyMs);
+  } else {
+    LOG_ERROR("BOOT", "%s FAILED at %lums", BOOT_STAGE_NAMES[stage], (unsigned long)bootStages[stage].readyMs);
+  }
+}
+
+// STATUS value: ms since app start, or pending/fail
+String bootStageField(BootStage stage) {
+  switch (bootStages[stage].state) {
+    case BOOT_READY:  return String(bootStages[stage].readyMs);
+    case BOOT_FAILED: return "fail";
+    default:          return "pending";
+  }
+}
+
+// ===================== RECEIVE COMMANDS FROM PI =====================
+// commandReceiverTask blocks on the command socket, parses each datagram into
+// a PiCommand record and pushes it into commandRing. The detect task pops and
+// dispatches every pending command through the PI_COMMANDS table.
+
+// Command handlers (run from the detect task only)
+void cmdPlayStop(const PiCommand &c) {
+  clearAudioQueue();
+  enqueueAudioStep(AUDIO_OP_STOP, 0, 0);
+  isPlaying = false;
+  alarmPlaying = false;  // Clear alarm flag if stopped
+}
+
+void cmdPlay(const PiCommand &c) {
+  int track = c.intArg;
+  clearAudioQueue();
+  enqueueAudioStep(AUDIO_OP_STOP, 0, AUDIO_STOP_SETTLE_MS);  // HARD stop, then let DFPlayer flush
+
+  // Track 14 is "Find My Device" alarm - play at MAX volume
+  if (track == 14) {
+    LOG_INFO("ALARM", "Find My Device activated - MAX VOLUME");
+    enqueueAudioStep(AUDIO_OP_VOLUME, 30, AUDIO_LATCH_SETTLE_MS);  // Set to max volume
+    enqueueAudioStep(AUDIO_OP_PLAY, track, 0);
+    alarmPlaying = true;
+    alarmStartTime = millis();
+    LOG_INFO("ALARM", "Will restore volume to %d after %lu seconds", currentVolume, ALARM_DURATION / 1000);
+  } else {
+    // Normal track - use configured volume
+    enqueueAudioStep(AUDIO_OP_PLAY, track, 0);
+    enqueueAudioStep(AUDIO_OP_VOLUME, currentVolume, 0);
+  }
+
+  isPlaying = true;
+  LOG_INFO("AUDIO", "Switched to track %d", track);
+}
+
+void cmdVolume(const PiCommand &c) {
+  currentVolume = constrain(c.intArg, 0, 30);
+
+  enqueueAudioStep(AUDIO_OP_VOLUME, currentVolume, 0);
+
+  LOG_INFO("AUDIO", "Volume set to %d", currentVolume);
+}
+
+void cmdDebugOn(const PiCommand &c) {
+  logLevel = LOG_LEVEL_DEBUG;
+  LOG_INFO("DEBUG", "Motion debug ENABLED");
+}
+
+void cmdDebugOff(const PiCommand &c) {
+  logLevel = LOG_LEVEL_INFO;
+  LOG_INFO("DEBUG", "Motion debug DISABLED");
+}
+
+void cmdDebugVerbose(const PiCommand &c) {
+  logLevel = LOG_LEVEL_VERBOSE;  // Set outright like DEBUG:ON/OFF; DEBUG:ON returns to debug
+  LOG_INFO("DEBUG", "Verbose mode ENABLED");
+}
+
+bool isSupportedSampleRate(int hz) {
+  return hz == 50 || hz == 100 || hz == 200 || hz == 500;
+}
+
+void cmdRate(const PiCommand &c) {
+  if (isSupportedSampleRate(c.intArg)) {
+    setSamplingRate(c.intArg);
+  } else {
+    LOG_WARN("SAMPLING", "Unsupported rate. Use 50, 100, 200 or 500");
+  }
+}
+
+void cmdCalibrate(const PiCommand &c) {
+  float rFixed = c.floatArgs[0];
+  float area = c.floatArgs[1];
+  float exponent = c.floatArgs[2];
+
+  // Same ranges loadConfig() applies, so a value saved here survives the next boot
+  const char *keys[3] = { "fsr_r_fixed", "fsr_area_mm2", "fsr_exponent" };
+  for (int i = 0; i < 3; i++) {
+    const ConfigEntry *e = findConfig(keys[i]);
+    float v = c.floatArgs[i];
+    if (!(v >= e->minValue && v <= e->maxValue)) {
+      LOG_WARN("FSR", "Invalid calibration: %s=%g (range %g..%g). Use CAL:<r_fixed>,<area_mm2>,<exponent>",
+               e->key, v, e->minValue, e->maxValue);
+      sendUDP("CAL:ERR:range " + String(e->key) + " " + String(e->minValue, 3) + ".." + String(e->maxValue, 3));
+      return;
+    }
+  }
+
+  setFsrCalibration(rFixed, area, exponent);
+  saveFsrCalibration();
+}
+
+// CAL:REF:<psi> - start averaging; serviceCalRef() finishes the fit
+void cmdCalibrateRef(const PiCommand &c) {
+  char *end;
+  float refPsi = strtof(c.argText, &end);
+  if (end == c.argText || *end != '\0' || refPsi <= 0 || refPsi > 30) {
+    LOG_WARN("FSR", "Invalid reference. Use CAL:REF:<psi> (0-30)");
+    sendUDP(String("CAL:ERR:usage CAL:REF:<psi>"));
+    return;
+  }
+
+  calRef = {};
+  calRef.active = true;
+  calRef.refPsi = refPsi;
+  calRef.endMs = millis() + CAL_REF_DURATION_MS;
+  LOG_INFO("FSR", "Reference calibration: hold %.2f psi on one pad for %lums", refPsi, CAL_REF_DURATION_MS);
+}
+
+void calRefAddSample(const SensorSample &s) {
+  uint16_t strongest = 0;
+  for (int c = 0; c < FSR_CHANNEL_COUNT; c++) {
+    if (s.fsrRaw[c] > strongest) strongest = s.fsrRaw[c];
+  }
+  calRef.sum += strongest;
+  calRef.count++;
+}
+
+// Fit, apply and persist once the averaging window has elapsed
+void serviceCalRef(unsigned long now) {
+  if (!calRef.active || (long)(now - calRef.endMs) < 0) return;
+  calRef.active = false;
+
+  int code = calRef.count ? (calRef.sum + calRef.count / 2) / calRef.count : 0;
+  float area = fitFsrArea(code, calRef.refPsi, fsrCalibration);
+  const ConfigEntry *areaEntry = findConfig("fsr_area_mm2");
+  if (calRef.count == 0 || !(area >= areaEntry->minValue && area <= areaEntry->maxValue)) {
+    LOG_WARN("FSR", "Reference calibration failed: adc=%d over %u samples", code, (unsigned)calRef.count);
+    sendUDP("CAL:ERR:adc=" + String(code) + ",samples=" + String(calRef.count));
+    return;
+  }
+
+  setFsrCalibration(fsrCalibration.rFixed, area, fsrCalibration.exponent);
+  saveFsrCalibration();
+  sendUDP("CAL:fsr_area_mm2=" + String(area, 3) + ",adc=" + String(code) + ",samples=" + String(calRef.count));
+}
+
+// CFG:<key>=<value>,... for every registry entry
+void cmdConfigGetAll(const PiCommand &c) {
+  String reply = "CFG:";
+  char value[16];
+  for (int i = 0; i < configEntryCount(); i++) {
+    const ConfigEntry &e = configEntryAt(i);
+    formatConfigValue(e, value, sizeof(value));
+    if (i > 0) reply += ",";
+    reply += e.key;
+    reply += "=";
+    reply += value;
+  }
+  sendUDP(reply);
+}
+
+void sendConfigValue(const ConfigEntry &e) {
+  char value[16];
+  formatConfigValue(e, value, sizeof(value));
+  sendUDP("CFG:" + String(e.key) + "=" + value);
+}
+
+void cmdConfigGet(const PiCommand &c) {
+  const ConfigEntry *e = findConfig(c.argText);
+  if (!e) {
+    sendUDP("CFG:ERR:unknown " + String(c.argText));
+    return;
+  }
+  sendConfigValue(*e);
+}
+
+// CFG:SET:<key>=<value> - validate, apply to the live config, persist
+void cmdConfigSet(const PiCommand &c) {
+  char arg[sizeof(c.argText)];
+  strcpy(arg, c.argText);
+  char *eq = strchr(arg, '=');
+  if (!eq) {
+    sendUDP(String("CFG:ERR:usage CFG:SET:<key>=<value>"));
+    return;
+  }
+  *eq = '\0';
+
+  const ConfigEntry *e = findConfig(arg);
+  if (!e) {
+    sendUDP("CFG:ERR:unknown " + String(arg));
+    return;
+  }
+  uint32_t previous;
+  memcpy(&previous, e->value, sizeof(previous));  // Every entry type is 4 bytes
+  if (!parseConfigValue(*e, eq + 1)) {
+    LOG_WARN("CFG", "Rejected %s=%s (range %g..%g)", e->key, eq + 1, e->minValue, e->maxValue);
+    sendUDP("CFG:ERR:range " + String(e->key) + " " + String(e->minValue, 3) + ".." + String(e->maxValue, 3));
+    return;
+  }
+  const char *orderError = detectionConfigOrderError();
+  if (orderError) {
+    memcpy(e->value, &previous, sizeof(previous));
+    LOG_WARN("CFG", "Rejected %s=%s (needs %s)", e->key, eq + 1, orderError);
+    sendUDP("CFG:ERR:order " + String(e->key) + " " + String(orderError));
+    return;
+  }
+
+  if (e->fsrCurve) rebuildPSITable();
+  else applyDetectionConfig();
+  saveConfigEntry(*e);
+  LOG_INFO("CFG", "%s set to %s", e->key, eq + 1);
+  sendConfigValue(*e);
+}
+
+// ACK:<seq> answers both alerts and keyframes (they share telemetrySeq)
+void cmdAlertAck(const PiCommand &c) {
+  alertAcked((uint16_t)c.intArg, millis());
+  reportKeyAcked((uint16_t)c.intArg);
+}
+
+void cmdConfigReset(const PiCommand &c) {
+  resetConfig();
+  LOG_INFO("CFG", "All settings reset to defaults");
+  sendUDP(String("CFG:RESET"));
+}
+
+void cmdFormatBin(const PiCommand &c) {
+  binaryTelemetry = true;
+  LOG_INFO("UDP", "Telemetry format: BINARY");
+}
+
+void cmdFormatText(const PiCommand &c) {
+  binaryTelemetry = false;
+  LOG_INFO("UDP", "Telemetry format: TEXT");
+}
+
+void cmdStreamImu(const PiCommand &c) {
+  // STREAM:IMU:200HZ - rate must be a supported sampling rate
+  if (isSupportedSampleRate(c.intArg)) {
+    startImuStream(c.intArg);
+  } else {
+    LOG_WARN("STREAM", "Unsupported rate. Use STREAM:IMU:50HZ/100HZ/200HZ/500HZ");
+  }
+}
+
+void cmdStreamOff(const PiCommand &c) {
+  stopImuStream();
+}
+
+void cmdBleFast(const PiCommand &c) {
+  bleAdvBoost(millis(), BLE_FAST_BOOST_MS);
+  LOG_INFO("BLE", "Fast advertising for %lus", BLE_FAST_BOOST_MS / 1000);
+}
+
+void cmdStatus(const PiCommand &c) {
+  // Send back current status
+  String status = "STATUS:device=" + String(deviceId);
+  status += ",seq=" + String(telemetrySeq);
+  status += ",net=" + String(netModeToString(netMode));
+  status += ",net_link=" + String(netLinkUp() ? "up" : "down");
+  if (netMode == NET_MODE_STA) {
+    status += ",ip=" + WiFi.localIP().toString();
+    status += ",hub=" + netPeerIP().toString();
+    status += ",wifi_rssi=" + String(WiFi.RSSI());
+  }
+  status += ",debug=";
+  status += logLevel >= LOG_LEVEL_VERBOSE ? "verbose" : (logLevel >= LOG_LEVEL_DEBUG ? "on" : "off");
+  status += ",grip=";
+  status += gripStateToString(currentGripState);
+  status += ",psi=" + String(psiToFloat(fsrFeatures.maxPsi), 2);
+  status += ",pads=" + String(FSR_CHANNEL_COUNT);
+  status += ",engine=" + String(engineToString((DetectionEngine)detectionConfig.engine));
+  status += ",model_inferences=" + String(modelStats.inferences);
+  status += ",model_infer_us=" + String(modelStats.lastTicks / profCpuMhz);
+  status += ",model_infer_avg_us=" +
+            String(modelStats.inferences ? (uint32_t)(modelStats.totalTicks / modelStats.inferences / profCpuMhz) : 0);
+  status += ",model_infer_max_us=" + String(modelStats.maxTicks / profCpuMhz);
+  status += ",model_arena=" + String((unsigned)MODEL_ARENA_USED) + "/" + String((unsigned)MODEL_ARENA_BYTES);
+  status += ",fsr_cal=" + String(fsrCalibration.rFixed, 0) + "/" + String(fsrCalibration.areaMm2, 3) + "/" +
+            String(fsrCalibration.exponent, 3);
+  status += ",ble_tx_power=" + String(firmwareConfig.bleTxPower);
+  PsiStats psiStats;
+  getPsiWindowStats(sampleNowMs, psiStats);
+  status += ",psi_avg=" + String(psiStats.mean, 2);
+  status += ",psi_min=" + String(psiStats.minPsi, 2);
+  status += ",psi_peak=" + String(psiStats.maxPsi, 2);
+  status += ",psi_std=" + String(psiStats.stddev, 2);
+  status += ",ble=" + String(bleAdvRunning ? bleAdvLevelToString(bleAdvLevel) : "down");
+  status += ",ble_restarts=" + String(bleAdvRestarts);
+  status += ",ble_start_fail=" + String(bleAdvStartFailures);
+  status += ",power=" + String(powerMode == POWER_IDLE ? "idle" : "active");
+  status += ",format=" + String(binaryTelemetry ? "bin" : "text");
+  status += ",report=" + String(reportDeltaActive() ? "delta" : "full");
+  if (reportState.keyValid) {
+    status += ",report_key_seq=" + String(reportState.keySeq);
+    status += ",report_key_age_ms=" + String(millis() - reportState.keyMs);
+  }
+  status += ",report_keyframes=" + String(reportState.keyframes);
+  status += ",report_deltas=" + String(reportState.deltas);
+  status += ",report_keepalives=" + String(reportState.keepalives);
+  status += ",report_grip_events=" + String(reportState.gripEvents);
+  status += ",report_bytes_saved=" + String(reportState.bytesSaved);
+  status += ",rate=" + String(samplingRateHz);
+  status += ",drops=" + String(sampleRing.drops);
+  status += ",missed=" + String(samplingMissedSamples);
+  status += ",fifo_overflows=" + String(mpuFifoOverflows);
+  status += ",adc=" + String(adcDmaActive ? "dma" : "poll");
+  status += ",adc_overruns=" + String(adcDmaOverruns);
+  status += ",stream=" + (imuStreamActive ? String(samplingRateHz / imuStreamDecimation) + "hz" : String("off"));
+  status += ",stream_lost=" + String(imuStreamLost);
+  status += ",cmd_drops=" + String(commandRing.drops);
+  status += ",net_tx_sent=" + String(netTxSent);
+  status += ",net_tx_refused=" + String(netTxRefused);
+  status += ",net_tx_drops=" + String(netTxRing.drops + netTxUrgent.drops + netTxOversize);
+  status += ",task_stack_min=" + String(taskStackMinFree());
+  status += ",alerts_sent=" + String(alertStats.sent);
+  status += ",alerts_acked=" + String(alertStats.acked);
+  status += ",alerts_retx=" + String(alertStats.retransmits);
+  status += ",alerts_expired=" + String(alertStats.expired + alertStats.evicted);
+  status += ",alerts_pending=" + String(alertsPending());
+  status += ",alerts_late=" + String(alertStats.late);
+  status += ",alert_ack_avg_ms=" + String(alertStats.acked ? alertStats.latencySumMs / alertStats.acked : 0);
+  status += ",alert_ack_max_ms=" + String(alertStats.latencyMaxMs);
+  status += ",loop_avg_us=" + String(profAvgUs(PROF_LOOP));
+  status += ",loop_max_us=" + String(profStages[PROF_LOOP].maxUs);
+  status += ",loop_overruns=" + String(profLoopOverruns);
+  status += ",heap_free=" + String(profHeapFree);
+  status += ",heap_largest=" + String(profHeapLargest);
+  status += ",log_truncated=" + String(logTruncated);
+  status += ",sync=" + String(syncStateToString(millis()));
+  if (clockSync.valid) {
+    status += ",sync_offset_ms=" + int64ToString(syncOffsetAtUs(esp_timer_get_time()) / 1000);
+    status += ",sync_rtt_us=" + String(clockSync.rttUs);
+    status += ",sync_rtt_min_us=" + String(clockSync.rttMinUs);
+    status += ",sync_drift_ppm=" + String(clockSync.driftValid ? clockSync.driftPpm : 0.0f, 2);
+    status += ",sync_age_ms=" + String(millis() - clockSync.lastGoodMs);
+  }
+  status += ",sync_count=" + String(clockSync.count);
+  status += ",sync_lost=" + String(clockSync.lost);
+  status += ",sync_rejected=" + String(clockSync.rejected);
+  status += ",reset=" + String(resetReasonToString(esp_reset_reason()));
+  status += ",boot_setup_ms=" + String(bootSetupMs);
+  status += ",boot_sample_ms=" + String(bootFirstSampleMs);
+  for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+    status += ",boot_" + String(BOOT_STAGE_NAMES[i]) + "_ms=" + bootStageField((BootStage)i);
+  }
+  LOG_INFO("CMD", "%s", status.c_str());
+  sendFieldReply(status);  // Runs past one datagram with STA, sync and report fields
+}
+
+// PROF:<summary>;<stage>=n:<count>,min:<us>,avg:<us>,max:<us>,hist:<b0>/<b1>/...;...
+// Histogram bucket b counts durations in [2^b, 2^(b+1)) us
+void cmdProf(const PiCommand &c) {
+  String prof = "PROF:overruns=" + String(profLoopOverruns);
+  prof += ",heap_free=" + String(profHeapFree);
+  prof += ",heap_min=" + String(ESP.getMinFreeHeap());
+  prof += ",heap_largest=" + String(profHeapLargest);
+  prof += ",heap_largest_min=" + String(profHeapLargestMin == UINT32_MAX ? 0 : profHeapLargestMin);
+  prof += ",cpu_mhz=" + String(profCpuMhz);
+
+  for (int i = 0; i < PROF_STAGE_COUNT; i++) {
+    const ProfStage &p = profStages[i];
+    prof += ";";
+    prof += PROF_STAGE_NAMES[i];
+    prof += "=n:" + String(p.count);
+    prof += ",min:" + String(p.minUs);
+    prof += ",avg:" + String(profAvgUs((ProfStageId)i));
+    prof += ",max:" + String(p.maxUs);
+    prof += ",hist:";
+    for (int b = 0; b < PROF_HIST_BUCKETS; b++) {
+      if (b > 0) prof += "/";
+      prof += String(p.hist[b]);
+    }
+  }
+
+  LOG_INFO("PROF", "Report %u bytes, loop avg %uus max %uus, %u overruns", prof.length(),
+           (unsigned)profAvgUs(PROF_LOOP), (unsigned)profStages[PROF_LOOP].maxUs, (unsigned)profLoopOverruns);
+  sendUDP(prof);
+}
+
+void cmdProfReset(const PiCommand &c) {
+  profReset();
+  LOG_INFO("PROF", "Counters reset");
+}
+
+// SYNC:<t1>,<t2>,<t3> - the Pi's answer to our SYNC:REQ:<t1>
+void cmdSync(const PiCommand &c) {
+  char *next = nullptr;
+  int64_t t[3];
+  const char *p = c.argText;
+  for (int i = 0; i < 3; i++) {
+    t[i] = strtoll(p, &next, 10);
+    if (next == p || (i < 2 && *next != ',')) {
+      LOG_WARN("SYNC", "Malformed reply: %s", c.argText);
+      return;
+    }
+    p = next + 1;
+  }
+  clockSyncReply(t[0], t[1], t[2], c.rxUs);
+}
+
+// REPORT:KEY - the Pi lost our reference (restart, unknown keySeq)
+void cmdReportKey(const PiCommand &c) {
+  reportState.keyRequested = true;
+  LOG_INFO("REPORT", "Keyframe requested");
+}
+
+// TASKS:window_ms=..,core0_cpu=..,core1_cpu=..;<task>=core:c,prio:p,stack:<bytes>,stack_free:<bytes>,cpu:<pct>;...
+// CPU shares cover the time since the previous TASKS report; stack_free is the
+// high-water mark (bytes never touched). Tasks not started yet are skipped.
+void cmdTasks(const PiCommand &c) {
+  static int64_t lastReportUs = 0;
+  int64_t nowUs = esp_timer_get_time();
+  uint32_t windowUs = lastReportUs ? (uint32_t)(nowUs - lastReportUs) : 0;
+  lastReportUs = nowUs;
+
+  float coreCpu[2] = { 0, 0 };
+  String tasks;
+  for (int i = 0; i < TASK_COUNT; i++) {
+    TaskStat &t = taskStats[i];
+    if (t.handle == nullptr) continue;
+    uint32_t busy = t.busyUs;
+    float cpu = windowUs ? (busy - t.reportBusyUs) * 100.0f / windowUs : 0.0f;
+    t.reportBusyUs = busy;
+    if (t.core >= 0 && t.core < 2) coreCpu[t.core] += cpu;
+
+    tasks += ";";
+    tasks += TASK_NAMES[i];
+    tasks += "=core:" + String((int)t.core);
+    tasks += ",prio:" + String((unsigned)t.priority);
+    tasks += ",stack:" + String(t.stackBytes);
+    tasks += ",stack_free:" + String((unsigned)uxTaskGetStackHighWaterMark(t.handle));
+    tasks += ",cpu:" + String(cpu, 1);
+  }
+
+  String report = "TASKS:window_ms=" + String(windowUs / 1000);
+  report += ",core0_cpu=" + String(coreCpu[0], 1);
+  report += ",core1_cpu=" + String(coreCpu[1], 1);
+  report += tasks;
+  LOG_INFO("CMD", "%s", report.c_str());
+  sendUDP(report);
+}
+
+// Command table - order must match PiCommandId
+const PiCommandSpec PI_COMMANDS[CMD_COUNT] = {
+  { "PLAY:STOP",     CMD_ARGS_NONE,   "PLAY:STOP",     cmdPlayStop },
+  { "PLAY:",         CMD_ARGS_INT,    "PLAY:n",        cmdPlay },
+  { "VOLUME:",       CMD_ARGS_INT,    "VOLUME:n",      cmdVolume },
+  { "RATE:",         CMD_ARGS_INT,    "RATE:n",        cmdRate },
+  { "CAL:REF:",      CMD_ARGS_TEXT,   "CAL:REF:psi",   cmdCalibrateRef },
+  { "CAL:",          CMD_ARGS_FLOAT3, "CAL:r,a,e",     cmdCalibrate },
+  { "CFG:GET",       CMD_ARGS_NONE,   "CFG:GET",       cmdConfigGetAll },
+  { "CFG:GET:",      CMD_ARGS_TEXT,   "CFG:GET:key",   cmdConfigGet },
+  { "CFG:SET:",      CMD_ARGS_TEXT,   "CFG:SET:key=v", cmdConfigSet },
+  { "CFG:RESET",     CMD_ARGS_NONE,   "CFG:RESET",     cmdConfigReset },
+  { "ACK:",          CMD_ARGS_INT,    "ACK:seq",       cmdAlertAck },
+  { "FORMAT:BIN",    CMD_ARGS_NONE,   "FORMAT:BIN",    cmdFormatBin },
+  { "FORMAT:TEXT",   CMD_ARGS_NONE,   "FORMAT:TEXT",   cmdFormatText },
+  { "STREAM:IMU:",   CMD_ARGS_INT,    "STREAM:IMU:nHZ", cmdStreamImu },
+  { "STREAM:OFF",    CMD_ARGS_NONE,   "STREAM:OFF",    cmdStreamOff },
+  { "BLE:FAST",      CMD_ARGS_NONE,   "BLE:FAST",      cmdBleFast },
+  { "DEBUG:ON",      CMD_ARGS_NONE,   "DEBUG:ON",      cmdDebugOn },
+  { "DEBUG:OFF",     CMD_ARGS_NONE,   "DEBUG:OFF",     cmdDebugOff },
+  { "DEBUG:VERBOSE", CMD_ARGS_NONE,   "DEBUG:VERBOSE", cmdDebugVerbose },
+  { "STATUS",        CMD_ARGS_NONE,   "STATUS",        cmdStatus },
+  { "PROF",          CMD_ARGS_NONE,   "PROF",          cmdProf },
+  { "PROF:RESET",    CMD_ARGS_NONE,   "PROF:RESET",    cmdProfReset },
+  { "SYNC:",         CMD_ARGS_TEXT,   "SYNC:t1,t2,t3", cmdSync },
+  { "REPORT:KEY",    CMD_ARGS_NONE,   "REPORT:KEY",    cmdReportKey },
+  { "TASKS",         CMD_ARGS_NONE,   "TASKS",         cmdTasks },
+};
+
+// Parse one datagram (modified in place) into a command record.
+// Runs in commandReceiverTask - must not touch detect task state.
+void parsePiCommand(char *text, PiCommand &cmd) {
+  // Trim whitespace and uppercase in place
+  while (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n') text++;
+  char *end = text + strlen(text);
+  while (end > text && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) *--end = '\0';
+  for (char *p = text; *p; p++) *p = toupper(*p);
+
+  cmd.id = CMD_UNKNOWN;
+  cmd.intArg = 0;
+  cmd.floatArgs[0] = cmd.floatArgs[1] = cmd.floatArgs[2] = 0.0;
+  cmd.argText[0] = '\0';
+  strncpy(cmd.text, text, sizeof(cmd.text) - 1);
+  cmd.text[sizeof(cmd.text) - 1] = '\0';
+
+  for (int i = 0; i < CMD_COUNT; i++) {
+    const PiCommandSpec &spec = PI_COMMANDS[i];
+    size_t keywordLength = strlen(spec.keyword);
+
+    // Commands with arguments match on prefix, the rest must match exactly
+    bool matched = (spec.args == CMD_ARGS_NONE) ? (strcmp(text, spec.keyword) == 0)
+                                                : (strncmp(text, spec.keyword, keywordLength) == 0);
+    if (!matched) continue;
+
+    const char *args = text + keywordLength;
+    if (spec.args == CMD_ARGS_INT) {
+      cmd.intArg = atoi(args);
+    } else if (spec.args == CMD_ARGS_FLOAT3) {
+      // CAL:<r_fixed>,<area_mm2>,<exponent>  e.g. CAL:10000,20,0.909
+      char *next = nullptr;
+      for (int f = 0; f < 3; f++) {
+        cmd.floatArgs[f] = strtof(args, &next);
+        if (*next != ',') break;
+        args = next + 1;
+      }
+    } else if (spec.args == CMD_ARGS_TEXT) {
+      strncpy(cmd.argText, args, sizeof(cmd.argText) - 1);
+      cmd.argText[sizeof(cmd.argText) - 1] = '\0';
+    }
+    cmd.id = (PiCommandId)i;
+    return;
+  }
+}
+
+void dispatchPiCommand(const PiCommand &cmd) {
+  LOG_INFO("CMD", "Handling Pi command: %s", cmd.text);
+
+  if (cmd.id >= CMD_COUNT) {
+    char usage[LOG_LINE_MAX];
+    size_t used = 0;
+    for (int i = 0; i < CMD_COUNT && used < sizeof(usage); i++) {
+      used += snprintf(usage + used, sizeof(usage) - used, "%s%s", i == 0 ? "" : ", ", PI_COMMANDS[i].usage);
+    }
+    LOG_WARN("CMD", "Unknown command. Available: %s", usage);
+    return;
+  }
+
+  // Any command from the Pi brings the ball back to full rate first (clock sync
+  // replies, ACKs and keyframe requests answer our own traffic, not activity)
+  bool reply = cmd.id == CMD_SYNC || cmd.id == CMD_ALERT_ACK || cmd.id == CMD_REPORT_KEY;
+  if (powerMode == POWER_IDLE && !reply) {
+    powerWakeSource = WAKE_COMMAND;
+    exitIdleMode(millis());
+  }
+  PI_COMMANDS[cmd.id].handler(cmd);
+}
+
+void commandReceiverTask(void *param) {
+  int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(ESP_COMMAND_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+  if (sock < 0 || bind(sock, (sockaddr*)&addr, sizeof(addr)) < 0) {
+    LOG_ERROR("WiFi", "ERROR: Command socket bind failed");
+    if (sock >= 0) closesocket(sock);
+    vTaskDelete(nullptr);
+    return;
+  }
+
+  char buffer[256];
+  for (;;) {
+    sockaddr_in from = {};
+    socklen_t fromLength = sizeof(from);
+    int len = recvfrom(sock, buffer, sizeof(buffer) - 1, 0, (sockaddr*)&from, &fromLength);  // Blocks until a datagram arrives
+    int64_t rxUs = esp_timer_get_time();  // SYNC t4, taken before any parsing
+    if (len <= 0) {
+      vTaskDelay(pdMS_TO_TICKS(10));
+      continue;
+    }
+    buffer[len] = '\0';
+    netHubAddr = from.sin_addr.s_addr;  // Replies and telemetry follow the hub (STA mode)
+
+    PiCommand cmd;
+    int64_t busy = taskBusyStart();
+    uint32_t profT = profStart();
+    parsePiCommand(buffer, cmd);
+    cmd.rxUs = rxUs;
+    profEnd(PROF_CMD_RX, profT);
+    commandRing.push(cmd);  // Counted in commandRing.drops if the detect task has fallen behind
+    if (detectTaskHandle != nullptr) xTaskNotifyGive(detectTaskHandle);
+    taskBusyEnd(TASK_CMD_RX, busy);
+  }
+}
+
+void startCommandReceiver() {
+  startPinnedTask(TASK_CMD_RX, commandReceiverTask, 4096, NET_TASK_PRIORITY, NET_TASK_CORE);
+}
+
+// ===================== BOOT TASKS =====================
+// DFPlayer: a status query that gets answered means the module has booted and
+// scanned its card. Without a reset, an already-running module answers at once.
+void dfplayerBootTask(void *param) {
+  mp3Serial.begin(9600, SERIAL_8N1, PIN_MP3_RX, PIN_MP3_TX);
+  dfplayer.setTimeOut(DFPLAYER_POLL_TIMEOUT_MS);
+  dfplayer.begin(mp3Serial, true, false);
+
+  unsigned long start = millis();
+  bool ok = false;
+  while (!ok && millis() - start < DFPLAYER_BOOT_TIMEOUT_MS) {
+    ok = dfplayer.readState() >= 0;
+  }
+
+  if (ok) {
+    dfplayer.stop();                  // Idle and at the default volume; each command waits for its ACK
+    dfplayer.volume(currentVolume);
+  } else {
+    LOG_ERROR("ERROR", "DFPlayer init FAILED! Check:");
+    LOG_ERROR("ERROR", "  - SD card inserted and FAT32 formatted?");
+    LOG_ERROR("ERROR", "  - MP3 files named 001.mp3, 002.mp3, etc?");
+    LOG_ERROR("ERROR", "  - TX/RX wiring correct? (ESP TX->DFPlayer RX)");
+    LOG_ERROR("ERROR", "  - 1K resistor on TX line?");
+  }
+  bootStageDone(BOOT_DFPLAYER, ok);
+  vTaskDelete(nullptr);
+}
+
+// AP: own network, the Pi joins it. STA: join the hub; the stage is ready once
+// the interface has started and sends wait for the lease (netLinkUp()), so a
+// hub that comes up later is picked up by auto-reconnect.
+bool startWifi() {
+  if (netMode == NET_MODE_STA) {
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(true);
+    WiFi.begin(STA_SSID, STA_PASS);
+    bool up = WiFi.waitStatusBits(STA_STARTED_BIT, WIFI_AP_START_TIMEOUT_MS) & STA_STARTED_BIT;
+    if (up) LOG_INFO("WiFi", "Joining hub %s as %s", STA_SSID, deviceId);
+    return up;
+  }
+
+  WiFi.mode(WIFI_AP);
+  bool up = WiFi.softAP(AP_SSID, AP_PASS) &&
+            (WiFi.waitStatusBits(AP_STARTED_BIT, WIFI_AP_START_TIMEOUT_MS) & AP_STARTED_BIT);
+  if (up) LOG_INFO("WiFi", "AP started: %s", AP_SSID);
+  return up;
+}
+
+// WiFi then BLE: both controllers claim the shared RF/coexistence block on
+// init, so they come up one after the other in this task
+void radioBootTask(void *param) {
+  bool wifiUp = startWifi();
+  if (wifiUp) {
+    // Commands arrive on their own socket in commandReceiverTask; udp is send-only
+    startCommandReceiver();
+    LOG_INFO("WiFi", "UDP command listener on port %d", ESP_COMMAND_PORT);
+  }
+  bootStageDone(BOOT_WIFI, wifiUp);
+
+  setupBLE();
+  bootStageDone(BOOT_BLE, pAdvertising != nullptr);
+  vTaskDelete(nullptr);
+}
+
+void startBootTasks() {
+  xTaskCreatePinnedToCore(radioBootTask, "boot_radio", 6144, nullptr,
+                          BOOT_TASK_PRIORITY, nullptr, BOOT_TASK_CORE);
+  xTaskCreatePinnedToCore(dfplayerBootTask, "boot_dfplayer", 3072, nullptr,
+                          BOOT_TASK_PRIORITY, nullptr, BOOT_TASK_CORE);
+}
+
+// ===================== TASKS =====================
+// io: owns the DFPlayer serial port and the BLE advertising scheduler, so
+// neither ever runs on the detection core
+void ioTask(void *param) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IO_TASK_PERIOD_MS));  // Woken early by audio/BLE requests
+    int64_t busy = taskBusyStart();
+    unsigned long now = millis();
+
+    // Advance queued DFPlayer commands (never blocks)
+    uint32_t profT = profStart();
+    serviceAudioQueue(now);
+    profEnd(PROF_AUDIO, profT);
+
+    // BLE advertising rate + health (GAP-event driven, never blocks)
+    profT = profStart();
+    serviceBleScheduler(now);
+    profEnd(PROF_BLE, profT);
+
+    taskBusyEnd(TASK_IO, busy);
+  }
+}
+
+void detectPass();
+
+// detect: command dispatch, detection, telemetry and alerts (the old loop() body)
+void detectTask(void *param) {
+  for (;;) detectPass();
+}
+
+void startWorkerTasks() {
+  startPinnedTask(TASK_NET_TX, netTxTask, 4096, NET_TASK_PRIORITY, NET_TASK_CORE);
+  startPinnedTask(TASK_IO, ioTask, 4096, IO_TASK_PRIORITY, IO_TASK_CORE);
+  detectTaskHandle = startPinnedTask(TASK_DETECT, detectTask, DETECT_TASK_STACK, DETECT_TASK_PRIORITY,
+                                     DETECT_TASK_CORE);
+}
+
+// ===================== SETUP =====================
+void setup() {
+  Serial.begin(115200);
+  startLogging();
+  profCpuMhz = getCpuFrequencyMhz();
+
+  LOG_INFO("BOOT", "========================================");
+  LOG_INFO("BOOT", "   ESP32 Stress Ball  ");
+  LOG_INFO("BOOT", "========================================");
+  LOG_INFO("BOOT", "Reset reason: %s", resetReasonToString(esp_reset_reason()));
+
+  // Random start so a rebooted ball's alert seqs don't match ones the Pi just handled
+  telemetrySeq = (uint16_t)esp_random();
+
+  loadConfig();
+  initDeviceIdentity();
+  LOG_INFO("BOOT", "Device %s, network %s", deviceId, netModeToString(netMode));
+  rebuildPSITable();
+  detectionClock = profStart;
+  detectionStageDone = profDetectionStage;
+
+  for (int c = 0; c < FSR_CHANNEL_COUNT; c++) analogSetPinAttenuation(FSR_PINS[c], ADC_11db);
+
+  Wire.begin(I2C_SDA, I2C_SCL);
+  Wire.setClock(I2C_FAST_MODE_HZ);
+  mpu.initialize();
+  LOG_INFO("MPU6050", "Initialized");
+
+  // Start fixed-rate FSR + MPU6050 acquisition before anything slow
+  lastActivityMs = millis();
+  startSampling();
+
+  // DFPlayer, WiFi AP and BLE beacon finish in the background
+  startBootTasks();
+
+  // Radio TX, DFPlayer/BLE service and detection; detect outranks this
+  // loopTask on core 1, so it starts last
+  startWorkerTasks();
+
+  bootSetupMs = millis();
+  LOG_INFO("BOOT", "========================================");
+  LOG_INFO("BOOT", "   Monitoring Active (%lums)", (unsigned long)bootSetupMs);
+  LOG_INFO("BOOT", "========================================");
+}
+
+// ===================== SAMPLE PROCESSING =====================
+// Detection results accumulated over all samples drained in one detect pass
+struct SampleEvents {
+  bool patternTriggered;      // 5-grip pattern completed
+  bool motionTriggered;       // 5 consecutive same motions
+  MotionType motion;          // Motion of the triggering (or latest) sample
+  MotionType alertMotion;     // Repeated motion behind motionTriggered (from the engine)
+  psi_t maxPSI;               // PSI of the triggering (or latest) sample
+  unsigned long timeMs;       // Acquisition time of the triggering (or latest) sample
+};
+
+// Run grip + motion detection on one fixed-rate sample
+void processSample(const SensorSample &s, SampleEvents &events) {
+  sampleNowMs = s.timeMs;
+  latestSample = s;
+
+  // PSI average, grip state, 5-grip pattern and motion (profiled via detectionStageDone)
+  DetectionResult r;
+  runDetection(s, r);
+  psi_t maxPSI = r.maxPSI;
+  MotionType motion = r.motion;
+
+  // Add PSI to the sliding window stats (for periodic updates)
+  addPsiSample(maxPSI, sampleNowMs);
+
+  if (r.gripChanged) {
+    LOG_INFO("GRIP", "State changed: %s -> %s", gripStateToString(r.previousGrip),
+             gripStateToString(currentGripState));
+    reportGripChange(r.previousGrip, maxPSI, s.timeMs);
+  }
+
+  switch (r.patternStep) {
+    case PATTERN_GAP_RESET:
+      LOG_DEBUG("PATTERN", "Gap too long (%lums). Resetting sequence.", patternGapMs);
+      break;
+    case PATTERN_GAP_VALID:
+      LOG_DEBUG("PATTERN", "Valid gap (%lums). Grip #%d", patternGapMs, sequenceCount);
+      break;
+    case PATTERN_RELEASED:
+      LOG_DEBUG("PATTERN", "Grip released. Waiting for next...");
+      break;
+    case PATTERN_TRIGGERED:
+      LOG_DEBUG("PATTERN", "Valid gap (%lums). Grip #%d", patternGapMs, GRIP_PATTERN_COUNT);
+      LOG_INFO("PATTERN", "%d-GRIP PATTERN DETECTED!", GRIP_PATTERN_COUNT);
+      LOG_INFO("PATTERN", "Grips: %s -> %s -> %s -> %s -> %s", gripStateToString(sequenceGrips[0]),
+               gripStateToString(sequenceGrips[1]), gripStateToString(sequenceGrips[2]),
+               gripStateToString(sequenceGrips[3]), gripStateToString(sequenceGrips[4]));
+      LOG_INFO("PATTERN", "Dominant type: %s", gripStateToString(dominantGripType));
+      break;
+    default:
+      break;
+  }
+
+  if (calRef.active) calRefAddSample(s);
+
+  if (motion != MOTION_NONE || maxPSI > detectionConfig.noGripQ) lastActivityMs = millis();
+
+  // Record motion to history ONLY if it's not "None" (for periodic updates)
+  // This way, actual motions aren't drowned out by hundreds of "None" entries
+  if (motion != MOTION_NONE) {
+    recordMotion(motion);
+
+    if (r.repeatCount == 1) {
+      LOG_DEBUG("DEBUG", "New motion type: %s", motionToString(motion));
+    } else {
+      LOG_DEBUG("DEBUG", "Same motion detected: %s count: %d", motionToString(motion), r.repeatCount);
+    }
+  }
+  if (r.motionTriggered) {
+    LOG_DEBUG("DEBUG", "%d consecutive motions reached - triggering sound!", r.repeatCount);
+  }
+
+  // Keep the values of the first triggering sample in this pass
+  if (!events.patternTriggered && !events.motionTriggered) {
+    events.motion = motion;
+    events.maxPSI = maxPSI;
+    events.timeMs = s.timeMs;
+  }
+  if (r.motionTriggered && !events.motionTriggered) events.alertMotion = r.repeatMotion;
+  events.patternTriggered = events.patternTriggered || r.patternStep == PATTERN_TRIGGERED;
+  events.motionTriggered = events.motionTriggered || r.motionTriggered;
+}
+
+// ===================== DETECT PASS =====================
+void detectPass() {
+  uint32_t loopStart = profStart();
+  int64_t busy = taskBusyStart();
+
+  // ----- 1) DISPATCH COMMANDS -----
+  // Already parsed by commandReceiverTask; handle every pending command
+  PiCommand command;
+  while (commandRing.pop(command)) {
+    uint32_t profT = profStart();
+    dispatchPiCommand(command);
+    profEnd(PROF_COMMANDS, profT);
+  }
+
+  // ----- 2) PROCESS FIXED-RATE SAMPLES -----
+  // Drain everything the sampling task acquired since the last pass
+  SampleEvents events = { false, false, MOTION_NONE, MOTION_NONE, fsrFeatures.maxPsi, latestSample.timeMs };
+  SensorSample sample;
+  while (sampleRing.pop(sample)) {
+    processSample(sample, events);
+    streamImuSample(sample);
+  }
+  serviceImuStream(millis());
+  serviceCalRef(millis());
+  serviceClockSync(millis());
+
+  bool patternTriggered = events.patternTriggered;
+  bool shouldPlayForMotion = events.motionTriggered;
+
+  // Determine if child is squeezing (any significant pressure)
+  bool squeeze = (fsrFeatures.maxPsi > detectionConfig.noGripQ);
+
+  // ----- 3) SEND SENSOR EVENT -----
   unsigned long now = millis();
 
+  // Grip transitions go out at once, ahead of the heartbeat
+  serviceGripEvent(now);
+
   // Distress signals that require IMMEDIATE send (bypass periodic interval)
   bool isDistressSignal = patternTriggered || shouldPlayForMotion;
 
-  // Periodic heartbeat every 5 seconds (so Pi knows ESP32 is alive)
+  // Periodic heartbeat every 5 seconds (so Pi knows ESP32 is alive), jittered per period
   static unsigned long lastPeriodicSend = 0;
-  bool isPeriodicSend = (now - lastPeriodicSend >= 5000);
+  static unsigned long periodicIntervalMs = HEARTBEAT_INTERVAL_MS;
+  bool isPeriodicSend = (now - lastPeriodicSend >= periodicIntervalMs);
 
   // Send data when:
   // 1. IMMEDIATE: Distress signal detected (with cooldown to prevent spam)
   // 2. PERIODIC: Every 5 seconds for heartbeat/status update
   bool shouldSend = false;
 
-  if (isDistressSignal && (now - lastTriggerTime > COOLDOWN_MS)) {
+  if (isDistressSignal && (now - lastTriggerTime > firmwareConfig.cooldownMs)) {
     // Immediate send for distress (respects cooldown)
     shouldSend = true;
     lastTriggerTime = now;
@@ -939,54 +3378,108 @@ void loop() {
     // Periodic send every 5 seconds
     shouldSend = true;
     lastPeriodicSend = now;
+    periodicIntervalMs = HEARTBEAT_INTERVAL_MS + esp_random() % HEARTBEAT_JITTER_MS;
   }
 
   if (shouldSend) {
+    uint32_t profT = profStart();
+
     // Determine which motion and PSI to send
-    String motionToSend;
+    MotionType motionToSend;
     float psiToSend;
+    unsigned long sampleMs = isDistressSignal ? events.timeMs : latestSample.timeMs;
+    PsiStats psiStats;
+    getPsiWindowStats(sampleNowMs, psiStats);
 
     if (isDistressSignal) {
       // For immediate distress, use current values
-      motionToSend = motion;
-      psiToSend = maxPSI;
+      motionToSend = events.motion;
+      psiToSend = psiToFloat(events.maxPSI);
     } else {
       // For periodic updates, use aggregated values from last 5 seconds
       motionToSend = getMostFrequentMotion();
-      psiToSend = getAveragePSI();
+      psiToSend = psiStats.mean;
     }
 
-    // Build comprehensive message with PSI and grip state
-    String msg = "device:ESP32-BALL,";
-    msg += "time:" + String(now) + ",";
-    msg += "fsr1_raw:" + String(fsr1_raw) + ",";
-    msg += "fsr2_raw:" + String(fsr2_raw) + ",";
-    msg += "psi1:" + String(lastPSI1, 2) + ",";
-    msg += "psi2:" + String(lastPSI2, 2) + ",";
-    msg += "psi_max:" + String(psiToSend, 2) + ",";  // Use aggregated for periodic, current for distress
-    msg += "grip_state:" + gripStateToString(currentGripState) + ",";
-    msg += "ax:" + String(ax) + ",";
-    msg += "ay:" + String(ay) + ",";
-    msg += "az:" + String(az) + ",";
-    msg += "gx:" + String(gx) + ",";
-    msg += "gy:" + String(gy) + ",";
-    msg += "gz:" + String(gz);
-    // Send aggregated motion for periodic, current motion for distress
-    msg += ",motion:" + motionToSend;
-    if (squeeze) msg += ",action:Squeeze";
-    // Distress alerts - only sent when pattern/motion threshold reached
-    if (patternTriggered) msg += ",alert:PATTERN_3GRIP,dominant_type:" + gripStateToString(dominantGripType);
-    if (shouldPlayForMotion) msg += ",alert:MOTION_3X,motion_type:" + lastMotionType;
-
-    sendUDP(msg);
+    if (binaryTelemetry) {
+      uint8_t flags = isDistressSignal ? 0 : TELEMETRY_FLAG_PERIODIC;
+      if (squeeze) flags |= TELEMETRY_FLAG_SQUEEZE;
+      if (patternTriggered) flags |= TELEMETRY_FLAG_ALERT_PATTERN;
+      if (shouldPlayForMotion) flags |= TELEMETRY_FLAG_ALERT_MOTION;
+
+      TelemetryFrame frame;
+      buildTelemetryFrame(frame, now, sampleMs, psiToSend, psiStats, motionToSend, events.alertMotion, flags);
+      const char *report = "full";
+      if (isDistressSignal) {
+        queueAlert(frame.seq, (const uint8_t*)&frame, sizeof(frame), now);
+      } else if (reportDeltaActive()) {
+        report = sendReport(frame, now);
+      } else {
+        sendUDP((const uint8_t*)&frame, sizeof(frame));
+      }
 
-    if (isDistressSignal) {
-      Serial.println("[UDP] IMMEDIATE distress: " + msg);
+      LOG_INFO("UDP", "%s: BIN seq=%u (%s)", isDistressSignal ? "IMMEDIATE distress" : "Periodic update",
+               frame.seq, report);
     } else {
-      Serial.println("[UDP] Periodic update: " + msg);
-      // Reset aggregation histories after periodic send
-      motionHistoryCount = 0;
-      psiHistoryCount = 0;
+      // Build comprehensive message with PSI and grip state
+      uint16_t seq = telemetrySeq++;
+      String msg = "device:" + String(deviceId) + ",";
+      msg += "seq:" + String(seq) + ",";
+      msg += "time:" + String(now) + ",";
+      int64_t ts = syncTimeMs(sampleMs);
+      if (ts != 0) msg += "ts:" + int64ToString(ts) + ",";
+      msg += "fsr1_raw:" + String(latestSample.fsrRaw[0]) + ",";
+      msg += "fsr2_raw:" + String(latestSample.fsrRaw[FSR_LEGACY_CH2]) + ",";
+      msg += "psi1:" + String(psiToFloat(channelPSI[0]), 2) + ",";
+      msg += "psi2:" + String(psiToFloat(channelPSI[FSR_LEGACY_CH2]), 2) + ",";
+      msg += "psi_pads:";
+      for (int c = 0; c < FSR_CHANNEL_COUNT; c++) {
+        if (c > 0) msg += "/";
+        msg += String(psiToFloat(channelPSI[c]), 2);
+      }
+      msg += ",psi_sum:" + String(psiToFloat(fsrFeatures.sumPsi), 2) + ",";
+      msg += "psi_centroid:" + String(fsrFeatures.centroid / 256.0f, 2) + ",";
+      msg += "psi_max_pad:" + String(fsrFeatures.maxChannel) + ",";
+      msg += "psi_max:" + String(psiToSend, 2) + ",";  // Use aggregated for periodic, current for distress
+      msg += "psi_min:" + String(psiStats.minPsi, 2) + ",";
+      msg += "psi_peak:" + String(psiStats.maxPsi, 2) + ",";
+      msg += "psi_std:" + String(psiStats.stddev, 2) + ",";
+      msg += "grip_state:";
+      msg += gripStateToString(currentGripState);
+      msg += ",";
+      msg += "ax:" + String(latestSample.ax) + ",";
+      msg += "ay:" + String(latestSample.ay) + ",";
+      msg += "az:" + String(latestSample.az) + ",";
+      msg += "gx:" + String(latestSample.gx) + ",";
+      msg += "gy:" + String(latestSample.gy) + ",";
+      msg += "gz:" + String(latestSample.gz);
+      // Send aggregated motion for periodic, current motion for distress
+      msg += ",motion:";
+      msg += motionToString(motionToSend);
+      if (squeeze) msg += ",action:Squeeze";
+      // Distress alerts - only sent when pattern/motion threshold reached
+      if (patternTriggered) {
+        msg += ",alert:PATTERN_3GRIP,dominant_type:";
+        msg += gripStateToString(dominantGripType);
+      }
+      if (shouldPlayForMotion) {
+        msg += ",alert:MOTION_3X,motion_type:";
+        msg += motionToString(events.alertMotion);
+      }
+
+      if (isDistressSignal) {
+        msg += ",alert_seq:" + String(seq);
+        queueAlert(seq, (const uint8_t*)msg.c_str(), msg.length(), now);
+      } else {
+        sendUDP(msg);
+      }
+
+      LOG_INFO("UDP", "%s: %s", isDistressSignal ? "IMMEDIATE distress" : "Periodic update", msg.c_str());
+    }
+
+    if (!isDistressSignal) {
+      // Reset motion aggregation after periodic send (PSI window slides on its own)
+      resetMotionHistory();
     }
 
     // Play sound ONLY on distress signals:
@@ -994,62 +3487,61 @@ void loop() {
     // 2. 5 consecutive same motions
     if (isDistressSignal) {
       if (patternTriggered) {
-        Serial.print("[AUDIO] 5-Grip Pattern (");
-        Serial.print(gripStateToString(dominantGripType));
-        Serial.println(") - playing sound");
+        LOG_INFO("AUDIO", "5-Grip Pattern (%s) - playing sound", gripStateToString(dominantGripType));
       } else {
-        Serial.print("[AUDIO] 5x ");
-        Serial.print(lastMotionType);
-        Serial.println(" motions - playing sound");
+        LOG_INFO("AUDIO", "5x %s motions - playing sound", motionToString(events.alertMotion));
       }
       playSound(musicChoice);
+      bleAdvBoost(now, BLE_FAST_BOOST_MS);  // Pi gets fresh RSSI to locate the child
     }
+    profEnd(PROF_SEND, profT);
   }
 
+  // Retransmit unacknowledged alerts (through the urgent net_tx ring)
+  serviceAlerts(now);
+
 
   // Restore volume after alarm finishes
   if (alarmPlaying && (now - alarmStartTime > ALARM_DURATION)) {
-    dfplayer.volume(currentVolume);
+    enqueueAudioStep(AUDIO_OP_VOLUME, currentVolume, 0);
     alarmPlaying = false;
-    Serial.print("[ALARM] Alarm finished - volume restored to ");
-    Serial.println(currentVolume);
+    LOG_INFO("ALARM", "Alarm finished - volume restored to %d", currentVolume);
   }
 
-  // Debug output every 2 seconds
+  // Raw values every 2 seconds (DEBUG:VERBOSE)
   static unsigned long lastDebugTime = 0;
-  if (now - lastDebugTime > 2000) {
+  if (logLevel >= LOG_LEVEL_VERBOSE && now - lastDebugTime > 2000) {
     lastDebugTime = now;
-    // Read raw ADC for debug (separate from averaged PSI)
-    Serial.print("[DEBUG] RAW1: ");
-    Serial.print(fsr1_raw);
-    Serial.print(" RAW2: ");
-    Serial.print(fsr2_raw);
-    Serial.print(" | PSI1: ");
-    Serial.print(adcToPSI(fsr1_raw));
-    Serial.print(" | PSI2: ");
-    Serial.print(adcToPSI(fsr2_raw));
-    Serial.print(" | State: ");
-    Serial.println(gripStateToString(currentGripState));
-  }
-
-  // BLE health monitoring - check every 30 seconds
-  static unsigned long lastBLECheck = 0;
-  if (now - lastBLECheck > 30000) {
-    lastBLECheck = now;
-
-    // Check if advertising is still active
-    if (pAdvertising != nullptr) {
-      // Restart advertising to ensure beacon is active
-      pAdvertising->stop();
-      delay(50);
-      pAdvertising->start();
-      Serial.println("[BLE] Health check: Advertising restarted");
-    } else {
-      // Critical: pAdvertising is null, reinitialize BLE
-      Serial.println("[BLE] WARNING: pAdvertising is NULL! Reinitializing...");
-      setupBLE();
+    // Raw ADC for debug (separate from averaged PSI)
+    char pads[FSR_CHANNEL_COUNT * 32];
+    int len = 0;
+    for (int c = 0; c < FSR_CHANNEL_COUNT; c++) {
+      len += snprintf(pads + len, sizeof(pads) - len, "%sRAW%d: %u PSI%d: %.2f", c > 0 ? " | " : "",
+                      c + 1, latestSample.fsrRaw[c], c + 1, psiToFloat(adcToPSI(latestSample.fsrRaw[c])));
     }
+    LOG_VERBOSE("DEBUG", "%s | State: %s", pads, gripStateToString(currentGripState));
+  }
+
+  // Heap headroom/fragmentation for STATUS and PROF
+  static unsigned long lastHeapSample = 0;
+  if (now - lastHeapSample >= PROF_HEAP_INTERVAL_MS) {
+    lastHeapSample = now;
+    profSampleHeap();
   }
 
-  delay(20);
+  // Leave idle on a wake source or new activity; enter it after the timeout
+  updatePowerMode(now);
+
+  if (profEnd(PROF_LOOP, loopStart) > PROF_LOOP_BUDGET_US) profLoopOverruns++;
+  taskBusyEnd(TASK_DETECT, busy);
+
+  // Block until samplingTask has a burst or cmd_rx a command. Idle passes only
+  // wake on requestWake(); the active timeout keeps alert retransmits and
+  // telemetry on time when nothing arrives.
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(powerMode == POWER_IDLE ? IDLE_LOOP_WAIT_MS : DETECT_WAIT_MS));
+}
+
+// Arduino's loopTask has nothing left to do once the pinned tasks run
+void loop() {
+  vTaskDelete(nullptr);
 }
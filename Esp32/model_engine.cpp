@@ -0,0 +1,223 @@
+#include "model_engine.h"
+#include "model_weights.h"
+
+#include <string.h>
+
+// ===================== STATE =====================
+ModelStats modelStats;
+
+// Open bin accumulators
+struct ModelBinAccum {
+  bool open = false;
+  uint32_t index = 0;     // timeMs / MODEL_BIN_MS
+  uint32_t count = 0;
+  int64_t accelDevSum = 0;
+  int32_t accelDevMax = 0;
+  int32_t fallDepthMax = 0;
+  int32_t jerkMax = 0;
+  int64_t gyroSum = 0;
+  int32_t crossings = 0;
+  int64_t psiSum = 0;
+  int32_t psiMax = 0;
+};
+static ModelBinAccum binAccum;
+
+// Quantized bins, ring of the last MODEL_STEPS
+static int8_t windowRing[MODEL_STEPS][MODEL_CHANNELS];
+static int windowHead = 0;
+static int windowFill = 0;
+
+alignas(4) static int8_t modelArena[MODEL_ARENA_BYTES];
+
+// Confirmation / repeat counters over successive inferences
+static bool modelPrimed = false;        // At least one inference since reset
+static GripState gripCandidate = GRIP_NONE;
+static int gripCandidateCount = 0;
+static MotionType motionLast = MOTION_NONE;
+static int motionCount = 0;
+
+// ===================== FEATURES =====================
+bool modelAccumulate(const SensorSample &s, const ImuFeatures &f, psi_t maxPsi, ModelBinFeatures &closed) {
+  ModelBinAccum &a = binAccum;
+  uint32_t index = s.timeMs / MODEL_BIN_MS;
+  bool didClose = false;
+
+  if (a.open && index != a.index) {
+    uint32_t n = a.count;
+    closed.v[MODEL_CH_ACCEL_DEV_MEAN] = (int32_t)(a.accelDevSum / n);
+    closed.v[MODEL_CH_ACCEL_DEV_MAX] = a.accelDevMax;
+    closed.v[MODEL_CH_FALL_DEPTH] = a.fallDepthMax;
+    closed.v[MODEL_CH_JERK_MAX] = a.jerkMax;
+    closed.v[MODEL_CH_GYRO_MEAN] = (int32_t)(a.gyroSum / n);
+    closed.v[MODEL_CH_AXIS_CROSSINGS] = a.crossings;
+    closed.v[MODEL_CH_PSI_MEAN] = (int32_t)(a.psiSum / n);
+    closed.v[MODEL_CH_PSI_MAX] = a.psiMax;
+    didClose = true;
+    a = ModelBinAccum();
+  }
+  if (!a.open) {
+    a.open = true;
+    a.index = index;
+  }
+
+  int32_t dev = (int32_t)f.mag - MODEL_ONE_G;
+  int32_t absDev = dev < 0 ? -dev : dev;
+  int32_t fallDepth = dev < 0 ? -dev : 0;
+  int32_t gyro = abs(s.gx) + abs(s.gy) + abs(s.gz);
+  int32_t psi = psiToCenti(maxPsi);
+
+  a.count++;
+  a.accelDevSum += absDev;
+  if (absDev > a.accelDevMax) a.accelDevMax = absDev;
+  if (fallDepth > a.fallDepthMax) a.fallDepthMax = fallDepth;
+  if (f.jerk > a.jerkMax) a.jerkMax = (int32_t)f.jerk;
+  a.gyroSum += gyro;
+  a.crossings += __builtin_popcount(f.axisCrossings);
+  a.psiSum += psi;
+  if (psi > a.psiMax) a.psiMax = psi;
+  return didClose;
+}
+
+void modelQuantizeBin(const ModelWeights &w, const ModelBinFeatures &bin, int8_t out[MODEL_CHANNELS]) {
+  for (int c = 0; c < MODEL_CHANNELS; c++) {
+    int64_t q = ((int64_t)bin.v[c] * w.inputMult[c]) >> 16;
+    out[c] = (int8_t)(q < 0 ? 0 : (q > 127 ? 127 : q));
+  }
+}
+
+// ===================== INFERENCE =====================
+static inline int8_t requantRelu(int32_t acc, int32_t mult, int8_t shift) {
+  int64_t v = ((int64_t)acc * mult + ((int64_t)1 << (shift - 1))) >> shift;
+  return (int8_t)(v < 0 ? 0 : (v > 127 ? 127 : v));
+}
+
+static int argmax(const int32_t *v, int n) {
+  int best = 0;
+  for (int i = 1; i < n; i++) {
+    if (v[i] > v[best]) best = i;
+  }
+  return best;
+}
+
+void modelClassify(const ModelWeights &w, const int8_t window[MODEL_STEPS][MODEL_CHANNELS], ModelOutput &out) {
+  int8_t *input = modelArena + MODEL_ARENA_INPUT;
+  int8_t *conv = modelArena + MODEL_ARENA_CONV;
+  int8_t *hidden = modelArena + MODEL_ARENA_HIDDEN;
+  int32_t *logits = (int32_t *)(modelArena + MODEL_ARENA_LOGITS);
+
+  memcpy(input, window, MODEL_STEPS * MODEL_CHANNELS);
+
+  for (int t = 0; t < MODEL_CONV_STEPS; t++) {
+    const int8_t *x = input + t * MODEL_CONV_STRIDE * MODEL_CHANNELS;  // Kernel taps are contiguous
+    for (int o = 0; o < MODEL_CONV_FILTERS; o++) {
+      const int8_t *k = &w.convW[o][0][0];
+      int32_t acc = w.convB[o];
+      for (int i = 0; i < MODEL_CONV_KERNEL * MODEL_CHANNELS; i++) acc += k[i] * x[i];
+      conv[t * MODEL_CONV_FILTERS + o] = requantRelu(acc, w.convMult, w.convShift);
+    }
+  }
+
+  for (int j = 0; j < MODEL_HIDDEN; j++) {
+    int32_t acc = w.hiddenB[j];
+    for (int i = 0; i < MODEL_FLAT; i++) acc += w.hiddenW[j][i] * conv[i];
+    hidden[j] = requantRelu(acc, w.hiddenMult, w.hiddenShift);
+  }
+
+  for (int m = 0; m < MODEL_OUTPUTS; m++) {
+    int32_t acc = w.outB[m];
+    for (int j = 0; j < MODEL_HIDDEN; j++) acc += w.outW[m][j] * hidden[j];
+    logits[m] = acc;
+  }
+
+  // Logits within a head share one scale, so the integer argmax is exact
+  out.motion = (MotionType)argmax(logits, MODEL_MOTION_CLASSES);
+  out.grip = (GripState)argmax(logits + MODEL_MOTION_CLASSES, MODEL_GRIP_CLASSES);
+}
+
+// ===================== ENGINE =====================
+// Same DetectionResult contract as runRuleDetection(). The model supplies the
+// grip state and motion class; PSI averaging and the 5-grip pattern are shared.
+// Until the first window has filled, grip comes from the PSI thresholds.
+void runModelDetection(const SensorSample &s, DetectionResult &r) {
+  uint32_t t = detectionStageStart();
+  updateFsrChannels(s);
+  r.maxPSI = fsrFeatures.maxPsi;
+  detectionStageEnd(DETECT_STAGE_PSI, t);
+
+  t = detectionStageStart();
+  extractImuFeatures(s, latestFeatures);
+  ModelBinFeatures bin;
+  bool inferred = false;
+  ModelOutput out = { MOTION_NONE, GRIP_NONE };
+  if (modelAccumulate(s, latestFeatures, r.maxPSI, bin)) {
+    modelQuantizeBin(MODEL_WEIGHTS, bin, windowRing[windowHead]);
+    windowHead = (windowHead + 1) % MODEL_STEPS;
+    if (windowFill < MODEL_STEPS) windowFill++;
+
+    if (windowFill == MODEL_STEPS) {
+      int8_t window[MODEL_STEPS][MODEL_CHANNELS];
+      for (int i = 0; i < MODEL_STEPS; i++) {
+        memcpy(window[i], windowRing[(windowHead + i) % MODEL_STEPS], MODEL_CHANNELS);
+      }
+
+      uint32_t start = detectionStageStart();
+      modelClassify(MODEL_WEIGHTS, window, out);
+      uint32_t ticks = detectionClock ? detectionClock() - start : 0;
+      modelStats.inferences++;
+      modelStats.lastTicks = ticks;
+      modelStats.totalTicks += ticks;
+      if (ticks > modelStats.maxTicks) modelStats.maxTicks = ticks;
+      inferred = true;
+      modelPrimed = true;
+    }
+  }
+  r.motion = inferred ? out.motion : MOTION_NONE;
+  detectionStageEnd(DETECT_STAGE_MOTION, t);
+
+  t = detectionStageStart();
+  r.previousGrip = currentGripState;
+  r.gripChanged = false;
+  if (!modelPrimed) {
+    r.gripChanged = updateGripState(r.maxPSI);
+  } else if (inferred) {
+    if (out.grip == gripCandidate) {
+      gripCandidateCount++;
+    } else {
+      gripCandidate = out.grip;
+      gripCandidateCount = 1;
+    }
+    if (gripCandidateCount >= detectionConfig.modelGripConfirm && gripCandidate != currentGripState) {
+      currentGripState = gripCandidate;
+      r.gripChanged = true;
+    }
+  }
+  r.patternStep = updateGripPattern(r.maxPSI, s.timeMs);
+  detectionStageEnd(DETECT_STAGE_PATTERN, t);
+
+  r.motionTriggered = false;
+  if (inferred && out.motion != MOTION_NONE) {
+    motionCount = (out.motion == motionLast) ? motionCount + 1 : 1;
+    motionLast = out.motion;
+    if (motionCount >= detectionConfig.modelMotionRepeat) {
+      motionCount = 0;
+      r.motionTriggered = true;
+    }
+  } else if (inferred) {
+    motionLast = MOTION_NONE;
+    motionCount = 0;
+  }
+  r.repeatMotion = motionLast;
+  r.repeatCount = r.motionTriggered ? detectionConfig.modelMotionRepeat : motionCount;
+}
+
+void resetModelEngine() {
+  binAccum = ModelBinAccum();
+  memset(windowRing, 0, sizeof(windowRing));
+  windowHead = 0;
+  windowFill = 0;
+  modelPrimed = false;
+  gripCandidate = GRIP_NONE;
+  gripCandidateCount = 0;
+  motionLast = MOTION_NONE;
+  motionCount = 0;
+}
@@ -0,0 +1,101 @@
+// Int8 window classifier: the alternative detection engine to the rule
+// cascade in detection.cpp (selected with detectionConfig.engine).
+// Per-sample IMU/FSR features are pooled into MODEL_BIN_MS bins. Each time a
+// bin closes, the last MODEL_STEPS bins go through a small 1-D CNN whose
+// weights live in model_weights.h (generated by HostReplay/train_model).
+// Integer only, with every tensor in one fixed arena: no float, no heap.
+#pragma once
+
+#include "detection.h"
+
+// ===================== WINDOW =====================
+const uint32_t MODEL_BIN_MS = 100;
+const int MODEL_STEPS = 16;                 // 1.6s window, one inference per bin
+const int32_t MODEL_ONE_G = 16384;          // Raw accel counts at ±2g
+
+// Pooled features per bin, in input channel order
+enum ModelChannel : uint8_t {
+  MODEL_CH_ACCEL_DEV_MEAN,  // Mean |mag - 1g|
+  MODEL_CH_ACCEL_DEV_MAX,   // Peak |mag - 1g| (impacts, bounces)
+  MODEL_CH_FALL_DEPTH,      // Peak 1g - mag (free fall)
+  MODEL_CH_JERK_MAX,        // Peak |Δax| + |Δay| + |Δaz|
+  MODEL_CH_GYRO_MEAN,       // Mean |gx| + |gy| + |gz|
+  MODEL_CH_AXIS_CROSSINGS,  // Tilt-band crossings (rocking)
+  MODEL_CH_PSI_MEAN,        // Strongest pad, centi-PSI
+  MODEL_CH_PSI_MAX,
+  MODEL_CHANNELS
+};
+
+// ===================== NETWORK =====================
+// conv (MODEL_CONV_FILTERS x MODEL_CONV_KERNEL, stride 2) + ReLU
+//   -> dense MODEL_HIDDEN + ReLU -> dense MODEL_OUTPUTS logits:
+//   motion head (MotionType order) then grip head (GripState order)
+const int MODEL_CONV_FILTERS = 16;
+const int MODEL_CONV_KERNEL = 3;
+const int MODEL_CONV_STRIDE = 2;
+const int MODEL_CONV_STEPS = (MODEL_STEPS - MODEL_CONV_KERNEL) / MODEL_CONV_STRIDE + 1;
+const int MODEL_FLAT = MODEL_CONV_STEPS * MODEL_CONV_FILTERS;
+const int MODEL_HIDDEN = 24;
+const int MODEL_MOTION_CLASSES = MOTION_TYPE_COUNT;
+const int MODEL_GRIP_CLASSES = GRIP_TANTRUM + 1;
+const int MODEL_OUTPUTS = MODEL_MOTION_CLASSES + MODEL_GRIP_CLASSES;
+
+// Symmetric int8 weights, int32 biases in accumulator scale. Activations are
+// 0..127 after ReLU: q = clamp((acc * mult) >> shift, 0, 127).
+struct ModelWeights {
+  int32_t inputMult[MODEL_CHANNELS];  // q = min(127, (v * inputMult) >> 16)
+  int8_t convW[MODEL_CONV_FILTERS][MODEL_CONV_KERNEL][MODEL_CHANNELS];
+  int32_t convB[MODEL_CONV_FILTERS];
+  int32_t convMult;
+  int8_t convShift;
+  int8_t hiddenW[MODEL_HIDDEN][MODEL_FLAT];  // Input index = step * MODEL_CONV_FILTERS + filter
+  int32_t hiddenB[MODEL_HIDDEN];
+  int32_t hiddenMult;
+  int8_t hiddenShift;
+  int8_t outW[MODEL_OUTPUTS][MODEL_HIDDEN];
+  int32_t outB[MODEL_OUTPUTS];
+};
+extern const ModelWeights MODEL_WEIGHTS;
+
+// ===================== ARENA =====================
+// Every tensor has a fixed offset; the hidden layer reuses the input's bytes
+// once the conv layer has consumed it.
+const size_t MODEL_ARENA_BYTES = 512;
+const size_t MODEL_ARENA_INPUT = 0;
+const size_t MODEL_ARENA_CONV = MODEL_ARENA_INPUT + MODEL_STEPS * MODEL_CHANNELS;
+const size_t MODEL_ARENA_HIDDEN = MODEL_ARENA_INPUT;
+const size_t MODEL_ARENA_LOGITS = (MODEL_ARENA_CONV + MODEL_FLAT + 3) & ~(size_t)3;  // int32, aligned
+const size_t MODEL_ARENA_USED = MODEL_ARENA_LOGITS + MODEL_OUTPUTS * sizeof(int32_t);
+static_assert(MODEL_HIDDEN <= MODEL_STEPS * MODEL_CHANNELS, "hidden layer must fit in the input's slot");
+static_assert(MODEL_ARENA_USED <= MODEL_ARENA_BYTES, "model tensors exceed MODEL_ARENA_BYTES");
+
+// ===================== STATE =====================
+// One closed bin before input quantization (the trainer fits inputMult to these)
+struct ModelBinFeatures {
+  int32_t v[MODEL_CHANNELS];
+};
+
+struct ModelOutput {
+  MotionType motion;
+  GripState grip;
+};
+
+// Inference cost in detectionClock units (0 without a clock)
+struct ModelStats {
+  uint32_t inferences;
+  uint32_t lastTicks;
+  uint32_t maxTicks;
+  uint64_t totalTicks;
+};
+extern ModelStats modelStats;
+
+// ===================== API =====================
+// Pool one sample into the open bin; true (and closed filled) when the sample
+// starts a new bin, i.e. the previous one just closed
+bool modelAccumulate(const SensorSample &s, const ImuFeatures &f, psi_t maxPsi, ModelBinFeatures &closed);
+void modelQuantizeBin(const ModelWeights &w, const ModelBinFeatures &bin, int8_t out[MODEL_CHANNELS]);
+// window is oldest step first
+void modelClassify(const ModelWeights &w, const int8_t window[MODEL_STEPS][MODEL_CHANNELS], ModelOutput &out);
+
+void runModelDetection(const SensorSample &s, DetectionResult &r);
+void resetModelEngine();
@@ -0,0 +1,74 @@
+// Generated by HostReplay/train_model - do not edit.
+// 21216 windows from 24 synthetic 90s sessions, labelled by the rule engine.
+// int8 agreement with the labels: motion 87.7% (94.5% on motion windows), grip 98.8%
+#pragma once
+
+#include "model_engine.h"
+
+const ModelWeights MODEL_WEIGHTS = {
+  { 245, 222, 508, 73, 257, 416153, 2774, 2774 },
+  {
+    { { -5, -1, -7, 1, -6, 10, -1, -2 }, { 15, 13, 12, 8, 20, -3, -9, 2 }, { 35, 40, 19, 13, 11, -11, 5, 5 } },
+    { { -15, -3, 11, 8, -2, 17, -15, 3 }, { -22, 30, -6, 23, -23, 7, 0, -4 }, { -15, -4, -4, -7, 13, -54, 19, 3 } },
+    { { -2, 20, -15, -13, -56, -5, 0, 9 }, { -24, 38, -9, -12, 1, -59, -8, 11 }, { -19, 33, -8, 10, 51, -62, -20, 7 } },
+    { { -1, -11, 7, -1, -3, -13, -5, 2 }, { 7, 33, -10, 3, 34, -17, -24, 11 }, { -9, -7, 8, -5, -16, 25, 21, 5 } },
+    { { 5, -9, 2, -6, 0, -3, 10, 4 }, { -4, -10, -2, 3, 2, -2, 23, 16 }, { -10, -2, 9, 16, -5, 8, -59, -4 } },
+    { { 4, 17, -9, -9, -9, -13, 7, -5 }, { 1, -1, -22, -14, -46, -29, 3, 0 }, { 27, 40, -22, 1, -78, 36, 10, -13 } },
+    { { 4, -14, 10, 6, 5, 2, 5, 12 }, { 5, -26, 27, 14, -14, 4, 2, 5 }, { -17, -18, -26, 22, -14, 4, -21, -15 } },
+    { { 0, 2, 8, 3, 10, -12, -3, 14 }, { 17, -4, 20, 11, 16, -1, -10, 1 }, { 25, 13, -37, 32, 23, 17, -12, -10 } },
+    { { -21, -32, 27, -14, 8, 57, -2, -4 }, { -11, -29, 27, 13, 5, 14, 1, 9 }, { 14, -9, -13, 37, -31, 62, 8, -8 } },
+    { { -14, 8, 9, 16, 5, 3, 11, 1 }, { -11, 13, -1, 11, -18, -13, -8, 3 }, { -9, -3, -19, -4, -10, -15, -23, -28 } },
+    { { -4, 0, 3, 13, -10, -3, -8, -10 }, { 11, 7, 12, 3, 17, 5, -11, 5 }, { -1, 0, 4, -13, 11, 26, -94, -127 } },
+    { { 26, -7, 13, 5, -19, -11, -3, 12 }, { -4, -35, -10, 9, 26, 7, -11, -8 }, { 12, -27, -45, 2, 15, 2, 13, 7 } },
+    { { 12, 9, 4, 7, 11, -26, -3, 17 }, { 23, -2, -15, -20, -4, -27, -5, 1 }, { 56, -15, 28, -33, -15, -74, -3, -3 } },
+    { { -19, 35, -4, 18, 21, -26, -19, 4 }, { -20, 41, -8, -3, -26, -38, 0, 9 }, { -51, -42, -7, -8, -20, -116, 6, 4 } },
+    { { -4, -39, -43, -7, 7, -10, 1, 2 }, { -14, -38, 3, 25, -24, 7, -3, -4 }, { 51, -38, 25, -3, 5, 21, 20, -1 } },
+    { { -35, -29, -40, -1, -13, 13, 7, -11 }, { -74, -41, -37, -16, 1, -30, 2, 0 }, { -10, 12, -1, -9, 10, -8, 8, -7 } },
+  },
+  { -6027, 166, -194, -1085, 1658, 872, 918, -949, 1092, 1407, 2177, 130, -655, 157, -144, 4262 },
+  1094295138, 37,
+  {
+    { -8, 7, 5, 0, 8, -6, -2, 17, 3, 7, -5, -4, 20, -3, 24, -4, 3, -6, -6, 11, 1, 3, -1, 6, 0, -4, 4, 2, -4, 10, -5, 3, 5, -23, -6, 4, 31, -2, 21, 20, 15, 13, 6, 6, 13, -6, -13, 17, -11, 20, 6, -8, 0, -14, 26, -6, 16, 15, -13, -12, -9, 6, 13, 11, -20, -4, 1, -22, -1, 18, -12, -1, -8, -2, 6, -4, 12, -2, -26, -26, -15, 0, 5, -26, 4, 14, 13, 0, 7, 13, -8, 8, -6, -7, -6, -45, -31, -20, -22, 26, 22, 12, 3, -9, 1, -1, -4, -15, 42, -33, 39, -36 },
+    { -5, -1, -15, 19, -3, -2, -16, 13, 12, 13, 0, -17, 9, -18, 0, 4, -11, -14, 3, -10, 3, -2, -1, -7, -24, 15, -2, -8, -10, -4, 22, -14, 18, -26, -24, -7, 23, -7, 18, 31, 21, 9, 34, 34, 9, -21, 6, 16, 3, 15, 2, 1, 14, -26, 7, -12, 16, 17, -4, -26, -23, -13, 44, 13, -21, 14, 10, 11, 2, 6, -5, 12, -22, 2, -11, 3, -4, 19, -90, -37, -19, -3, 31, -11, 8, 22, -37, -11, -26, -7, -2, -14, -12, -3, -40, -19, -14, -8, -13, 4, -12, 20, -5, -8, 12, 0, -11, 13, -19, 14, -21, -11 },
+    { -12, 1, 21, 4, 0, 10, -9, -7, -17, -12, 1, -14, -6, -16, -21, 1, 14, -2, -7, 12, 3, 2, 15, 0, -6, -2, 12, 13, -2, -6, 16, -1, 7, -2, -11, -16, 7, 5, 19, -14, 16, -18, -13, -10, -4, -7, -14, 10, 5, -3, 19, 4, 7, -9, -1, 9, 0, 5, -1, 20, -18, 3, 6, 4, 6, -15, -30, -3, 20, -11, -10, 8, -9, -12, 15, 12, -46, -4, -19, 12, -7, 21, -3, -6, 9, -4, 1, -25, 8, -16, 4, -12, -27, 11, 5, 23, -63, 19, -40, 2, -32, -33, -2, -30, -27, -34, -3, 3, -2, 25, 30, 24 },
+    { -1, 9, 8, 0, -5, 10, 10, 7, 5, 22, -13, -10, 18, 23, 14, 9, -10, 7, -7, 6, 0, 11, -1, 4, 4, 23, 11, 18, 11, 3, -8, -6, -9, 5, 3, -1, 3, -6, -11, -7, -10, 25, 9, 10, 14, 26, 15, -17, -10, 13, 4, 5, 6, -4, 5, 0, 10, 18, -16, 6, 1, -11, 1, 7, -14, -8, -26, -10, 13, -1, 12, 2, 6, 8, 2, 21, 15, -4, -3, -11, -16, 18, -9, -14, 11, 11, 5, 7, 6, 14, -14, 0, -18, -24, 12, -22, -66, -24, -21, 32, 13, 3, 6, 12, -11, 16, -2, -4, -16, -23, 10, -87 },
+    { 3, 4, 3, 0, 0, -9, -10, 3, -4, 4, -8, 6, -6, 6, -4, 0, 3, -6, 2, 4, 3, -1, 3, 1, 0, 0, 3, -6, -5, 4, -1, 7, -3, -7, -6, -10, -7, -9, 0, -10, -6, 5, -2, -7, -4, -10, 5, -9, 3, -8, 0, -6, 5, 7, 5, -3, -8, 4, -7, -1, -3, 4, 2, -1, 4, -9, -9, -8, -7, -4, -2, 3, -6, -5, -8, 2, 1, -9, -9, 4, -7, -9, -3, -1, 0, -7, 0, -4, -2, -3, -8, 0, 1, 5, -3, -8, -3, -10, -6, -1, -5, -6, 2, -4, 0, -7, 6, 2, -5, 5, 5, -8 },
+    { -5, -1, -5, 8, 11, -1, 14, -1, 14, 14, -4, -15, -2, -10, 18, 6, 4, -18, 16, -16, -2, -6, -1, -4, -5, 6, 5, -4, -11, -22, -10, -11, 9, 12, 12, -15, 16, -11, 0, 4, -5, 15, -15, 12, 0, 22, 13, -9, 7, 0, 41, 13, -20, -9, 0, -3, -7, 0, -9, -9, 1, -6, -5, 9, 10, -2, -21, -7, -17, -4, -7, -3, 3, 9, 12, 3, -6, 15, 1, 8, 9, -2, 1, 7, -8, -4, 6, -8, -4, 26, -1, -11, 6, -9, -18, -10, 71, 4, 29, -48, 16, 20, -15, 12, 25, 9, 1, -49, 44, -9, 12, 40 },
+    { 0, -1, 0, -3, -4, 1, 5, -5, -9, 2, -1, -6, -5, -7, 5, 1, 4, -11, -3, -5, 1, -4, 3, 3, -4, -1, 0, 5, 3, -2, -7, -8, -11, -11, -6, 3, -3, 2, -2, -3, -5, -4, -12, -7, -6, -4, 3, 0, -7, -7, -3, -6, 2, -9, 3, -1, -1, 1, -10, -7, -9, -8, -9, -1, -6, -6, -1, 2, -7, -3, -8, -2, -6, -3, -1, 2, -2, -8, -5, -5, -10, -10, -1, -1, 5, 0, -8, -7, 0, 1, -4, 4, 2, -6, -4, -5, -2, -10, -2, 0, -10, 0, -4, -11, -10, -6, 0, 0, -10, -2, 7, -9 },
+    { 18, 3, -9, -1, 9, 1, 8, 2, 15, 6, -9, 11, 19, 4, 7, 12, 0, 14, 13, 1, 0, -14, -8, -10, 0, 0, -9, 0, -3, 14, -17, 16, 6, -4, 13, 4, 6, -2, -17, 2, -10, 8, -1, 4, -17, 15, -1, -4, 6, -10, -5, -12, 9, 12, 5, -13, -4, -8, 13, 3, 5, 9, 5, 11, 15, 5, 6, 5, 28, 4, 6, 3, -8, 11, 7, -1, -4, -1, 0, 14, 12, 11, 19, 6, 16, 9, 8, -7, 0, 2, 6, -20, -5, 5, -3, 9, 19, 16, -12, 19, -72, 12, -10, -23, 14, -36, -73, 5, 16, 18, 23, 8 },
+    { 4, -24, -18, -26, 5, 5, 9, -13, 2, 5, 6, 3, 1, 22, 2, 12, 14, 13, 12, -7, 0, 14, -6, 13, -18, 15, -13, -5, 4, 19, -2, 1, 1, 6, 14, 14, -5, 12, -11, -12, 9, 1, 7, 4, 6, 2, 7, 14, -3, -12, -25, 13, 15, 14, -3, 6, 7, -8, 4, 1, 15, 8, -3, 12, -4, -2, -6, -8, -10, -26, 18, 7, 8, 0, -6, 18, 8, -5, 29, 7, -6, -18, -24, 17, -4, -11, 20, 7, 21, 17, -4, 9, -12, -26, -17, 8, -20, 9, 7, 10, 14, 7, -2, 46, -16, 10, 15, 14, -40, -16, -25, -12 },
+    { -9, 1, 1, -11, 2, -1, -8, -4, -3, -5, -5, -1, 1, -8, 3, 1, -7, -12, 1, -5, 4, 0, -9, 0, -6, -3, -7, 2, -5, 2, 3, 2, 6, -5, -8, -6, -4, -4, -1, 3, -8, 5, -3, -2, -11, -3, -2, 2, 3, -10, 6, 6, 1, -12, -7, -7, 2, -8, -2, 1, -10, -3, -8, -1, -7, 0, -9, -10, -3, -6, 1, -8, 7, -10, 4, -10, 0, 3, -12, -16, -2, -1, 0, -5, 0, 0, -8, -6, -1, -6, 2, -2, -2, 8, -7, -6, -13, -6, -8, -3, -13, -1, 1, -7, -9, 2, -7, -5, 2, -6, 0, 2 },
+    { -4, 20, 27, -1, -6, -6, 2, -21, 9, 26, -19, -9, 6, -4, 12, -2, -9, -19, 21, 24, 2, 5, -15, 7, -8, -9, 15, 30, -11, -6, -24, 7, 18, -14, -20, -5, -1, -7, -2, -6, 10, 5, 10, 4, -7, 1, 6, 14, 12, 12, 6, 16, 5, -5, -7, -3, 9, 13, -6, 4, -5, -5, 11, 15, -14, -2, -12, 8, 2, 25, 7, -6, -3, 8, 7, 0, 26, 33, -21, -14, -13, 28, 32, -9, 13, 2, 8, -23, -14, -10, 8, -15, -7, 17, -5, -13, -16, 21, 44, -13, -43, 3, -14, -19, -31, -31, -4, -5, -3, -20, -9, -21 },
+    { -8, -3, 8, 1, -9, -7, -5, -13, -3, 2, 3, 2, 2, -9, 2, -4, -14, -12, 2, -2, -6, -9, -3, -8, 0, 10, 12, -2, -13, -10, -10, -15, -10, -7, 2, -9, -12, -4, -9, -10, 3, 6, -5, 3, -2, -4, 0, 3, 4, -5, -7, -5, -20, 1, -6, 5, 1, -1, -9, 3, -11, -8, -10, -9, -6, -4, -15, -2, -9, 2, -4, 2, 4, -4, 3, -2, -16, -11, 5, -10, -7, -12, -18, 0, -17, 3, 1, -2, -7, -6, -3, 4, -15, -9, -2, -12, -7, 0, -21, -6, -16, 0, -3, -3, -4, 0, 3, -5, -14, -3, -5, -14 },
+    { 23, -3, -2, 14, -19, -16, 16, 9, 40, -1, -1, 0, 20, -1, 7, 9, -2, -28, 1, -1, 13, 4, 17, -7, 4, 0, 0, 23, 13, 3, -19, 14, 3, -39, -3, 0, 10, -10, 33, -13, -6, -5, -2, -24, 13, -32, -22, 40, -14, -26, -17, -10, -10, -13, 16, 7, -9, 14, 6, 21, 10, -14, -25, -19, -5, -2, -2, 5, 6, -19, 0, -18, -16, 17, 3, -4, -5, -3, -37, -1, -31, -11, -6, -45, 23, 3, 26, -13, -2, 6, -8, -2, -6, -9, -5, 10, -2, -39, -4, -35, -4, -18, -18, -31, -6, 8, 23, -19, 1, 12, 1, 3 },
+    { 14, -11, -26, -10, -13, -20, 9, -28, 33, -12, 19, 1, 2, -26, 23, 15, 27, -19, -18, -5, 13, -2, -3, -10, 20, -2, 18, 4, 10, -20, 6, 19, 6, -6, -16, -7, -17, 17, -17, -16, 2, -25, -11, 5, -4, -10, 16, 23, 5, 11, -4, -2, -42, -2, -17, -17, -14, -18, -25, 24, 6, 12, 15, 3, 11, 0, -12, 11, 21, -10, 11, -11, 21, 12, -13, -2, -24, 6, -4, 7, -43, 4, 11, -5, 17, 6, 9, -17, -20, 14, -7, -10, -1, 16, -10, 1, -36, -7, 14, -15, 17, -20, 10, -44, -30, 7, 17, -4, -39, 1, -22, 19 },
+    { -23, 15, -7, -4, -28, -3, -18, -12, 32, -51, -45, 5, -17, 24, -4, -17, 3, -3, 8, 0, -11, 7, -4, 1, -38, -39, -8, -10, 5, -3, 11, -8, 25, -3, -4, 5, -4, 6, 3, 4, 17, -45, -45, 31, 7, 10, 7, 20, 14, 28, 6, 31, 22, -7, 17, 5, 30, 16, -54, -36, 5, 5, 31, 13, -41, -6, 4, -8, -14, -4, 20, -5, -13, 4, 6, 22, -1, -23, -21, -126, -5, -8, 11, -8, 17, 8, 0, -8, 4, 13, -9, 3, 9, -7, -3, -17, -41, -3, 0, -5, -15, 17, -23, 20, -7, -7, 13, 7, -7, -27, -21, -45 },
+    { -12, 0, 11, -6, -8, 2, -7, -6, -7, 12, -3, 16, -5, -1, 35, 6, -3, 9, -12, 24, 7, -10, 6, -9, 1, -6, 5, 11, -1, 7, -4, -8, -3, 17, -9, 3, -1, 9, -3, 6, -7, 0, -4, -10, 14, 7, 2, -31, 6, 1, 2, 3, -1, 25, -10, 8, -3, -17, 7, -15, 14, -27, -3, -9, -22, -7, 1, -9, 9, 12, 21, -9, 5, 5, 6, 3, 8, -15, 19, -44, 6, -1, 18, -4, -6, 6, 20, 16, 15, 1, -12, -23, 57, 2, -10, -48, 21, -1, 29, -25, 18, 14, 37, 37, 26, 17, -9, 12, 20, -28, -7, -33 },
+    { 18, -4, 2, 6, 1, 2, 8, -1, -13, -17, -6, 20, 2, -10, 15, 7, -14, 18, 6, 7, -16, -2, -2, 5, 11, 14, -4, 16, 13, 14, 1, 4, -2, 5, -1, 9, -17, -8, 9, 9, 6, 6, -18, 0, 0, -5, 4, -23, -15, -4, 11, -13, 5, 18, 1, 6, -7, 1, 11, 2, 7, -9, -10, 1, 18, 18, 5, 31, -3, 10, -4, -5, 11, 10, -14, -13, -14, 20, 7, 22, 9, 7, -1, -7, 3, 5, -4, 5, -4, 21, 6, -10, -5, 12, -1, 20, -3, -21, -2, -21, 69, -22, 21, -3, -8, 42, 53, -24, -15, 24, -3, 30 },
+    { 0, 11, 24, -12, 0, 0, -1, -12, -8, 17, 0, 1, -7, 1, 9, 12, 7, 6, -3, 21, 7, 7, -1, -8, 7, 15, 17, -3, 14, -9, -14, -3, 7, 14, -7, -41, 7, 30, 2, -9, 14, 10, -10, -20, 8, -7, 23, 4, 14, 8, 42, -1, -11, -24, 2, 7, -19, 9, -11, 18, 8, 2, 12, -11, -13, 1, -39, -3, 3, 2, 13, 8, 29, 0, 19, 12, -4, -22, -15, 2, -3, 19, -27, -5, 6, -4, 21, -11, 34, 14, -16, -4, -7, -11, 13, 5, -23, -5, -31, 24, -1, 4, 17, -5, 52, -1, 0, -14, 2, -13, 13, -16 },
+    { 6, -17, 0, 7, 22, 7, -12, 15, 7, 14, 6, 2, 2, -5, -24, 1, 8, -4, 6, 0, 18, -1, 1, 2, 9, 6, -11, -4, 3, -6, 12, 15, -9, -1, 3, -18, 8, -4, 7, 2, 7, 21, -6, -4, 4, 4, -4, 1, -17, -5, 3, 10, 22, 24, 10, 3, -2, 12, -10, -9, 3, -7, -15, -37, 4, 2, 23, -11, 12, 3, -3, 7, -24, 11, 11, -12, 6, -11, -7, -19, 16, -3, -3, -12, 13, -24, 12, 9, 8, 10, -1, 8, 25, -7, 16, 18, -10, 15, 4, 27, -75, -22, 5, -24, -12, -17, -127, 32, 20, -14, 38, 23 },
+    { 9, -12, -29, 5, 2, 2, -9, 4, -18, 11, 3, 0, 1, 3, -11, 0, 3, 8, 9, -2, -1, -1, -9, 3, -14, 24, 0, -14, -1, 19, 11, -13, -17, -22, 21, -29, 14, 18, 10, 3, 19, 6, -5, 12, 4, -17, -29, 37, 11, -11, -3, -7, 24, 6, 3, 6, 4, 7, -16, -17, 0, 7, 18, -19, 26, -17, 7, 4, 6, -29, 2, 19, -3, 5, 11, 12, -7, -11, 18, 23, 19, -19, -7, 12, 16, -29, 2, 12, 14, -3, 15, 3, -6, -26, 23, 38, 24, 8, -22, -1, -38, -39, 9, 30, -20, -3, -28, 37, -10, -4, 4, 13 },
+    { 9, -1, 0, 17, 5, -2, -2, 30, -9, 20, 1, -16, 0, 10, -6, 3, 28, -4, -28, 12, -9, -11, -6, 14, 11, 11, 14, 0, 11, -3, 25, 0, -4, 7, -13, -7, -1, -6, 10, 0, 4, -5, -6, -11, -1, -11, 13, 8, -3, -21, 3, -13, -2, -5, 19, 2, 21, -12, -7, 36, 14, -26, 17, 2, 7, -4, -43, 13, -6, -19, 14, 5, 34, -9, 15, 9, -13, -13, 13, 19, 30, 2, -37, 0, 20, -21, 33, 8, 27, 10, 1, -6, 54, -6, 30, 12, 93, -7, -18, -14, 10, -14, 11, 9, 34, -10, -10, -8, 68, -33, 23, 5 },
+    { 9, 6, -4, -17, -1, -2, 23, 5, 16, 21, -9, -3, 3, 30, 8, 9, -4, 4, 11, 11, 0, 3, 10, -2, 1, -2, 9, 0, -3, -1, -16, 7, -8, 15, 12, -32, 0, -2, -5, -4, 1, 4, -5, 6, 4, 15, 12, 27, -1, 7, 17, 30, 0, -9, -13, 9, 4, -1, -3, -9, -9, 14, 0, 0, -3, 1, 13, 11, 7, 11, -15, 3, -5, 11, 9, -7, 18, -3, -3, 1, 5, 5, 12, 14, -18, -9, -12, -3, 4, -7, 8, -5, -2, 10, -7, -2, -10, -13, 47, 1, 59, -17, -5, -21, -51, 23, 23, -4, 27, -26, 11, -40 },
+    { 16, -8, -11, 9, 23, -8, -5, -7, -1, -5, 12, 15, -12, 15, -1, 11, 9, 12, 1, -10, -3, 1, 6, 4, 7, -5, -10, -15, -5, 18, 31, 7, -21, 1, 4, 20, 1, -11, -1, -9, 12, -9, 2, 6, -8, -6, -5, -12, 3, -8, -20, -6, -6, 21, -5, -2, -5, 12, 9, -13, 15, 22, -18, -19, 4, 8, 16, -4, 1, -22, -4, 13, -17, -4, -7, -3, -1, 8, 20, -3, -3, -9, -12, 14, -14, 13, -1, 21, -2, -21, 0, 17, -10, -17, -29, -15, 21, -1, 13, -17, -6, 53, -17, 55, 37, -8, -30, 18, -26, -16, 3, 21 },
+    { 1, -7, 2, 2, -6, -1, 0, 4, -13, -10, 14, 3, -5, -19, -6, -1, 5, 9, -5, 4, 1, -6, 3, 6, 21, 18, 11, -4, 24, -9, 11, 6, -19, -4, -6, -3, 9, -5, 22, 4, 12, 7, -25, 8, 18, 0, 14, -4, -18, -5, 17, -8, 15, 8, 3, 13, -8, 16, 6, 16, 16, 3, -8, -10, 8, 8, 10, 18, 2, 6, -6, 4, 5, 1, -23, 9, 2, -3, 9, 23, 3, 24, 13, 0, 14, 0, -6, 9, 8, 2, -9, 10, -4, 22, 7, 21, -51, 10, -4, 9, -25, -15, 22, -9, 2, 6, 2, 4, -30, 6, 0, 6 },
+  },
+  { 271, 122, 171, 1370, -65, -1154, -179, 268, -293, -160, 681, -160, -227, -266, 265, 320, -343, 785, 125, -452, -449, 335, -668, 841 },
+  1392248084, 38,
+  {
+    { 0, -20, 20, 9, -6, -22, 5, -5, -1, -3, 2, -11, 9, 19, -22, 11, -6, 8, -1, 13, -4, 7, -14, 16 },
+    { -13, -37, 35, -62, -2, 30, -1, -5, 5, 5, -6, 2, 20, 29, -37, 11, -6, -3, 0, 16, 13, -24, 27, -31 },
+    { -9, 8, 4, 1, -13, 13, -13, 5, -24, -10, -3, 10, -5, 17, 7, -72, 19, -2, -33, -71, -63, -9, -2, 16 },
+    { 7, -2, 30, -57, -11, 29, 14, 13, -22, -13, -12, -15, -16, 2, -28, 14, -11, -5, 19, 15, 13, 18, -64, -65 },
+    { -43, -37, -26, 16, 7, 5, 8, 13, 12, -8, 5, 4, -65, -77, -45, -81, 3, 5, -44, -16, -127, 8, -15, 2 },
+    { -11, -11, -2, 6, -13, -77, 12, -15, 23, -8, -82, 8, -17, -25, -13, -24, -6, -71, -2, 27, -20, 0, 16, 14 },
+    { 11, -4, -42, 14, 14, -18, 5, -7, 6, -7, -29, 2, 20, 2, -9, 0, -10, 23, -8, -1, 2, -22, 16, -4 },
+    { 24, 25, -103, 23, -15, -17, -10, -36, -17, 5, 18, -1, -39, -25, 46, 10, -47, 7, -34, -74, -72, 17, -102, -20 },
+    { 3, 6, 2, 15, -9, 11, -4, -19, 11, -7, -4, -1, -7, 7, -9, 11, 31, 8, -28, 2, -10, 13, -4, -5 },
+    { -34, -17, -10, 4, 5, -16, 14, -112, -36, 14, -20, 0, -39, -4, -48, -20, -36, -23, -8, -8, -5, -52, -35, -45 },
+    { -11, -5, -9, -21, -18, -20, -4, -104, -3, -2, -22, -1, -45, 7, -27, -23, -35, -31, -1, -27, -7, -49, -62, -44 },
+    { -25, -18, 2, 2, 3, -32, 14, -98, -17, -13, -16, -15, -72, -13, -42, -28, -33, -31, -12, -17, -7, -31, -71, -44 },
+    { -1, 10, 11, 16, -3, 0, 1, 36, -9, 12, 15, -2, -11, -9, -9, 8, -19, 9, 43, 13, -8, -20, 12, 7 },
+  },
+  { 111, -212, 6, -111, 41, -135, 13, 14, -70, -26, -24, -39, 93 },
+};
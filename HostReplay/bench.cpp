@@ -0,0 +1,211 @@
+// Throughput benchmark for the firmware detection core.
+//
+//   bench [-n passes] [trace.csv]
+//
+// Without a trace a deterministic 60s synthetic one at 500Hz is used (rest,
+// grips, shaking, free fall, spinning). Reports full-pipeline samples/s, the
+// per-stage split from the detectionStageDone hook, and the cost of each
+// motion detector run alone over precomputed features. Host numbers are for
+// spotting regressions, not a substitute for PROF on the device.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "detection.h"
+#include "model_engine.h"
+#include "trace.h"
+
+typedef std::chrono::steady_clock BenchClock;
+
+static const BenchClock::time_point benchEpoch = BenchClock::now();
+static uint64_t stageNs[DETECT_STAGE_COUNT];
+static const char *STAGE_NAMES[DETECT_STAGE_COUNT] = { "psi", "pattern", "motion" };
+
+// detectionClock hook: nanoseconds, wrapping at 2^32 (only differences are used)
+static uint32_t benchNowNs() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - benchEpoch).count();
+}
+
+static void benchStageDone(DetectionStage stage, uint32_t start) {
+  stageNs[stage] += (uint32_t)(benchNowNs() - start);
+}
+
+static double secondsSince(BenchClock::time_point start) {
+  return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+static void synthTrace(std::vector<SensorSample> &out) {
+  const unsigned long hz = 500;
+  const unsigned long durationMs = 60000;
+  uint32_t rng = 12345;
+
+  for (unsigned long i = 0; i < durationMs * hz / 1000; i++) {
+    rng = rng * 1664525 + 1013904223;
+    int noise = (int)(rng >> 20) - 2048;  // ±2048 counts
+    unsigned long t = i * 1000 / hz;
+    unsigned long phase = t % 10000;       // 10s cycle of behaviours
+
+    SensorSample s = {};
+    s.timeMs = t;
+    s.az = 16384;                          // 1g at rest
+    s.ax = noise;
+    s.ay = -noise / 2;
+
+    if (phase < 2000) {
+      // Five squeezes of 200ms, 200ms apart, strongest on pad 0
+      uint16_t code = (phase % 400 < 200) ? 3200 : 200;
+      for (int c = 0; c < FSR_CHANNEL_COUNT; c++) s.fsrRaw[c] = code / (c + 1);
+    } else if (phase < 4000) {
+      // Violent shaking: accel swings every few samples
+      s.ax = ((i / 4) & 1) ? 30000 : -30000;
+      s.fsrRaw[0] = 1500;
+    } else if (phase < 4300) {
+      // Free fall
+      s.ax = s.ay = s.az = (int16_t)(noise / 4);
+    } else if (phase < 5000) {
+      s.gz = 30000;
+    } else if (phase < 6000) {
+      // Tremble: small fast magnitude changes
+      s.az = 16384 + (((i / 2) & 1) ? 8000 : -2000);
+    }
+    out.push_back(s);
+  }
+}
+
+// Time one detector over the precomputed feature stream
+template <typename Detector, typename Fn>
+static double detectorNs(const std::vector<SensorSample> &trace, const std::vector<ImuFeatures> &features,
+                         int passes, Fn update) {
+  volatile unsigned hits = 0;
+  BenchClock::time_point start = BenchClock::now();
+  for (int p = 0; p < passes; p++) {
+    Detector d;
+    for (size_t i = 0; i < trace.size(); i++) {
+      if (update(d, trace[i], features[i])) hits = hits + 1;
+    }
+  }
+  return secondsSince(start) * 1e9 / ((double)passes * trace.size());
+}
+
+int main(int argc, char **argv) {
+  int passes = 50;
+  const char *path = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      passes = atoi(argv[++i]);
+    } else if (argv[i][0] == '-') {
+      fprintf(stderr, "usage: %s [-n passes] [trace.csv]\n", argv[0]);
+      return 2;
+    } else {
+      path = argv[i];
+    }
+  }
+  if (passes < 1) passes = 1;
+
+  std::vector<SensorSample> trace;
+  if (path) {
+    if (!loadTrace(path, trace)) return 1;
+  } else {
+    synthTrace(trace);
+  }
+  if (trace.empty()) {
+    fprintf(stderr, "empty trace\n");
+    return 1;
+  }
+
+  rebuildPSITable();
+  double totalSamples = (double)passes * trace.size();
+  printf("trace: %s, %zu samples x %d passes\n", path ? path : "synthetic", trace.size(), passes);
+
+  // Full pipeline, no hooks
+  volatile unsigned alerts = 0;
+  BenchClock::time_point start = BenchClock::now();
+  for (int p = 0; p < passes; p++) {
+    resetDetection();
+    for (size_t i = 0; i < trace.size(); i++) {
+      DetectionResult r;
+      runDetection(trace[i], r);
+      if (r.motionTriggered || r.patternStep == PATTERN_TRIGGERED) alerts = alerts + 1;
+    }
+  }
+  double elapsed = secondsSince(start);
+  printf("pipeline: %.0f samples/s (%.1f ns/sample), %u alerts per pass\n",
+         totalSamples / elapsed, elapsed * 1e9 / totalSamples, alerts / passes);
+
+  // Same again with the stage hooks installed
+  detectionClock = benchNowNs;
+  detectionStageDone = benchStageDone;
+  for (int p = 0; p < passes; p++) {
+    resetDetection();
+    for (size_t i = 0; i < trace.size(); i++) {
+      DetectionResult r;
+      runDetection(trace[i], r);
+    }
+  }
+  detectionClock = nullptr;
+  detectionStageDone = nullptr;
+  printf("stages (ns/sample, includes clock overhead):");
+  for (int st = 0; st < DETECT_STAGE_COUNT; st++) {
+    printf(" %s=%.1f", STAGE_NAMES[st], stageNs[st] / totalSamples);
+  }
+  printf("\n");
+
+  // Feature pass alone, then each detector over the stored features
+  std::vector<ImuFeatures> features(trace.size());
+  start = BenchClock::now();
+  for (int p = 0; p < passes; p++) {
+    imuFeatureState = ImuFeatureState();
+    for (size_t i = 0; i < trace.size(); i++) extractImuFeatures(trace[i], features[i]);
+  }
+  printf("detectors (ns/sample): features=%.1f", secondsSince(start) * 1e9 / totalSamples);
+
+  printf(" impact=%.1f", detectorNs<ImpactDetector>(trace, features, passes,
+         [](ImpactDetector &d, const SensorSample &, const ImuFeatures &f) { return d.update(f); }));
+  printf(" bounce=%.1f", detectorNs<BounceDetector>(trace, features, passes,
+         [](BounceDetector &d, const SensorSample &s, const ImuFeatures &) { return d.update(s, s.timeMs); }));
+  printf(" freefall=%.1f", detectorNs<FreeFallDetector>(trace, features, passes,
+         [](FreeFallDetector &d, const SensorSample &s, const ImuFeatures &f) { return d.update(f, s.timeMs); }));
+  printf(" shake=%.1f", detectorNs<ShakeDetector>(trace, features, passes,
+         [](ShakeDetector &d, const SensorSample &s, const ImuFeatures &f) { return d.update(f, s.timeMs); }));
+  printf(" spin=%.1f", detectorNs<SpinDetector>(trace, features, passes,
+         [](SpinDetector &d, const SensorSample &s, const ImuFeatures &) { return d.update(s, s.timeMs); }));
+  printf(" rock=%.1f", detectorNs<RockDetector>(trace, features, passes,
+         [](RockDetector &d, const SensorSample &s, const ImuFeatures &f) { return d.update(f, s.timeMs); }));
+  printf(" tremble=%.1f", detectorNs<TrembleDetector>(trace, features, passes,
+         [](TrembleDetector &d, const SensorSample &s, const ImuFeatures &f) { return d.update(f, s.timeMs); }));
+  printf("\n");
+
+  // Model engine: full pipeline, then one inference on a fixed window
+  detectionConfig.engine = ENGINE_MODEL;
+  start = BenchClock::now();
+  for (int p = 0; p < passes; p++) {
+    resetDetection();
+    for (size_t i = 0; i < trace.size(); i++) {
+      DetectionResult r;
+      runDetection(trace[i], r);
+    }
+  }
+  elapsed = secondsSince(start);
+  detectionConfig.engine = ENGINE_RULES;
+
+  int8_t window[MODEL_STEPS][MODEL_CHANNELS];
+  for (int s = 0; s < MODEL_STEPS; s++) {
+    for (int c = 0; c < MODEL_CHANNELS; c++) window[s][c] = (int8_t)((s * 7 + c * 13) & 127);
+  }
+  const int inferences = 20000;
+  volatile int sink = 0;
+  BenchClock::time_point inferStart = BenchClock::now();
+  for (int i = 0; i < inferences; i++) {
+    ModelOutput out;
+    window[i % MODEL_STEPS][i % MODEL_CHANNELS] ^= 1;
+    modelClassify(MODEL_WEIGHTS, window, out);
+    sink = sink + out.motion;
+  }
+  printf("model: %.0f samples/s (%.1f ns/sample), inference=%.0f ns, arena %zu/%zu bytes\n",
+         totalSamples / elapsed, elapsed * 1e9 / totalSamples, secondsSince(inferStart) * 1e9 / inferences,
+         MODEL_ARENA_USED, MODEL_ARENA_BYTES);
+  return 0;
+}
@@ -0,0 +1,125 @@
+// Feed recorded traces through the firmware detection core and print what the
+// ball would have done: grip state changes, pattern steps, motion triggers.
+//
+//   replay [-q] [-s key=value ...] trace.csv [trace2.csv ...]
+//
+// -q prints only alerts and the per-trace summary.
+// -s overrides one config registry entry (same keys as the firmware's CFG:SET).
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "detection.h"
+#include "trace.h"
+
+static bool quiet = false;
+
+static void replayTrace(const char *path) {
+  std::vector<SensorSample> trace;
+  if (!loadTrace(path, trace)) return;
+
+  resetDetection();
+
+  unsigned patternAlerts = 0;
+  unsigned motionAlerts = 0;
+  unsigned motionHits[MOTION_TYPE_COUNT] = {};
+  unsigned gripMs[GRIP_TANTRUM + 1] = {};
+  psi_t peakPSI = 0;
+  int peakPad = 0;
+
+  printf("== %s (%zu samples)\n", path, trace.size());
+  for (size_t i = 0; i < trace.size(); i++) {
+    const SensorSample &s = trace[i];
+    DetectionResult r;
+    runDetection(s, r);
+
+    if (r.maxPSI > peakPSI) {
+      peakPSI = r.maxPSI;
+      peakPad = fsrFeatures.maxChannel;
+    }
+    if (i > 0) gripMs[currentGripState] += s.timeMs - trace[i - 1].timeMs;
+    motionHits[r.motion]++;
+
+    if (!quiet) {
+      if (r.gripChanged) {
+        printf("%8lu GRIP    %s -> %s (%.2f psi)\n", s.timeMs, gripStateToString(r.previousGrip),
+               gripStateToString(currentGripState), psiToFloat(r.maxPSI));
+      }
+      if (r.patternStep == PATTERN_GAP_VALID) {
+        printf("%8lu PATTERN grip #%d after %lums\n", s.timeMs, sequenceCount, patternGapMs);
+      } else if (r.patternStep == PATTERN_GAP_RESET) {
+        printf("%8lu PATTERN gap %lums too long, restart\n", s.timeMs, patternGapMs);
+      }
+    }
+
+    if (r.patternStep == PATTERN_TRIGGERED) {
+      patternAlerts++;
+      printf("%8lu ALERT   %d-grip pattern, dominant %s\n", s.timeMs, GRIP_PATTERN_COUNT,
+             gripStateToString(dominantGripType));
+    }
+    if (r.motionTriggered) {
+      motionAlerts++;
+      printf("%8lu ALERT   %dx %s\n", s.timeMs, r.repeatCount, motionToString(r.repeatMotion));
+    }
+  }
+
+  unsigned long durationMs = trace.empty() ? 0 : trace.back().timeMs - trace.front().timeMs;
+  printf("-- %.1fs, peak %.2f psi (pad %d), %u pattern alerts, %u motion alerts\n",
+         durationMs / 1000.0, psiToFloat(peakPSI), peakPad, patternAlerts, motionAlerts);
+  printf("   grip ms:");
+  for (int g = GRIP_NONE; g <= GRIP_TANTRUM; g++) {
+    printf(" %s=%u", gripStateToString((GripState)g), gripMs[g]);
+  }
+  printf("\n   motion samples:");
+  for (int m = MOTION_NONE + 1; m < MOTION_TYPE_COUNT; m++) {
+    printf(" %s=%u", motionToString((MotionType)m), motionHits[m]);
+  }
+  printf("\n");
+}
+
+// key=value -> registry entry; false with a message if unknown or invalid
+static bool applyOverride(char *arg) {
+  char *eq = strchr(arg, '=');
+  if (!eq) {
+    fprintf(stderr, "expected key=value, got %s\n", arg);
+    return false;
+  }
+  *eq = '\0';
+  const ConfigEntry *e = findConfigEntry(DETECTION_CONFIG_ENTRIES, DETECTION_CONFIG_ENTRY_COUNT, arg);
+  if (!e) {
+    fprintf(stderr, "unknown config key %s\n", arg);
+    return false;
+  }
+  if (!parseConfigValue(*e, eq + 1)) {
+    fprintf(stderr, "invalid value for %s (range %g..%g): %s\n", arg, e->minValue, e->maxValue, eq + 1);
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int first = 1;
+  for (; first < argc && argv[first][0] == '-'; first++) {
+    if (strcmp(argv[first], "-q") == 0) {
+      quiet = true;
+    } else if (strcmp(argv[first], "-s") == 0 && first + 1 < argc) {
+      if (!applyOverride(argv[++first])) return 2;
+      // Checked after each override, like CFG:SET on the ball
+      if (const char *order = detectionConfigOrderError()) {
+        fprintf(stderr, "%s breaks %s\n", argv[first], order);
+        return 2;
+      }
+    } else {
+      break;
+    }
+  }
+  if (first >= argc || argv[first][0] == '-') {
+    fprintf(stderr, "usage: %s [-q] [-s key=value ...] trace.csv [trace2.csv ...]\n", argv[0]);
+    return 2;
+  }
+
+  rebuildPSITable();  // Also applies the overrides
+  for (int i = first; i < argc; i++) replayTrace(argv[i]);
+  return 0;
+}
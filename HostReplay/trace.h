@@ -0,0 +1,62 @@
+// Recorded FSR/IMU trace loader shared by replay and bench.
+// CSV, one sample per line: time_ms,fsr0..fsrN-1,ax,ay,az,gx,gy,gz with
+// N = FSR_CHANNEL_COUNT (raw ADC codes and raw MPU6050 counts, the same
+// fields as SensorSample). Lines starting with '#' and a non-numeric header
+// line are skipped.
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "detection.h"
+
+inline bool loadTrace(const char *path, std::vector<SensorSample> &out) {
+  FILE *fp = fopen(path, "r");
+  if (!fp) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return false;
+  }
+
+  char line[256];
+  int lineNo = 0;
+  while (fgets(line, sizeof(line), fp)) {
+    lineNo++;
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+
+    const int fieldCount = 1 + FSR_CHANNEL_COUNT + 6;
+    long v[fieldCount];
+    int n = 0;
+    char *p = line;
+    while (n < fieldCount) {
+      char *end;
+      v[n] = strtol(p, &end, 10);
+      if (end == p) break;
+      n++;
+      if (*end != ',') break;
+      p = end + 1;
+    }
+    if (n != fieldCount) {
+      if (lineNo == 1) continue;  // Header
+      fprintf(stderr, "%s:%d: expected %d fields (FSR_CHANNEL_COUNT=%d), got %d\n", path, lineNo, fieldCount,
+              FSR_CHANNEL_COUNT, n);
+      fclose(fp);
+      return false;
+    }
+
+    SensorSample s;
+    s.timeMs = (unsigned long)v[0];
+    for (int c = 0; c < FSR_CHANNEL_COUNT; c++) s.fsrRaw[c] = (uint16_t)v[1 + c];
+    const long *imu = &v[1 + FSR_CHANNEL_COUNT];
+    s.ax = (int16_t)imu[0];
+    s.ay = (int16_t)imu[1];
+    s.az = (int16_t)imu[2];
+    s.gx = (int16_t)imu[3];
+    s.gy = (int16_t)imu[4];
+    s.gz = (int16_t)imu[5];
+    out.push_back(s);
+  }
+
+  fclose(fp);
+  return true;
+}
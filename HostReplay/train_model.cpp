@@ -0,0 +1,577 @@
+// Train the model engine's int8 window classifier (Esp32/model_engine.h) and
+// write its weights as a header.
+//
+//   train_model [-e epochs] [-o weights.h] [-n sessions] [trace.csv ...]
+//
+// Windows come from the given traces, or without any from -n synthetic
+// sessions (random mixes of rest, grips, shaking, falls, spins, rocking,
+// bouncing and trembling at 50/100/200Hz). Labels are what the rule engine
+// decided over the same samples: its grip state at the end of each bin and
+// the motion it reported most in the last two bins. The shipped model is a
+// distillation of the rules. Adding hand-labelled traces is how it gets
+// better than them.
+//
+// Training is float (Adam, class-weighted cross-entropy on both heads) over
+// the exact int8 inputs the ball sees. Weights are then quantized and checked
+// with the firmware's own modelClassify().
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "detection.h"
+#include "model_engine.h"
+#include "trace.h"
+
+const int K = MODEL_CONV_KERNEL;
+const int C = MODEL_CHANNELS;
+const int F = MODEL_CONV_FILTERS;
+const int T = MODEL_CONV_STEPS;
+const int H = MODEL_HIDDEN;
+const int O = MODEL_OUTPUTS;
+
+// ===================== DATA =====================
+struct LabelledBin {
+  ModelBinFeatures features;
+  MotionType motion;
+  GripState grip;
+};
+
+struct Window {
+  int8_t q[MODEL_STEPS][MODEL_CHANNELS];
+  MotionType motion;
+  GripState grip;
+};
+
+static uint32_t rngState = 12345;
+
+static uint32_t rng() {
+  rngState = rngState * 1664525 + 1013904223;
+  return rngState >> 8;
+}
+
+static int rngRange(int lo, int hi) {
+  return lo + (int)(rng() % (uint32_t)(hi - lo + 1));
+}
+
+static float rngUniform() {
+  return (rng() & 0xFFFFFF) / 16777216.0f;
+}
+
+// One synthetic session: random behaviour segments of 0.5-3s
+static void synthSession(std::vector<SensorSample> &out, unsigned long durationMs) {
+  static const unsigned long RATES[] = { 50, 100, 200 };
+  unsigned long hz = RATES[rng() % 3];
+  unsigned long n = durationMs * hz / 1000;
+
+  unsigned long segmentEnd = 0;
+  int behaviour = 0;
+  int amplitude = 0;
+  int period = 1;
+  uint16_t grip = 0;
+
+  for (unsigned long i = 0; i < n; i++) {
+    unsigned long t = i * 1000 / hz;
+    if (t >= segmentEnd) {
+      behaviour = rngRange(0, 8);
+      segmentEnd = t + rngRange(500, 3000);
+      amplitude = rngRange(0, 100);
+      period = rngRange(2, 12);
+      grip = (uint16_t)(rngRange(0, 3) == 0 ? 0 : rngRange(100, 3600));
+    }
+
+    int noise = rngRange(-1500, 1500);
+    SensorSample s = {};
+    s.timeMs = t;
+    s.ax = noise;
+    s.ay = -noise / 2;
+    s.az = MODEL_ONE_G + noise / 3;
+    s.gx = (int16_t)(noise / 4);
+    s.gy = (int16_t)(-noise / 5);
+    uint16_t code = grip;
+
+    unsigned long phaseMs = t % 1000;
+    switch (behaviour) {
+      case 0:  // Rest, possibly held
+        break;
+      case 1:  // Squeeze pattern: rhythmic grips
+        code = (phaseMs % 400 < 200) ? (uint16_t)(2400 + amplitude * 10) : 200;
+        break;
+      case 2:  // Violent shaking
+        s.ax = ((i / (period / 2 + 1)) & 1) ? 28000 : -28000;
+        s.ay = (int16_t)(s.ax / (1 + amplitude % 4));
+        break;
+      case 3:  // Free fall then impact
+        if (segmentEnd - t > 120) {
+          s.ax = s.ay = s.az = (int16_t)(noise / 4);
+        } else {
+          s.ax = s.ay = 32000;
+          s.az = (int16_t)(20000 + amplitude * 100);
+        }
+        break;
+      case 4:  // Spinning
+        s.gz = (int16_t)(20000 + amplitude * 120);
+        break;
+      case 5: {  // Rocking: slow tilt swing
+        float ph = 2 * (float)M_PI * t / (400.0f + amplitude * 8);
+        s.ax = (int16_t)((13000 + amplitude * 30) * sinf(ph));
+        s.az = (int16_t)(MODEL_ONE_G * cosf(ph * 0.5f));
+        break;
+      }
+      case 6:  // Bouncing: spikes a few times a second
+        if (phaseMs % (250 + amplitude * 3) < 20) s.az = 32000;
+        break;
+      case 7:  // Tremble
+        s.az = MODEL_ONE_G + (((i / 2) & 1) ? 7000 + amplitude * 40 : -2000);
+        break;
+      case 8:  // Random handling
+        s.ax = (int16_t)(noise * (1 + amplitude / 20));
+        s.gy = (int16_t)(noise * 3);
+        break;
+    }
+    for (int c = 0; c < FSR_CHANNEL_COUNT; c++) s.fsrRaw[c] = code / (c + 1);
+    out.push_back(s);
+  }
+}
+
+// Run the rule engine and the model's bin pooling side by side
+static void labelTrace(const std::vector<SensorSample> &trace, std::vector<LabelledBin> &bins) {
+  uint32_t savedEngine = detectionConfig.engine;
+  detectionConfig.engine = ENGINE_RULES;
+  resetDetection();
+
+  unsigned hits[2][MOTION_TYPE_COUNT] = {};  // This bin, previous bin
+  size_t first = bins.size();
+  for (const SensorSample &s : trace) {
+    DetectionResult r;
+    runRuleDetection(s, r);
+
+    LabelledBin bin;
+    if (modelAccumulate(s, latestFeatures, r.maxPSI, bin.features)) {
+      int best = MOTION_NONE;
+      unsigned bestHits = 0;
+      for (int m = MOTION_NONE + 1; m < MOTION_TYPE_COUNT; m++) {
+        unsigned n = hits[0][m] + hits[1][m];
+        if (n > bestHits) {
+          best = m;
+          bestHits = n;
+        }
+      }
+      bin.motion = (MotionType)best;
+      bin.grip = currentGripState;
+      bins.push_back(bin);
+      memcpy(hits[1], hits[0], sizeof(hits[0]));
+      memset(hits[0], 0, sizeof(hits[0]));
+    }
+    hits[0][r.motion]++;
+  }
+  // Windows never span traces: mark the first bins of this one unusable
+  for (size_t i = first; i < bins.size() && i < first + MODEL_STEPS - 1; i++) bins[i].grip = (GripState)-1;
+  detectionConfig.engine = savedEngine;
+}
+
+// inputMult so that the 99.9th percentile of each channel maps to 127
+static void fitInputScales(const std::vector<LabelledBin> &bins, ModelWeights &w) {
+  for (int c = 0; c < C; c++) {
+    std::vector<int32_t> v;
+    for (const LabelledBin &b : bins) v.push_back(b.features.v[c]);
+    std::sort(v.begin(), v.end());
+    int32_t top = v.empty() ? 1 : v[(v.size() - 1) * 999 / 1000];
+    if (top < 1) top = 1;
+    w.inputMult[c] = (int32_t)((127LL << 16) / top);
+    if (w.inputMult[c] < 1) w.inputMult[c] = 1;
+  }
+}
+
+static void buildWindows(const std::vector<LabelledBin> &bins, const ModelWeights &w, std::vector<Window> &out) {
+  for (size_t end = MODEL_STEPS - 1; end < bins.size(); end++) {
+    if (bins[end].grip == (GripState)-1) continue;
+    Window win;
+    for (int i = 0; i < MODEL_STEPS; i++) modelQuantizeBin(w, bins[end - MODEL_STEPS + 1 + i].features, win.q[i]);
+    win.motion = bins[end].motion;
+    win.grip = bins[end].grip;
+    out.push_back(win);
+  }
+}
+
+// ===================== FLOAT NETWORK =====================
+struct Net {
+  float convW[F][K][C], convB[F];
+  float hidW[H][T * F], hidB[H];
+  float outW[O][H], outB[O];
+};
+const int PARAM_COUNT = sizeof(Net) / sizeof(float);
+
+struct Activations {
+  float x[MODEL_STEPS][C];
+  float conv[T][F];     // Post-ReLU
+  float hidden[H];
+  float logits[O];
+};
+
+static void forward(const Net &n, const Window &win, Activations &a) {
+  for (int s = 0; s < MODEL_STEPS; s++) {
+    for (int c = 0; c < C; c++) a.x[s][c] = win.q[s][c] / 127.0f;
+  }
+  for (int t = 0; t < T; t++) {
+    for (int o = 0; o < F; o++) {
+      float acc = n.convB[o];
+      for (int k = 0; k < K; k++) {
+        for (int c = 0; c < C; c++) acc += n.convW[o][k][c] * a.x[t * MODEL_CONV_STRIDE + k][c];
+      }
+      a.conv[t][o] = acc > 0 ? acc : 0;
+    }
+  }
+  const float *flat = &a.conv[0][0];
+  for (int j = 0; j < H; j++) {
+    float acc = n.hidB[j];
+    for (int i = 0; i < T * F; i++) acc += n.hidW[j][i] * flat[i];
+    a.hidden[j] = acc > 0 ? acc : 0;
+  }
+  for (int m = 0; m < O; m++) {
+    float acc = n.outB[m];
+    for (int j = 0; j < H; j++) acc += n.outW[m][j] * a.hidden[j];
+    a.logits[m] = acc;
+  }
+}
+
+static void softmaxGrad(const float *logits, int count, int label, float weight, float *dz, double &loss) {
+  float peak = logits[0];
+  for (int i = 1; i < count; i++) peak = fmaxf(peak, logits[i]);
+  float sum = 0;
+  for (int i = 0; i < count; i++) sum += expf(logits[i] - peak);
+  for (int i = 0; i < count; i++) {
+    float p = expf(logits[i] - peak) / sum;
+    dz[i] = weight * (p - (i == label ? 1.0f : 0.0f));
+    if (i == label) loss -= weight * logf(fmaxf(p, 1e-9f));
+  }
+}
+
+static void backward(const Net &n, const Activations &a, const float dz[O], Net &g) {
+  float dHidden[H] = {};
+  for (int m = 0; m < O; m++) {
+    g.outB[m] += dz[m];
+    for (int j = 0; j < H; j++) {
+      g.outW[m][j] += dz[m] * a.hidden[j];
+      dHidden[j] += dz[m] * n.outW[m][j];
+    }
+  }
+
+  const float *flat = &a.conv[0][0];
+  float dFlat[T * F] = {};
+  for (int j = 0; j < H; j++) {
+    if (a.hidden[j] <= 0) continue;
+    g.hidB[j] += dHidden[j];
+    for (int i = 0; i < T * F; i++) {
+      g.hidW[j][i] += dHidden[j] * flat[i];
+      dFlat[i] += dHidden[j] * n.hidW[j][i];
+    }
+  }
+
+  for (int t = 0; t < T; t++) {
+    for (int o = 0; o < F; o++) {
+      if (a.conv[t][o] <= 0) continue;
+      float d = dFlat[t * F + o];
+      g.convB[o] += d;
+      for (int k = 0; k < K; k++) {
+        for (int c = 0; c < C; c++) g.convW[o][k][c] += d * a.x[t * MODEL_CONV_STRIDE + k][c];
+      }
+    }
+  }
+}
+
+static void initNet(Net &n) {
+  memset(&n, 0, sizeof(n));
+  auto fill = [](float *w, int count, int fanIn) {
+    float limit = sqrtf(6.0f / fanIn);
+    for (int i = 0; i < count; i++) w[i] = (rngUniform() * 2 - 1) * limit;
+  };
+  fill(&n.convW[0][0][0], F * K * C, K * C);
+  fill(&n.hidW[0][0], H * T * F, T * F);
+  fill(&n.outW[0][0], O * H, H);
+}
+
+static int argmaxf(const float *v, int count) {
+  int best = 0;
+  for (int i = 1; i < count; i++) {
+    if (v[i] > v[best]) best = i;
+  }
+  return best;
+}
+
+static void train(Net &n, const std::vector<Window> &data, int epochs) {
+  // Class weights: 1/sqrt(frequency), normalised to mean 1 over the data
+  float motionWeight[MODEL_MOTION_CLASSES], gripWeight[MODEL_GRIP_CLASSES];
+  unsigned motionCount[MODEL_MOTION_CLASSES] = {}, gripCount[MODEL_GRIP_CLASSES] = {};
+  for (const Window &w : data) {
+    motionCount[w.motion]++;
+    gripCount[w.grip]++;
+  }
+  auto weigh = [&](const unsigned *count, float *weight, int classes) {
+    double norm = 0;
+    for (int i = 0; i < classes; i++) {
+      weight[i] = count[i] ? 1.0f / sqrtf((float)count[i]) : 0;
+      norm += weight[i] * count[i];
+    }
+    for (int i = 0; i < classes; i++) weight[i] = (float)(weight[i] * data.size() / norm);
+  };
+  weigh(motionCount, motionWeight, MODEL_MOTION_CLASSES);
+  weigh(gripCount, gripWeight, MODEL_GRIP_CLASSES);
+
+  const int batch = 32;
+  const float lr = 0.003f, beta1 = 0.9f, beta2 = 0.999f, eps = 1e-8f;
+  std::vector<float> m1(PARAM_COUNT), m2(PARAM_COUNT);
+  std::vector<size_t> order(data.size());
+  for (size_t i = 0; i < order.size(); i++) order[i] = i;
+  int step = 0;
+
+  for (int epoch = 0; epoch < epochs; epoch++) {
+    for (size_t i = order.size(); i > 1; i--) std::swap(order[i - 1], order[rng() % i]);
+
+    double loss = 0;
+    for (size_t start = 0; start < order.size(); start += batch) {
+      static Net g;
+      memset(&g, 0, sizeof(g));
+      size_t end = std::min(order.size(), start + batch);
+      for (size_t b = start; b < end; b++) {
+        const Window &w = data[order[b]];
+        Activations a;
+        forward(n, w, a);
+        float dz[O];
+        softmaxGrad(a.logits, MODEL_MOTION_CLASSES, w.motion, motionWeight[w.motion], dz, loss);
+        softmaxGrad(a.logits + MODEL_MOTION_CLASSES, MODEL_GRIP_CLASSES, w.grip, gripWeight[w.grip],
+                    dz + MODEL_MOTION_CLASSES, loss);
+        backward(n, a, dz, g);
+      }
+
+      step++;
+      float *p = (float *)&n;
+      const float *gp = (const float *)&g;
+      float scale = 1.0f / (end - start);
+      float c1 = 1 - powf(beta1, step), c2 = 1 - powf(beta2, step);
+      for (int i = 0; i < PARAM_COUNT; i++) {
+        float gi = gp[i] * scale;
+        m1[i] = beta1 * m1[i] + (1 - beta1) * gi;
+        m2[i] = beta2 * m2[i] + (1 - beta2) * gi * gi;
+        p[i] -= lr * (m1[i] / c1) / (sqrtf(m2[i] / c2) + eps);
+      }
+    }
+    if (epoch % 5 == 4 || epoch == epochs - 1) {
+      fprintf(stderr, "epoch %d: loss %.4f\n", epoch + 1, loss / data.size());
+    }
+  }
+}
+
+// ===================== QUANTIZATION =====================
+static float tensorMaxAbs(const float *w, int count) {
+  float m = 1e-9f;
+  for (int i = 0; i < count; i++) m = fmaxf(m, fabsf(w[i]));
+  return m;
+}
+
+static void quantizeTensor(const float *w, int count, float scale, int8_t *out) {
+  for (int i = 0; i < count; i++) {
+    long q = lroundf(w[i] / scale);
+    out[i] = (int8_t)(q < -127 ? -127 : (q > 127 ? 127 : q));
+  }
+}
+
+// real = mult * 2^-shift with mult in [2^30, 2^31)
+static void quantizeMultiplier(double real, int32_t &mult, int8_t &shift) {
+  int exp;
+  double mant = frexp(real, &exp);
+  int64_t m = llround(mant * (1LL << 31));
+  if (m == (1LL << 31)) {
+    m /= 2;
+    exp++;
+  }
+  mult = (int32_t)m;
+  shift = (int8_t)(31 - exp);
+}
+
+static void quantizeNet(const Net &n, const std::vector<Window> &data, ModelWeights &w) {
+  // Activation ranges from the float network over the data
+  float convMax = 1e-6f, hiddenMax = 1e-6f;
+  for (const Window &win : data) {
+    Activations a;
+    forward(n, win, a);
+    convMax = fmaxf(convMax, tensorMaxAbs(&a.conv[0][0], T * F));
+    hiddenMax = fmaxf(hiddenMax, tensorMaxAbs(a.hidden, H));
+  }
+
+  const float inScale = 1.0f / 127;
+  float convAct = convMax / 127, hiddenAct = hiddenMax / 127;
+
+  float convWs = tensorMaxAbs(&n.convW[0][0][0], F * K * C) / 127;
+  quantizeTensor(&n.convW[0][0][0], F * K * C, convWs, &w.convW[0][0][0]);
+  for (int o = 0; o < F; o++) w.convB[o] = (int32_t)lroundf(n.convB[o] / (convWs * inScale));
+  quantizeMultiplier((double)convWs * inScale / convAct, w.convMult, w.convShift);
+
+  float hidWs = tensorMaxAbs(&n.hidW[0][0], H * T * F) / 127;
+  quantizeTensor(&n.hidW[0][0], H * T * F, hidWs, &w.hiddenW[0][0]);
+  for (int j = 0; j < H; j++) w.hiddenB[j] = (int32_t)lroundf(n.hidB[j] / (hidWs * convAct));
+  quantizeMultiplier((double)hidWs * convAct / hiddenAct, w.hiddenMult, w.hiddenShift);
+
+  float outWs = tensorMaxAbs(&n.outW[0][0], O * H) / 127;
+  quantizeTensor(&n.outW[0][0], O * H, outWs, &w.outW[0][0]);
+  for (int m = 0; m < O; m++) w.outB[m] = (int32_t)lroundf(n.outB[m] / (outWs * hiddenAct));
+}
+
+// ===================== EVALUATION / OUTPUT =====================
+struct Accuracy {
+  double motion, grip, motionEvents;  // motionEvents: accuracy over windows labelled with a motion
+};
+
+template <typename Classify>
+static Accuracy evaluate(const std::vector<Window> &data, Classify classify) {
+  unsigned motionOk = 0, gripOk = 0, events = 0, eventsOk = 0;
+  for (const Window &w : data) {
+    ModelOutput out;
+    classify(w, out);
+    motionOk += out.motion == w.motion;
+    gripOk += out.grip == w.grip;
+    if (w.motion != MOTION_NONE) {
+      events++;
+      eventsOk += out.motion == w.motion;
+    }
+  }
+  double n = data.empty() ? 1 : data.size();
+  return { motionOk / n, gripOk / n, events ? (double)eventsOk / events : 0 };
+}
+
+static void printArray(FILE *fp, const int8_t *v, int count) {
+  fprintf(fp, "{");
+  for (int i = 0; i < count; i++) fprintf(fp, "%s%d", i ? ", " : " ", v[i]);
+  fprintf(fp, " }");
+}
+
+static void printArray(FILE *fp, const int32_t *v, int count) {
+  fprintf(fp, "{");
+  for (int i = 0; i < count; i++) fprintf(fp, "%s%ld", i ? ", " : " ", (long)v[i]);
+  fprintf(fp, " }");
+}
+
+static bool writeHeader(const char *path, const ModelWeights &w, size_t windows, const char *source,
+                        const Accuracy &acc) {
+  FILE *fp = fopen(path, "w");
+  if (!fp) {
+    fprintf(stderr, "cannot write %s\n", path);
+    return false;
+  }
+  fprintf(fp, "// Generated by HostReplay/train_model - do not edit.\n");
+  fprintf(fp, "// %zu windows from %s, labelled by the rule engine.\n", windows, source);
+  fprintf(fp, "// int8 agreement with the labels: motion %.1f%% (%.1f%% on motion windows), grip %.1f%%\n",
+          acc.motion * 100, acc.motionEvents * 100, acc.grip * 100);
+  fprintf(fp, "#pragma once\n\n#include \"model_engine.h\"\n\nconst ModelWeights MODEL_WEIGHTS = {\n");
+
+  fprintf(fp, "  ");
+  printArray(fp, w.inputMult, C);
+  fprintf(fp, ",\n  {\n");
+  for (int o = 0; o < F; o++) {
+    fprintf(fp, "    {");
+    for (int k = 0; k < K; k++) {
+      fprintf(fp, k ? ", " : " ");
+      printArray(fp, w.convW[o][k], C);
+    }
+    fprintf(fp, " },\n");
+  }
+  fprintf(fp, "  },\n  ");
+  printArray(fp, w.convB, F);
+  fprintf(fp, ",\n  %ld, %d,\n  {\n", (long)w.convMult, w.convShift);
+  for (int j = 0; j < H; j++) {
+    fprintf(fp, "    ");
+    printArray(fp, w.hiddenW[j], T * F);
+    fprintf(fp, ",\n");
+  }
+  fprintf(fp, "  },\n  ");
+  printArray(fp, w.hiddenB, H);
+  fprintf(fp, ",\n  %ld, %d,\n  {\n", (long)w.hiddenMult, w.hiddenShift);
+  for (int m = 0; m < O; m++) {
+    fprintf(fp, "    ");
+    printArray(fp, w.outW[m], H);
+    fprintf(fp, ",\n");
+  }
+  fprintf(fp, "  },\n  ");
+  printArray(fp, w.outB, O);
+  fprintf(fp, ",\n};\n");
+  fclose(fp);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int epochs = 30;
+  int sessions = 24;
+  const char *outPath = "model_weights.h";
+  std::vector<const char *> paths;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+      epochs = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      outPath = argv[++i];
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      sessions = atoi(argv[++i]);
+    } else if (argv[i][0] == '-') {
+      fprintf(stderr, "usage: %s [-e epochs] [-o weights.h] [-n sessions] [trace.csv ...]\n", argv[0]);
+      return 2;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+
+  rebuildPSITable();
+  std::vector<LabelledBin> bins;
+  char source[64];
+  if (paths.empty()) {
+    for (int i = 0; i < sessions; i++) {
+      std::vector<SensorSample> trace;
+      synthSession(trace, 90000);
+      labelTrace(trace, bins);
+    }
+    snprintf(source, sizeof(source), "%d synthetic 90s sessions", sessions);
+  } else {
+    for (const char *path : paths) {
+      std::vector<SensorSample> trace;
+      if (!loadTrace(path, trace)) return 1;
+      labelTrace(trace, bins);
+    }
+    snprintf(source, sizeof(source), "%zu traces", paths.size());
+  }
+
+  static ModelWeights weights;
+  fitInputScales(bins, weights);
+  std::vector<Window> data;
+  buildWindows(bins, weights, data);
+  if (data.empty()) {
+    fprintf(stderr, "no complete %d-bin windows in the input\n", MODEL_STEPS);
+    return 1;
+  }
+
+  unsigned motionCount[MOTION_TYPE_COUNT] = {};
+  for (const Window &w : data) motionCount[w.motion]++;
+  fprintf(stderr, "%zu windows; motion labels:", data.size());
+  for (int m = 0; m < MOTION_TYPE_COUNT; m++) fprintf(stderr, " %s=%u", motionToString((MotionType)m), motionCount[m]);
+  fprintf(stderr, "\n");
+
+  static Net net;
+  initNet(net);
+  train(net, data, epochs);
+
+  Accuracy fp = evaluate(data, [](const Window &w, ModelOutput &out) {
+    Activations a;
+    forward(net, w, a);
+    out.motion = (MotionType)argmaxf(a.logits, MODEL_MOTION_CLASSES);
+    out.grip = (GripState)argmaxf(a.logits + MODEL_MOTION_CLASSES, MODEL_GRIP_CLASSES);
+  });
+  quantizeNet(net, data, weights);
+  Accuracy q = evaluate(data, [](const Window &w, ModelOutput &out) { modelClassify(weights, w.q, out); });
+
+  printf("float: motion %.1f%% (motion windows %.1f%%), grip %.1f%%\n", fp.motion * 100, fp.motionEvents * 100,
+         fp.grip * 100);
+  printf("int8:  motion %.1f%% (motion windows %.1f%%), grip %.1f%%\n", q.motion * 100, q.motionEvents * 100,
+         q.grip * 100);
+  printf("arena: %zu of %zu bytes\n", MODEL_ARENA_USED, MODEL_ARENA_BYTES);
+  return writeHeader(outPath, weights, data.size(), source, q) ? 0 : 1;
+}
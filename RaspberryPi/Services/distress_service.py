@@ -10,10 +10,12 @@ Can be configured by mobile app to change animation/sound selection.
 """
 
 import socket
+import struct
 import threading
 import time
 import os
 import sys
+from collections import deque
 from PIL import Image, ImageSequence
 import digitalio
 import board
@@ -27,6 +29,73 @@ import adafruit_rgb_display.ili9341 as ili9341
 UDP_LISTEN_PORT = 4210      # Receive sensor data from ESP32
 ESP32_IP = "192.168.4.1"
 ESP32_CMD_PORT = 5006       # Send commands to ESP32
+UDP_RECV_BYTES = 65507      # Largest UDP payload; STATUS replies alone run past 1KB
+
+# Binary telemetry (ESP32 TelemetryFrame, see Esp32/main.cpp)
+# When enabled, the Pi asks the ESP32 to switch with FORMAT:BIN whenever it
+# receives text telemetry (e.g. after an ESP32 reboot)
+ESP32_BINARY_TELEMETRY = True
+TELEMETRY_MAGIC = 0xCB
+TELEMETRY_VERSION = 5
+TELEMETRY_STRUCT = struct.Struct('<BBBBHIHHHHHhhhhhhBBBB')  # v1 layout, common to all versions
+TELEMETRY_V2_STRUCT = struct.Struct('<HHH')                  # v2: psi_min, psi_peak, psi_std
+TELEMETRY_V3_STRUCT = struct.Struct('<BBHH')                 # v3: pad count, max pad, psi_sum, centroid
+TELEMETRY_PAD = struct.Struct('<H')                          # v3: per-pad PSI, pad count times
+TELEMETRY_V4_STRUCT = struct.Struct('<I')                    # v4: device id (last 3 MAC bytes), after the pads
+TELEMETRY_V5_STRUCT = struct.Struct('<q')                    # v5: acquisition time in this Pi's Unix ms (0 = unsynced)
+LEGACY_DEVICE_ID = "ESP32-BALL"                              # Firmware before per-unit IDs
+TELEMETRY_FLAG_SQUEEZE = 0x01
+TELEMETRY_FLAG_ALERT_PATTERN = 0x02
+TELEMETRY_FLAG_ALERT_MOTION = 0x04
+TELEMETRY_FLAG_KEYFRAME = 0x10
+FORMAT_REQUEST_INTERVAL = 10  # Seconds between FORMAT:BIN requests, per ball
+
+# Change-only heartbeats (ESP32 report_delta=1, binary format only). Keyframes
+# are full TelemetryFrames flagged TELEMETRY_FLAG_KEYFRAME that we ACK; the
+# ReportFrames in between are keepalives, deltas against the ACKed keyframe,
+# or immediate grip-transition events. Parsed reports come out as full
+# telemetry dicts with "report": "key" / "delta" / "none" / "stale".
+REPORT_MAGIC = 0xCD
+REPORT_VERSION = 1
+REPORT_HEADER = struct.Struct('<BBBBHIIHI')     # magic, version, kind, grip, seq, time, device id, key seq, changed mask
+REPORT_GRIP_EVENT = struct.Struct('<BHq')       # previous grip, psi x100, sync time (Unix ms, 0 = unsynced)
+REPORT_KEEPALIVE, REPORT_DELTA, REPORT_GRIP = 0, 1, 2
+# Delta fields in wire order (ReportField on the ESP32), then one "psi_pads" entry per pad.
+# Scale 100 = x100 fixed point, 256 = centroid; None = code mapped below.
+REPORT_FIELDS = [
+    ("fsr1_raw", 1), ("fsr2_raw", 1), ("psi1", 100), ("psi2", 100), ("psi_max", 100),
+    ("ax", 1), ("ay", 1), ("az", 1), ("gx", 1), ("gy", 1), ("gz", 1), ("motion", None),
+    ("psi_min", 100), ("psi_peak", 100), ("psi_std", 100), ("psi_max_pad", 1),
+    ("psi_sum", 100), ("psi_centroid", 256), ("action", None),
+]
+KEY_REQUEST_INTERVAL = 10     # Seconds between REPORT:KEY requests, per ball
+_keyframes = {}               # device id -> {"seq", "values", "data"} of the last ACKed keyframe
+
+# Alert delivery: every alert carries a sequence number (binary frame seq or
+# text alert_seq) and the ESP32 retransmits it until it sees ACK:<seq>
+ALERT_SEQ_HISTORY = 32        # Recently handled (device, seq) pairs, for dropping retransmits
+_recent_alert_seqs = deque(maxlen=ALERT_SEQ_HISTORY)
+
+# Clock sync: each ball sends SYNC:REQ:<t1_us> here and we answer
+# SYNC:<t1>,<t2>,<t3> on its command port (t2/t3 = our Unix time in us).
+# The ball estimates offset/drift and stamps samples and alerts in our timebase
+# ("ts" in parsed telemetry, Unix ms).
+SYNC_REQUEST_PREFIX = b"SYNC:REQ:"
+
+# Fleet: several balls can report to this Pi (ESP32 NET_MODE_STA on a shared
+# hub network). Each packet names its ball and carries a per-ball 16-bit
+# sequence number, so loss and reboots are tracked per device.
+FLEET_SEQ_WINDOW = 0x8000     # A seq this far behind the expected one is old (retransmit/reorder)
+_fleet = {}                   # device id -> state dict, see track_device()
+_fleet_lock = threading.Lock()
+
+# Raw IMU stream batches (STREAM:IMU:<hz>HZ)
+IMU_STREAM_MAGIC = 0xCC
+IMU_STREAM_VERSION = 2
+IMU_BATCH_HEADER = struct.Struct('<BBHHHIII')
+IMU_BATCH_V2_STRUCT = struct.Struct('<q')  # v2: first sample time in this Pi's Unix ms (0 = unsynced)
+IMU_BATCH_SAMPLE = struct.Struct('<Hhhhhhh')
+_imu_streams = {}  # Sender IP -> {"next_index": expected firstIndex, "lost_total": index gaps}
 
 # Animation paths (5 animations)
 ANIMATIONS = {
@@ -84,6 +153,8 @@ ESP32_CONNECTION_TIMEOUT = 10  # Seconds without data before considered disconne
 _on_esp32_data_callback = None
 _on_distress_callback = None
 
+_on_imu_batch_callback = None
+
 _last_volume = None
 _last_volume_time = 0
 
@@ -91,12 +162,26 @@ def set_on_esp32_data_callback(callback):
     """Set callback for when ESP32 sensor data is received.
 
     Callback signature: callback(parsed_data: dict)
-    parsed_data contains: device, time, psi_max, grip_state, motion, alert, dominant_type, etc.
+    parsed_data contains: device, time, ts (acquisition time in Unix ms, once the ball
+    is clock-synced), psi_max, grip_state, motion, alert, dominant_type, etc.
     """
     global _on_esp32_data_callback
     _on_esp32_data_callback = callback
 
 
+def set_on_imu_batch_callback(callback):
+    """Set callback for raw IMU stream batches.
+
+    Callback signature: callback(batch: dict)
+    batch contains: device, rate_hz, first_index, lost_device (dropped on the ESP32),
+    lost_total (index gaps seen by the Pi: device + network loss), time_base and
+    samples, a list of (time_ms, ax, ay, az, gx, gy, gz) tuples. time_ms is this
+    Pi's Unix ms when time_base is "pi" (ball synced), else the ball's millis().
+    """
+    global _on_imu_batch_callback
+    _on_imu_batch_callback = callback
+
+
 def set_on_distress_callback(callback):
     """Set callback for when distress is detected.
 
@@ -146,6 +231,101 @@ def is_esp32_beacon_detected():
     return _esp32_beacon_detected
 
 
+# ======================
+# Fleet Tracking
+# ======================
+
+def track_device(data, addr):
+    """Record a telemetry packet against its ball and update loss counters.
+
+    Sets data["device"] for older firmware and data["addr"] to the sender IP.
+    Returns the device's state dict.
+    """
+    device = data.get("device") or LEGACY_DEVICE_ID
+    data["device"] = device
+    data["addr"] = addr[0]
+    now = time.time()
+
+    with _fleet_lock:
+        state = _fleet.get(device)
+        if state is None:
+            state = _fleet[device] = {
+                "addr": addr[0], "first_seen": now, "last_seen": now, "last_time_ms": None,
+                "next_seq": None, "received": 0, "lost": 0, "old": 0, "reboots": 0,
+                "last_format_request": 0, "last_key_request": 0, "latency_ms": None, "latency_max_ms": 0,
+            }
+            print(f"[FLEET] New ball {device} at {addr[0]} ({len(_fleet)} known)")
+        elif state["addr"] != addr[0]:
+            print(f"[FLEET] {device} moved {state['addr']} -> {addr[0]}")
+            state["addr"] = addr[0]
+        state["last_seen"] = now
+        state["received"] += 1
+
+        # Acquisition-to-arrival latency, only meaningful once the ball is synced
+        ts = data.get("ts")
+        if ts is not None:
+            latency = int(now * 1000) - int(ts)
+            state["latency_ms"] = latency
+            state["latency_max_ms"] = max(state["latency_max_ms"], latency)
+
+        # ESP32 uptime going backwards means it rebooted (and picked a new random seq)
+        time_ms = data.get("time")
+        if time_ms is not None:
+            time_ms = int(time_ms)
+            if state["last_time_ms"] is not None and time_ms < state["last_time_ms"]:
+                state["reboots"] += 1
+                state["next_seq"] = None
+                print(f"[FLEET] {device} rebooted")
+            state["last_time_ms"] = time_ms
+
+        seq = data.get("seq")
+        if seq is not None:
+            seq = int(seq)
+            if state["next_seq"] is not None:
+                gap = (seq - state["next_seq"]) & 0xFFFF
+                if gap >= FLEET_SEQ_WINDOW:
+                    state["old"] += 1       # Alert retransmit or reordered packet
+                    return state
+                if gap:
+                    state["lost"] += gap
+                    print(f"[FLEET] {device} lost {gap} packet(s) before seq={seq}")
+            state["next_seq"] = (seq + 1) & 0xFFFF
+    return state
+
+
+def get_fleet_status():
+    """Per-ball summary: {device: {addr, connected, received, lost, loss_pct, old, reboots,
+    latency_ms, latency_max_ms, last_seen_ago}}."""
+    now = time.time()
+    with _fleet_lock:
+        status = {}
+        for device, state in _fleet.items():
+            expected = state["received"] - state["old"] + state["lost"]
+            status[device] = {
+                "addr": state["addr"],
+                "connected": now - state["last_seen"] <= ESP32_CONNECTION_TIMEOUT,
+                "received": state["received"],
+                "lost": state["lost"],
+                "loss_pct": round(100.0 * state["lost"] / expected, 2) if expected else 0.0,
+                "old": state["old"],
+                "reboots": state["reboots"],
+                "latency_ms": state["latency_ms"],
+                "latency_max_ms": state["latency_max_ms"],
+                "last_seen_ago": round(now - state["last_seen"], 1),
+            }
+        return status
+
+
+def _device_addresses(device=None):
+    """Command targets: one ball, or every known ball (the AP-mode address if none yet)."""
+    with _fleet_lock:
+        if device is not None:
+            state = _fleet.get(device)
+            return [state["addr"]] if state else []
+        addrs = sorted({state["addr"] for state in _fleet.values()})
+    return addrs or [ESP32_IP]
+
+
 def set_volume(volume: int):
     global _last_volume, _last_volume_time
     print(f"[DEBUG] set_volume called with: {volume}")
@@ -343,30 +523,35 @@ def stop_current_animation():
 # ESP32 Communication
 # ======================
 
-def send_esp32_command(command):
-    """Send a command to ESP32."""
+def send_esp32_command(command, device=None):
+    """Send a command to one ball (device id), or to every known ball when device is None."""
+    addrs = _device_addresses(device)
+    if not addrs:
+        print(f"Unknown ball {device}, not sent: {command}")
+        return
     try:
         sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-        sock.sendto(command.encode(), (ESP32_IP, ESP32_CMD_PORT))
+        for addr in addrs:
+            sock.sendto(command.encode(), (addr, ESP32_CMD_PORT))
         sock.close()
-        print(f"Sent to ESP32: {command}")
+        print(f"Sent to ESP32 {device or ','.join(addrs)}: {command}")
     except Exception as e:
         print(f"Error sending to ESP32: {e}")
 
 
-def play_sound(sound_id):
+def play_sound(sound_id, device=None):
     """Tell ESP32 to play a sound (1-14)."""
     if 1 <= sound_id <= 14:
         # Debug: Print stack trace to see where this is called from
         import traceback
         print(f"\n[DEBUG] play_sound({sound_id}) called from:")
         print("".join(traceback.format_stack()[-4:-1]))  # Show last 3 stack frames
-        send_esp32_command(f"PLAY:{sound_id}")
+        send_esp32_command(f"PLAY:{sound_id}", device)
 
 
-def stop_sound():
+def stop_sound(device=None):
     """Tell ESP32 to stop sound."""
-    send_esp32_command("PLAY:STOP")
+    send_esp32_command("PLAY:STOP", device)
 
 
 # ======================
@@ -389,6 +574,318 @@ def parse_esp32_message(message):
 # Valid motion types (for reference)
 VALID_MOTIONS = ["Impact", "ViolentShake", "FreeFall", "Bounce", "Spinning", "Rocking", "Tremble", "None"]
 
+# Wire codes used by the binary frame (order matches motionToCode() on the ESP32)
+MOTION_CODES = ["None", "Impact", "Bounce", "FreeFall", "ViolentShake", "Spinning", "Rocking", "Tremble"]
+GRIP_STATES = ["None", "Calm", "Moderate", "Stressed", "Tantrum"]
+
+
+def _code_name(names, code):
+    return names[code] if code < len(names) else "Unknown"
+
+
+def parse_esp32_binary(packet):
+    """Decode a binary TelemetryFrame into the same dict parse_esp32_message() returns.
+
+    Returns None if the packet is not a frame this version understands.
+    """
+    if len(packet) < TELEMETRY_STRUCT.size or not 1 <= packet[1] <= TELEMETRY_VERSION:
+        return None
+
+    (_magic, _version, flags, grip, seq, time_ms, fsr1, fsr2, psi1, psi2, psi_max,
+     ax, ay, az, gx, gy, gz, motion, alert_motion, dominant, _reserved) = TELEMETRY_STRUCT.unpack_from(packet)
+
+    data = {
+        "device": LEGACY_DEVICE_ID,
+        "seq": str(seq),
+        "time": str(time_ms),
+        "fsr1_raw": str(fsr1),
+        "fsr2_raw": str(fsr2),
+        "psi1": f"{psi1 / 100:.2f}",
+        "psi2": f"{psi2 / 100:.2f}",
+        "psi_max": f"{psi_max / 100:.2f}",
+        "grip_state": _code_name(GRIP_STATES, grip),
+        "ax": str(ax), "ay": str(ay), "az": str(az),
+        "gx": str(gx), "gy": str(gy), "gz": str(gz),
+        "motion": _code_name(MOTION_CODES, motion),
+    }
+    if packet[1] >= 2 and len(packet) >= TELEMETRY_STRUCT.size + TELEMETRY_V2_STRUCT.size:
+        psi_min, psi_peak, psi_std = TELEMETRY_V2_STRUCT.unpack_from(packet, TELEMETRY_STRUCT.size)
+        data["psi_min"] = f"{psi_min / 100:.2f}"
+        data["psi_peak"] = f"{psi_peak / 100:.2f}"
+        data["psi_std"] = f"{psi_std / 100:.2f}"
+    v3_offset = TELEMETRY_STRUCT.size + TELEMETRY_V2_STRUCT.size
+    if packet[1] >= 3 and len(packet) >= v3_offset + TELEMETRY_V3_STRUCT.size:
+        pad_count, max_pad, psi_sum, centroid = TELEMETRY_V3_STRUCT.unpack_from(packet, v3_offset)
+        pads_offset = v3_offset + TELEMETRY_V3_STRUCT.size
+        if len(packet) >= pads_offset + pad_count * TELEMETRY_PAD.size:
+            pads = struct.unpack_from(f'<{pad_count}H', packet, pads_offset)
+            data["psi_pads"] = "/".join(f"{p / 100:.2f}" for p in pads)
+        data["psi_sum"] = f"{psi_sum / 100:.2f}"
+        data["psi_centroid"] = f"{centroid / 256:.2f}"
+        data["psi_max_pad"] = str(max_pad)
+        v4_offset = pads_offset + pad_count * TELEMETRY_PAD.size
+        if packet[1] >= 4 and len(packet) >= v4_offset + TELEMETRY_V4_STRUCT.size:
+            (device_id,) = TELEMETRY_V4_STRUCT.unpack_from(packet, v4_offset)
+            data["device"] = f"BALL-{device_id:06X}"
+            v5_offset = v4_offset + TELEMETRY_V4_STRUCT.size
+            if packet[1] >= 5 and len(packet) >= v5_offset + TELEMETRY_V5_STRUCT.size:
+                (sync_ms,) = TELEMETRY_V5_STRUCT.unpack_from(packet, v5_offset)
+                if sync_ms:
+                    data["ts"] = str(sync_ms)
+    if flags & TELEMETRY_FLAG_SQUEEZE:
+        data["action"] = "Squeeze"
+    if flags & TELEMETRY_FLAG_KEYFRAME:
+        data["report"] = "key"
+    if flags & (TELEMETRY_FLAG_ALERT_PATTERN | TELEMETRY_FLAG_ALERT_MOTION):
+        data["alert_seq"] = str(seq)
+    if flags & TELEMETRY_FLAG_ALERT_PATTERN:
+        data["alert"] = "PATTERN_3GRIP"
+        data["dominant_type"] = _code_name(GRIP_STATES, dominant)
+    if flags & TELEMETRY_FLAG_ALERT_MOTION:
+        data["alert"] = data.get("alert", "") + ("," if "alert" in data else "") + "MOTION_3X"
+        data["motion_type"] = _code_name(MOTION_CODES, alert_motion)
+    return data
+
+
+def _frame_report_values(packet):
+    """Integer keyframe fields of a TelemetryFrame, in REPORT_FIELDS order plus pads."""
+    (_magic, _version, flags, _grip, _seq, _time_ms, fsr1, fsr2, psi1, psi2, psi_max,
+     ax, ay, az, gx, gy, gz, motion, _alert_motion, _dominant, _reserved) = TELEMETRY_STRUCT.unpack_from(packet)
+    psi_min, psi_peak, psi_std = TELEMETRY_V2_STRUCT.unpack_from(packet, TELEMETRY_STRUCT.size)
+    v3_offset = TELEMETRY_STRUCT.size + TELEMETRY_V2_STRUCT.size
+    pad_count, max_pad, psi_sum, centroid = TELEMETRY_V3_STRUCT.unpack_from(packet, v3_offset)
+    pads = struct.unpack_from(f'<{pad_count}H', packet, v3_offset + TELEMETRY_V3_STRUCT.size)
+    return [fsr1, fsr2, psi1, psi2, psi_max, ax, ay, az, gx, gy, gz, motion,
+            psi_min, psi_peak, psi_std, max_pad, psi_sum, centroid,
+            1 if flags & TELEMETRY_FLAG_SQUEEZE else 0] + list(pads)
+
+
+def store_keyframe(parsed, packet, addr):
+    """Keep a keyframe as this ball's delta reference and ACK it (every copy, like alerts)."""
+    _keyframes[parsed["device"]] = {
+        "seq": int(parsed["seq"]),
+        "values": _frame_report_values(packet),
+        "data": dict(parsed),
+    }
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        sock.sendto(f"ACK:{parsed['seq']}".encode(), (addr[0], ESP32_CMD_PORT))
+        sock.close()
+    except Exception as e:
+        print(f"Error sending keyframe ACK:{parsed['seq']}: {e}")
+
+
+def _read_zigzag_varint(packet, offset):
+    """Decode one zigzag LEB128 value; returns (value, next offset)."""
+    z = shift = 0
+    while True:
+        byte = packet[offset]
+        offset += 1
+        z |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return (z >> 1) ^ -(z & 1), offset
+
+
+def _render_report_fields(data, values):
+    """Write keyframe-order integer fields into a telemetry dict as parse_esp32_binary() would."""
+    for (name, scale), value in zip(REPORT_FIELDS, values):
+        if name == "motion":
+            data[name] = _code_name(MOTION_CODES, value)
+        elif name == "action":
+            if value:
+                data[name] = "Squeeze"
+            else:
+                data.pop(name, None)
+        elif scale == 1:
+            data[name] = str(value)
+        else:
+            data[name] = f"{value / scale:.2f}"
+    pads = values[len(REPORT_FIELDS):]
+    if pads:
+        data["psi_pads"] = "/".join(f"{p / 100:.2f}" for p in pads)
+
+
+def parse_esp32_report(packet):
+    """Decode a ReportFrame (keepalive, delta or grip event) into a telemetry dict.
+
+    Keepalives and deltas are rebuilt on top of the ball's ACKed keyframe. If
+    that keyframe is unknown (Pi restart, lost ACK) the dict only has the
+    header fields and "report": "stale"; the caller then asks for a new one.
+    Returns None if the packet is malformed or from an unknown version.
+    """
+    if len(packet) < REPORT_HEADER.size or packet[1] != REPORT_VERSION:
+        return None
+    _magic, _version, kind, grip, seq, time_ms, device_id, key_seq, changed = REPORT_HEADER.unpack_from(packet)
+    device = f"BALL-{device_id:06X}"
+    key = _keyframes.get(device)
+
+    if kind == REPORT_GRIP:
+        if len(packet) < REPORT_HEADER.size + REPORT_GRIP_EVENT.size:
+            return None
+        previous, psi, sync_ms = REPORT_GRIP_EVENT.unpack_from(packet, REPORT_HEADER.size)
+        data = dict(key["data"]) if key else {}
+        data.pop("report", None)
+        data.update({
+            "event": "grip",
+            "previous_grip": _code_name(GRIP_STATES, previous),
+            "psi_max": f"{psi / 100:.2f}",
+        })
+        if sync_ms:
+            data["ts"] = str(sync_ms)
+        else:
+            data.pop("ts", None)
+    elif kind in (REPORT_KEEPALIVE, REPORT_DELTA):
+        if key is None or key["seq"] != key_seq:
+            data = {"report": "stale"}
+        else:
+            values = list(key["values"])
+            offset = REPORT_HEADER.size
+            try:
+                for i in range(len(values)):
+                    if changed & (1 << i):
+                        delta, offset = _read_zigzag_varint(packet, offset)
+                        values[i] += delta
+            except IndexError:
+                return None
+            data = dict(key["data"])
+            data.pop("ts", None)   # The keyframe's acquisition time, not this report's
+            _render_report_fields(data, values)
+            data["report"] = "delta" if kind == REPORT_DELTA else "none"
+    else:
+        return None
+
+    data.update({
+        "device": device,
+        "seq": str(seq),
+        "time": str(time_ms),
+        "grip_state": _code_name(GRIP_STATES, grip),
+    })
+    return data
+
+
+def request_keyframe(state, device):
+    """Ask one ball for a fresh keyframe (rate-limited per ball)."""
+    now = time.time()
+    if now - state["last_key_request"] < KEY_REQUEST_INTERVAL:
+        return
+    state["last_key_request"] = now
+    send_esp32_command("REPORT:KEY", device)
+
+
+def parse_imu_batch(packet, addr=("", 0)):
+    """Decode an IMU stream batch and update the sender's stream loss tracking.
+
+    Returns None if the packet is malformed or from an unknown version.
+    """
+    if len(packet) < IMU_BATCH_HEADER.size or not 1 <= packet[1] <= IMU_STREAM_VERSION:
+        return None
+
+    _magic, version, count, batch_seq, rate_hz, first_index, first_time, lost_device = \
+        IMU_BATCH_HEADER.unpack_from(packet)
+    header_size = IMU_BATCH_HEADER.size
+    if version >= 2:
+        if len(packet) < header_size + IMU_BATCH_V2_STRUCT.size:
+            return None
+        (first_sync,) = IMU_BATCH_V2_STRUCT.unpack_from(packet, header_size)
+        header_size += IMU_BATCH_V2_STRUCT.size
+        if first_sync:
+            first_time = first_sync  # Sample times move to our timebase
+    else:
+        first_sync = 0
+    if len(packet) < header_size + count * IMU_BATCH_SAMPLE.size:
+        return None
+
+    samples = []
+    offset = header_size
+    for _ in range(count):
+        dt, ax, ay, az, gx, gy, gz = IMU_BATCH_SAMPLE.unpack_from(packet, offset)
+        samples.append((first_time + dt, ax, ay, az, gx, gy, gz))
+        offset += IMU_BATCH_SAMPLE.size
+
+    # A stream restart resets firstIndex to 0
+    stream = _imu_streams.setdefault(addr[0], {"next_index": None, "lost_total": 0})
+    if stream["next_index"] is not None and first_index > stream["next_index"]:
+        stream["lost_total"] += first_index - stream["next_index"]
+    stream["next_index"] = first_index + count
+
+    return {
+        "device": _device_at(addr[0]),
+        "batch_seq": batch_seq,
+        "rate_hz": rate_hz,
+        "first_index": first_index,
+        "lost_device": lost_device,
+        "lost_total": stream["lost_total"],
+        "time_base": "pi" if first_sync else "device",
+        "samples": samples,
+    }
+
+
+def _device_at(ip):
+    """Device id last seen at this IP (IMU batches carry no id of their own)."""
+    with _fleet_lock:
+        for device, state in _fleet.items():
+            if state["addr"] == ip:
+                return device
+    return LEGACY_DEVICE_ID
+
+
+def start_imu_stream(rate_hz=200, device=None):
+    """Ask the ESP32 to stream raw IMU samples (50/100/200/500 Hz)."""
+    for addr in _device_addresses(device):
+        _imu_streams.pop(addr, None)
+    send_esp32_command(f"STREAM:IMU:{rate_hz}HZ", device)
+
+
+def stop_imu_stream(device=None):
+    """Stop the raw IMU stream."""
+    send_esp32_command("STREAM:OFF", device)
+
+
+def request_binary_telemetry(state, device):
+    """Ask one ball to switch to binary telemetry (rate-limited per ball)."""
+    now = time.time()
+    if now - state["last_format_request"] < FORMAT_REQUEST_INTERVAL:
+        return
+    state["last_format_request"] = now
+    send_esp32_command("FORMAT:BIN", device)
+
+def answer_sync_request(sock, packet, addr, rx_us):
+    """Reply SYNC:<t1>,<t2>,<t3> to a ball's SYNC:REQ:<t1> (t2 = rx_us, t3 = now)."""
+    t1 = packet[len(SYNC_REQUEST_PREFIX):].strip().decode('ascii', 'replace')
+    if not t1.isdigit():
+        return
+    reply = f"SYNC:{t1},{rx_us},{time.time_ns() // 1000}".encode()
+    try:
+        sock.sendto(reply, (addr[0], ESP32_CMD_PORT))
+    except Exception as e:
+        print(f"Error answering SYNC from {addr[0]}: {e}")
+
+
+def acknowledge_alert(data, addr):
+    """ACK an alert straight back to the sender.
+
+    Every copy is ACKed (the previous ACK may have been lost). Returns False
+    when this seq was already handled, i.e. the packet is a retransmit.
+    """
+    seq = data.get("alert_seq")
+    if seq is None:
+        return True
+    key = (data.get("device"), seq)
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        sock.sendto(f"ACK:{seq}".encode(), (addr[0], ESP32_CMD_PORT))
+        sock.close()
+    except Exception as e:
+        print(f"Error sending ACK:{seq}: {e}")
+
+    if key in _recent_alert_seqs:
+        print(f"[UDP] Duplicate alert {key[0]} seq={seq} (retransmit), ACKed again")
+        return False
+    _recent_alert_seqs.append(key)
+    return True
+
+
 def is_distress_signal(data):
       """Check if the data indicates a distress signal.
 
@@ -605,15 +1102,63 @@ def start_listener():
     try:
         while True:
             try:
-                data, addr = sock.recvfrom(1024)
-                message = data.decode('utf-8')
-                print(f"[UDP] Received from {addr}: {message[:80]}")  # Debug log
+                data, addr = sock.recvfrom(UDP_RECV_BYTES)
+                rx_us = time.time_ns() // 1000  # Clock sync t2, before anything else
+
+                # Clock sync requests are answered from here, ahead of any slow work
+                if data.startswith(SYNC_REQUEST_PREFIX):
+                    answer_sync_request(sock, data, addr, rx_us)
+                    continue
+
+                # Raw IMU batches are not telemetry - hand off and skip distress checks
+                if data and data[0] == IMU_STREAM_MAGIC:
+                    batch = parse_imu_batch(data, addr)
+                    if batch is not None:
+                        update_esp32_connection()
+                        if _on_imu_batch_callback:
+                            try:
+                                _on_imu_batch_callback(batch)
+                            except Exception as cb_err:
+                                print(f"IMU batch callback error: {cb_err}")
+                    continue
 
                 # Parse and check for distress
-                parsed = parse_esp32_message(message)
+                if data and data[0] == TELEMETRY_MAGIC:
+                    parsed = parse_esp32_binary(data)
+                    if parsed is None:
+                        print(f"[UDP] Unsupported binary frame from {addr} ({len(data)} bytes)")
+                        continue
+                    print(f"[UDP] Received from {addr}: BIN {parsed['device']} seq={parsed['seq']} grip={parsed['grip_state']}")
+                    if parsed.get("report") == "key":
+                        store_keyframe(parsed, data, addr)
+                    is_telemetry = True
+                elif data and data[0] == REPORT_MAGIC:
+                    parsed = parse_esp32_report(data)
+                    if parsed is None:
+                        print(f"[UDP] Unsupported report frame from {addr} ({len(data)} bytes)")
+                        continue
+                    kind = "grip event" if parsed.get("event") else parsed["report"]
+                    print(f"[UDP] Received from {addr}: {kind} {parsed['device']} seq={parsed['seq']} grip={parsed['grip_state']}")
+                    is_telemetry = True
+                else:
+                    message = data.decode('utf-8')
+                    print(f"[UDP] Received from {addr}: {message[:80]}")  # Debug log
+                    parsed = parse_esp32_message(message)
+                    is_telemetry = bool(parsed.get("device"))
 
                 # Update ESP32 connection status (we received data, so it's connected)
                 update_esp32_connection()
+                if is_telemetry:
+                    state = track_device(parsed, addr)
+                    if ESP32_BINARY_TELEMETRY and data[0] not in (TELEMETRY_MAGIC, REPORT_MAGIC):
+                        request_binary_telemetry(state, parsed["device"])
+                    if parsed.get("report") == "stale":
+                        request_keyframe(state, parsed["device"])
+                        continue
+
+                # ACK alerts before anything slow; retransmitted copies stop here
+                if not acknowledge_alert(parsed, addr):
+                    continue
 
                 # Call ESP32 data callback (for BLE sensor updates)
                 if _on_esp32_data_callback:
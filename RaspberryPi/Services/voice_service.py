@@ -29,6 +29,172 @@ from config import settings
 
 logger = logging.getLogger(__name__)
 
+# Atom Echo framed serial protocol: 0x00, COBS(opcode, args..., crc8), 0x00.
+# Opcodes match FrameOp in AtomEcho/main.cpp (tone opcode = 0x01 + PatternId).
+ATOM_OP_TONE = {
+    "default": 0x01,
+    "ready": 0x02,
+    "music": 0x03,
+    "animation": 0x04,
+    "both": 0x05,
+    "sorry": 0x06,
+}
+ATOM_TONE_FLAG_PREEMPT = 0x01
+ATOM_OP_AUDIO_START = 0x20
+ATOM_OP_AUDIO_DATA = 0x21
+ATOM_OP_AUDIO_END = 0x22
+ATOM_AUDIO_PCM16 = 0
+ATOM_AUDIO_IMA_ADPCM = 1
+ATOM_OP_MIC = 0x30
+ATOM_FRAME_REPLY = 0x80     # Set on every device -> Pi frame
+ATOM_MIC_START = ATOM_OP_MIC + 1 | ATOM_FRAME_REPLY
+ATOM_MIC_DATA = ATOM_OP_MIC + 2 | ATOM_FRAME_REPLY
+ATOM_MIC_END = ATOM_OP_MIC + 3 | ATOM_FRAME_REPLY
+ATOM_MIC_END_PADDING_S = 0.5  # Silence appended per speech segment so the listen loop sees it end
+ATOM_AUDIO_CHUNK = 256      # ADPCM bytes per data frame (512 samples)
+ATOM_AUDIO_LEAD_S = 0.25    # Max audio sent ahead of real time (device ring holds 0.5s at 16kHz)
+
+_IMA_INDEX = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8]
+_IMA_STEP = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+]
+
+
+def _crc8(data: bytes) -> int:
+    """CRC-8, poly 0x07, init 0."""
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def _cobs_encode(data: bytes) -> bytes:
+    out = bytearray(b"\x00")
+    code_at, code = 0, 1
+    for b in data:
+        if b:
+            out.append(b)
+            code += 1
+        if not b or code == 0xFF:
+            out[code_at] = code
+            code_at, code = len(out), 1
+            out.append(0)
+    out[code_at] = code
+    return bytes(out)
+
+
+def _ima_encode_chunks(samples, chunk_bytes: int):
+    """IMA-ADPCM encode int16 samples into Atom Echo data chunks.
+
+    Each chunk starts with the encoder state (predictor int16 LE, step index)
+    so a lost frame only loses its own audio.
+    """
+    predictor, index = 0, 0
+    per_chunk = chunk_bytes * 2
+    for start in range(0, len(samples), per_chunk):
+        out = bytearray(struct.pack("<hB", predictor, index))
+        nibbles = []
+        for sample in samples[start:start + per_chunk]:
+            step = _IMA_STEP[index]
+            diff = sample - predictor
+            nibble = 8 if diff < 0 else 0
+            diff = abs(diff)
+            delta = step >> 3
+            if diff >= step:
+                nibble |= 4
+                diff -= step
+                delta += step
+            if diff >= step >> 1:
+                nibble |= 2
+                diff -= step >> 1
+                delta += step >> 1
+            if diff >= step >> 2:
+                nibble |= 1
+                delta += step >> 2
+            predictor += -delta if nibble & 8 else delta
+            predictor = max(-32768, min(32767, predictor))
+            index = max(0, min(88, index + _IMA_INDEX[nibble]))
+            nibbles.append(nibble)
+        if len(nibbles) % 2:
+            nibbles.append(0)
+        for i in range(0, len(nibbles), 2):
+            out.append(nibbles[i] | (nibbles[i + 1] << 4))
+        yield bytes(out)
+
+
+def _ima_decode_chunk(chunk: bytes) -> bytes:
+    """Decode one IMA-ADPCM data chunk (state header + codes) to PCM16 LE."""
+    predictor, index = struct.unpack_from("<hB", chunk)
+    index = min(index, 88)
+    out = bytearray()
+    for byte in chunk[3:]:
+        for nibble in (byte & 0x0F, byte >> 4):
+            step = _IMA_STEP[index]
+            diff = step >> 3
+            if nibble & 4:
+                diff += step
+            if nibble & 2:
+                diff += step >> 1
+            if nibble & 1:
+                diff += step >> 2
+            predictor += -diff if nibble & 8 else diff
+            predictor = max(-32768, min(32767, predictor))
+            index = max(0, min(88, index + _IMA_INDEX[nibble]))
+            out += struct.pack("<h", predictor)
+    return bytes(out)
+
+
+def _cobs_decode(data: bytes) -> Optional[bytes]:
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class AtomFrameReader:
+    """Splits the Atom Echo serial stream into CRC-checked (opcode, payload) frames."""
+
+    def __init__(self):
+        self._buf = bytearray()
+        self.bad_frames = 0
+
+    def feed(self, data: bytes):
+        self._buf += data
+        frames = []
+        while True:
+            end = self._buf.find(0)
+            if end < 0:
+                break
+            raw = bytes(self._buf[:end])
+            del self._buf[:end + 1]
+            if not raw:
+                continue
+            body = _cobs_decode(raw)
+            if body is None or len(body) < 2 or _crc8(body[:-1]) != body[-1]:
+                self.bad_frames += 1
+                continue
+            frames.append((body[0], body[1:-1]))
+        return frames
+
+
+def atom_frame(opcode: int, args: bytes = b"") -> bytes:
+    """Build one delimited Atom Echo command frame."""
+    body = bytes([opcode]) + args
+    return b"\x00" + _cobs_encode(body + bytes([_crc8(body)])) + b"\x00"
+
 
 class VoiceState(Enum):
     """Voice command state machine states."""
@@ -76,7 +242,9 @@ class VoiceService:
         self._on_state_change_callback: Optional[Callable[[VoiceState], None]] = None
 
         # Audio buffer
-        self._audio_buffer = bytearray()
+        self._audio_buffer = bytearray()   # PCM from Atom Echo speech segments (serial input)
+        self._frame_reader = AtomFrameReader()
+        self._mic_format = ATOM_AUDIO_IMA_ADPCM
         self._frame_size = settings.VOICE_FRAME_SIZE * 2  # 2 bytes per sample (16-bit)
 
         # Dependencies available flags
@@ -153,6 +321,8 @@ class VoiceService:
                 if not self._init_serial():
                     logger.error("[Voice] Serial connection failed - voice commands disabled")
                     return False
+                # Atom Echo gates on its own VAD and sends only speech segments
+                self.serial.write(atom_frame(ATOM_OP_MIC, bytes([1, ATOM_AUDIO_IMA_ADPCM])))
                 self._mic_connected = True  # Serial audio streaming is the mic
                 logger.info("[Voice] Using Atom Echo I2S microphone via serial")
             else:
@@ -209,6 +379,7 @@ class VoiceService:
         if self.serial and self.serial.is_open:
             try:
                 self._send_led_command(settings.VOICE_LED_OFF)
+                self.serial.write(atom_frame(ATOM_OP_MIC, bytes([0])))
                 self.serial.close()
             except Exception as e:
                 logger.error(f"[Voice] Error closing serial: {e}")
@@ -336,6 +507,32 @@ class VoiceService:
             logger.error(f"[Voice] Serial initialization failed: {e}")
             return False
 
+    def _read_serial_audio(self) -> Optional[bytes]:
+        """
+        Next VOICE_FRAME_SIZE frame of Atom Echo mic audio, or None.
+
+        Capture arrives as framed speech segments; each segment end is padded
+        with silence so the listen loop's end-of-speech logic still fires.
+        """
+        if self.serial.in_waiting:
+            for opcode, payload in self._frame_reader.feed(self.serial.read(self.serial.in_waiting)):
+                if opcode == ATOM_MIC_START and payload:
+                    self._mic_format = payload[0]
+                elif opcode == ATOM_MIC_DATA and len(payload) > 1:
+                    chunk = payload[1:]
+                    if self._mic_format == ATOM_AUDIO_IMA_ADPCM:
+                        chunk = _ima_decode_chunk(chunk)
+                    self._audio_buffer += chunk
+                elif opcode == ATOM_MIC_END:
+                    pad = int(ATOM_MIC_END_PADDING_S * settings.VOICE_SAMPLE_RATE)
+                    self._audio_buffer += bytes(pad * 2)
+
+        if len(self._audio_buffer) < self._frame_size:
+            return None
+        chunk = bytes(self._audio_buffer[:self._frame_size])
+        del self._audio_buffer[:self._frame_size]
+        return chunk
+
     def _init_vad(self) -> bool:
         """Initialize Voice Activity Detection."""
         if not self._vad_available:
@@ -574,15 +771,12 @@ class VoiceService:
         print(f"[DEBUG VOICE] 🔊 Playing tone pattern: {pattern_name}")
 
         try:
-            # Send single SPEAK command - Atom Echo plays the full pattern
-            # Protocol: SPEAK:<message>
-            command = f"SPEAK:{message}\n"
-
-            bytes_written = self.serial.write(command.encode())
+            # Single tone frame - Atom Echo plays the full pattern
+            self.serial.write(atom_frame(ATOM_OP_TONE[message]))
             self.serial.flush()
 
-            print(f"[DEBUG TONE] Sent SPEAK command: {message}")
-            logger.info(f"[Voice] Sent SPEAK: {message}")
+            print(f"[DEBUG TONE] Sent tone frame: {message}")
+            logger.info(f"[Voice] Sent tone frame: {message}")
 
             # Wait for pattern to complete (approximate timing)
             # ready: ~2-3 seconds (longer pattern with intervals)
@@ -595,6 +789,36 @@ class VoiceService:
         except Exception as e:
             logger.error(f"[Voice] Tone playback error: {e}")
 
+    async def play_audio(self, pcm: bytes, sample_rate: int = 16000):
+        """
+        Stream mono 16-bit PCM to the Atom Echo speaker as IMA-ADPCM.
+
+        Frames go out as fast as the link allows until ATOM_AUDIO_LEAD_S of
+        audio is ahead of real time, then at playback rate. The device starts
+        playing once its jitter buffer is primed (well under 200ms).
+        """
+        if not self._serial_connected or not self.serial:
+            logger.warning("[Voice] Serial not connected, skipping audio")
+            return
+
+        samples = struct.unpack(f"<{len(pcm) // 2}h", pcm[:len(pcm) // 2 * 2])
+        try:
+            self.serial.write(atom_frame(ATOM_OP_AUDIO_START,
+                                         struct.pack("<BH", ATOM_AUDIO_IMA_ADPCM, sample_rate)))
+            start = time.monotonic()
+            sent_s = 0.0
+            for seq, chunk in enumerate(_ima_encode_chunks(samples, ATOM_AUDIO_CHUNK)):
+                ahead = sent_s - (time.monotonic() - start)
+                if ahead > ATOM_AUDIO_LEAD_S:
+                    await asyncio.sleep(ahead - ATOM_AUDIO_LEAD_S)
+                self.serial.write(atom_frame(ATOM_OP_AUDIO_DATA, bytes([seq & 0xFF]) + chunk))
+                sent_s += (len(chunk) - 3) * 2 / sample_rate
+            self.serial.write(atom_frame(ATOM_OP_AUDIO_END))
+            self.serial.flush()
+            logger.info(f"[Voice] Streamed {len(samples) / sample_rate:.2f}s of audio")
+        except Exception as e:
+            logger.error(f"[Voice] Audio stream error: {e}")
+
     async def _speak(self, text: str):
         """
         Legacy TTS method - now redirects to tone patterns.
@@ -723,10 +947,9 @@ class VoiceService:
                 if self._mic_connected:
                     try:
                         if input_type == 'serial' and self.serial and self._serial_connected:
-                            # Read from Atom Echo serial (blocking read with small timeout)
-                            if self.serial.in_waiting >= settings.VOICE_FRAME_SIZE * 2:  # 2 bytes per sample
-                                audio_chunk = self.serial.read(settings.VOICE_FRAME_SIZE * 2)
-                            else:
+                            # Speech segments framed by the Atom Echo's on-device VAD
+                            audio_chunk = self._read_serial_audio()
+                            if audio_chunk is None:
                                 await asyncio.sleep(0.01)
                                 continue
                         else:
@@ -11,6 +11,7 @@ import time
 UDP_LISTEN_PORT = 4210
 ESP32_IP = "192.168.4.1"
 ESP32_CMD_PORT = 5006
+UDP_RECV_BYTES = 65507  # Largest UDP payload (STATUS replies run past 1KB)
 
 def test_receive():
     """Listen for data from ESP32."""
@@ -26,7 +27,7 @@ def test_receive():
     try:
         while True:
             try:
-                data, addr = sock.recvfrom(1024)
+                data, addr = sock.recvfrom(UDP_RECV_BYTES)
                 message = data.decode('utf-8')
                 print(f"\n[{time.strftime('%H:%M:%S')}] From {addr}:")
 